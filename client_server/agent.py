@@ -466,7 +466,7 @@ def get_agent(player: str, strategy: str) -> BaseAgent:
 
     Args:
         player: "circle" or "square"
-        strategy: Strategy name ("random", "student")
+        strategy: Strategy name ("random", "student", "student_cpp" or "native_<policy>")
 
     Returns:
         Agent instance
@@ -489,5 +489,10 @@ def get_agent(player: str, strategy: str) -> BaseAgent:
         else:
             print("C++ StudentAgent not available. Falling back to Python StudentAgent.")
             return StudentAgent(player)
+    elif strategy.startswith("native_"):
+        # Native baselines: native_random, native_greedy, native_one_ply, native_reference
+        import student_agent_cpp
+        return student_agent_cpp.BaselineAgent(player, strategy[len("native_"):])
     else:
-        raise ValueError(f"Unknown strategy: {strategy}. Available: random, student")
\ No newline at end of file
+        raise ValueError(f"Unknown strategy: {strategy}. Available: random, student, student_cpp, "
+                         "native_random, native_greedy, native_one_ply, native_reference")
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "agent_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+AgentPool::AgentPool(int threads, double time_slice)
+    : time_slice_(time_slice)
+{
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < threads; i++)
+        workers_.emplace_back([this]
+                              { worker(); });
+}
+
+AgentPool::~AgentPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        rotation_.clear();
+    }
+    work_cv_.notify_all();
+    for (auto &t : workers_)
+        t.join();
+}
+
+void AgentPool::set_time_slice(double seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    time_slice_ = seconds;
+}
+
+void AgentPool::open_session(const std::string &game_id, const std::string &player)
+{
+    if (player != "circle" && player != "square")
+        throw std::invalid_argument("player must be 'circle' or 'square'");
+    auto agent = std::make_shared<StudentAgent>(player);
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_[session_key(game_id, player)] = std::move(agent);
+}
+
+bool AgentPool::close_session(const std::string &game_id, const std::string &player)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.erase(session_key(game_id, player)) > 0;
+}
+
+size_t AgentPool::session_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
+
+size_t AgentPool::queued() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto &[id, game] : games_)
+        n += game.jobs.size();
+    return n;
+}
+
+long long AgentPool::submit(const std::string &game_id, const std::string &player,
+                 const PyBoard &board, int rows, int cols, const std::vector<int> &score_cols,
+                 double current_player_time, double opponent_time)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(session_key(game_id, player));
+    if (it == sessions_.end())
+        throw std::invalid_argument("no session for " + session_key(game_id, player));
+
+    long long ticket = next_ticket_++;
+    Game &game = games_[game_id];
+    game.jobs.push_back({ticket, it->second, board, rows, cols, score_cols, current_player_time, opponent_time});
+    results_[ticket] = Result();
+    if (!game.running && !game.in_rotation)
+    {
+        game.in_rotation = true;
+        rotation_.push_back(game_id);
+        work_cv_.notify_one();
+    }
+    return ticket;
+}
+
+bool AgentPool::ready(long long ticket) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = results_.find(ticket);
+    return it != results_.end() && it->second.done;
+}
+
+std::pair<Move, double> AgentPool::wait(long long ticket)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!results_.count(ticket))
+        throw std::invalid_argument("unknown ticket " + std::to_string(ticket));
+    done_cv_.wait(lock, [&]
+                  { return results_[ticket].done; });
+    Result r = std::move(results_[ticket]);
+    results_.erase(ticket);
+    if (!r.error.empty())
+        throw std::runtime_error(r.error);
+    return {r.move, r.seconds};
+}
+
+long long AgentPool::wait_any(const std::vector<long long> &tickets, double timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    long long found = -1;
+    auto any_done = [&]
+    {
+        for (long long t : tickets)
+        {
+            auto it = results_.find(t);
+            if (it != results_.end() && it->second.done)
+            {
+                found = t;
+                return true;
+            }
+        }
+        return false;
+    };
+    done_cv_.wait_for(lock, std::chrono::duration<double>(timeout), any_done);
+    return found;
+}
+
+void AgentPool::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        work_cv_.wait(lock, [&]
+                      { return stopping_ || !rotation_.empty(); });
+        if (stopping_)
+            return;
+
+        std::string game_id = rotation_.front();
+        rotation_.pop_front();
+        Game &game = games_[game_id];
+        game.in_rotation = false;
+        game.running = true;
+        Job job = std::move(game.jobs.front());
+        game.jobs.pop_front();
+
+        double cap = 0.0;
+        if (time_slice_ > 0)
+        {
+            double waiting = static_cast<double>(running_ + rotation_.size() + 1);
+            cap = time_slice_ * std::min(1.0, workers_.size() / waiting);
+        }
+        running_++;
+        lock.unlock();
+
+        Result r;
+        auto t0 = std::chrono::steady_clock::now();
+        try
+        {
+            job.agent->set_move_time_cap(cap);
+            r.move = job.agent->choose(job.board, job.rows, job.cols, job.score_cols,
+                                       job.current_player_time, job.opponent_time);
+        }
+        catch (const std::exception &e)
+        {
+            r.error = e.what();
+        }
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        r.done = true;
+
+        lock.lock();
+        running_--;
+        if (results_.count(job.ticket))
+            results_[job.ticket] = std::move(r);
+        Game &after = games_[game_id];
+        after.running = false;
+        if (after.jobs.empty())
+        {
+            games_.erase(game_id);
+        }
+        else if (!after.in_rotation && !stopping_)
+        {
+            after.in_rotation = true;
+            rotation_.push_back(game_id);
+            work_cv_.notify_one();
+        }
+        done_cv_.notify_all();
+    }
+}
@@ -0,0 +1,109 @@
+// Hosts many StudentAgent sessions, keyed by game id and player, and runs
+// their searches on a fixed set of worker threads. Games with work waiting
+// take turns in round-robin order with at most one search per game at a
+// time. With a time slice set, each search is capped at the slice scaled
+// by the share of workers available to every waiting game.
+
+#ifndef AGENT_POOL_H
+#define AGENT_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+#include "search.h"
+
+class AgentPool
+{
+public:
+    explicit AgentPool(int threads = 0, double time_slice = 0.0);
+
+    ~AgentPool();
+
+    int threads() const { return static_cast<int>(workers_.size()); }
+
+    void set_time_slice(double seconds);
+
+    void open_session(const std::string &game_id, const std::string &player);
+
+    // A search already running for the session still completes.
+    bool close_session(const std::string &game_id, const std::string &player);
+
+    int close_game(const std::string &game_id)
+    {
+        return static_cast<int>(close_session(game_id, "circle")) + static_cast<int>(close_session(game_id, "square"));
+    }
+
+    size_t session_count() const;
+
+    size_t queued() const;
+
+    // Queues a choose() call for the session and returns its ticket.
+    long long submit(const std::string &game_id, const std::string &player,
+                     const PyBoard &board, int rows, int cols, const std::vector<int> &score_cols,
+                     double current_player_time, double opponent_time);
+
+    bool ready(long long ticket) const;
+
+    // Blocks until the search finishes; returns the move and its wall time.
+    std::pair<Move, double> wait(long long ticket);
+
+    // First finished ticket among `tickets`, or -1 after `timeout` seconds.
+    long long wait_any(const std::vector<long long> &tickets, double timeout);
+
+private:
+    struct Job
+    {
+        long long ticket;
+        std::shared_ptr<StudentAgent> agent;
+        PyBoard board;
+        int rows, cols;
+        std::vector<int> score_cols;
+        double current_player_time, opponent_time;
+    };
+
+    struct Game
+    {
+        std::deque<Job> jobs;
+        bool running = false;
+        bool in_rotation = false;
+    };
+
+    struct Result
+    {
+        bool done = false;
+        Move move;
+        double seconds = 0.0;
+        std::string error;
+    };
+
+    static std::string session_key(const std::string &game_id, const std::string &player)
+    {
+        return game_id + "/" + player;
+    }
+
+    void worker();
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::map<std::string, std::shared_ptr<StudentAgent>> sessions_;
+    std::map<std::string, Game> games_;
+    std::deque<std::string> rotation_;
+    std::unordered_map<long long, Result> results_;
+    long long next_ticket_ = 1;
+    size_t running_ = 0;
+    double time_slice_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+#endif // AGENT_POOL_H
@@ -0,0 +1,68 @@
+// Games between native baseline policies.
+//
+//   baseline_match [--rows R] [--games N] [--circle P] [--square P]
+//                  [--seed S] [--threads T]
+//
+// P is random, greedy, one_ply or reference (baselines.h). Plays N games
+// from the standard start on the R-row board and prints the results and
+// the rate in games per minute.
+
+#include "baselines.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static bool parse_policy(const std::string &name, BaselinePolicy &policy)
+{
+    if (name == "random")
+        policy = BaselinePolicy::Random;
+    else if (name == "greedy")
+        policy = BaselinePolicy::Greedy;
+    else if (name == "one_ply")
+        policy = BaselinePolicy::OnePly;
+    else if (name == "reference")
+        policy = BaselinePolicy::Reference;
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int rows = 13, games = 100, threads = 0;
+    uint32_t seed = 1;
+    BaselinePolicy circle = BaselinePolicy::Greedy, square = BaselinePolicy::Random;
+    std::string circle_name = "greedy", square_name = "random";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--rows" && supported_board(std::atoi(value.c_str()), std::atoi(value.c_str()) - 1))
+            rows = std::atoi(value.c_str());
+        else if (flag == "--games" && std::atoi(value.c_str()) >= 1)
+            games = std::atoi(value.c_str());
+        else if (flag == "--circle" && parse_policy(value, circle))
+            circle_name = value;
+        else if (flag == "--square" && parse_policy(value, square))
+            square_name = value;
+        else if (flag == "--seed")
+            seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (flag == "--threads" && std::atoi(value.c_str()) >= 0)
+            threads = std::atoi(value.c_str());
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--rows " << MIN_BOARD_ROWS << "-" << MAX_BOARD_SIDE << "] [--games N]"
+                      << " [--circle P] [--square P] [--seed S] [--threads T]\n"
+                      << "  P: random, greedy, one_ply, reference\n";
+            return 1;
+        }
+    }
+
+    MatchResult r = play_baseline_match(circle, square, games, rows, seed, threads);
+    std::cout << rows << "x" << rows - 1 << ", circle " << circle_name << " vs square " << square_name << "\n";
+    std::cout << r.games << " games: circle " << r.circle_wins << ", square " << r.square_wins
+              << ", draws " << r.draws << "\n";
+    std::cout << r.plies << " plies in " << r.seconds << "s, " << r.games * 60.0 / r.seconds << " games/minute\n";
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include "baselines.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "distance.h"
+#include "eval.h"
+#include "movegen.h"
+#include "tracking.h"
+
+BaselineAgent::BaselineAgent(const std::string &player, BaselinePolicy policy, uint32_t seed)
+    : player_(player), policy_(policy), rng_(seed)
+{
+    if (policy == BaselinePolicy::Reference)
+    {
+        reference_ = std::make_unique<StudentAgent>(player);
+        reference_->set_seed(seed);
+        reference_->set_move_time_cap(FIRST_ITERATION_CAP);
+    }
+}
+
+Move BaselineAgent::choose(const PyBoard &py_board, int rows, int cols, const std::vector<int> &score_cols,
+                           double current_player_time, double opponent_time)
+{
+    return choose_board(from_py_board(py_board, rows, cols), rows, cols, score_cols,
+                        current_player_time, opponent_time);
+}
+
+template <typename Score>
+size_t BaselineAgent::best_move(const std::vector<std::unordered_map<std::string, std::string>> &moves, Score score)
+{
+    double best = -std::numeric_limits<double>::infinity();
+    std::vector<size_t> ties;
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        double s = score(moves[i]);
+        if (s > best)
+        {
+            best = s;
+            ties.clear();
+        }
+        if (s == best)
+            ties.push_back(i);
+    }
+    return ties[rng_() % ties.size()];
+}
+
+Move BaselineAgent::choose_board(const std::vector<std::vector<Cell>> &board, int rows, int cols,
+                                 const std::vector<int> &score_cols, double current_player_time,
+                                 double opponent_time)
+{
+    if (policy_ == BaselinePolicy::Reference)
+        return reference_->choose_board(board, rows, cols, score_cols, current_player_time, opponent_time);
+
+    auto moves = generate_all_valid_moves(board, player_, rows, cols, score_cols);
+    if (moves.empty())
+        return Move();
+    if (policy_ == BaselinePolicy::Random)
+        return to_move(moves[rng_() % moves.size()]);
+
+    const double WIN = std::numeric_limits<double>::max();
+    SiblingBoards children(board);
+    size_t best;
+    if (policy_ == BaselinePolicy::Greedy)
+    {
+        best = best_move(moves, [&](const auto &move)
+                         {
+                             const auto &child = children.child(move);
+                             if (check_win(child, rows, cols, score_cols) == player_)
+                                 return WIN;
+                             // The stones a win needs, nearest first; flipping a stone
+                             // into a river must not count as progress
+                             auto field = compute_goal_distance_field(child, player_, rows, cols, score_cols);
+                             std::vector<int> distances;
+                             for (int y = 0; y < rows; y++)
+                             {
+                                 for (int x = 0; x < cols; x++)
+                                 {
+                                     const Cell &cell = child[y][x];
+                                     if (cell.owner == player_ && cell.side == "stone")
+                                         distances.push_back(std::min(field[y * cols + x], rows * cols));
+                                 }
+                             }
+                             size_t needed = static_cast<size_t>(get_win_count(cols));
+                             distances.resize(std::max(distances.size(), needed), rows * cols);
+                             std::partial_sort(distances.begin(), distances.begin() + needed, distances.end());
+                             double total = 0.0;
+                             for (size_t i = 0; i < needed; i++)
+                                 total += distances[i];
+                             return -total; });
+    }
+    else
+    {
+        best = best_move(moves, [&](const auto &move)
+                         { return evaluate_board(children.child(move), player_, rows, cols, score_cols); });
+    }
+    return to_move(moves[best]);
+}
+
+MatchResult play_baseline_match(BaselinePolicy circle, BaselinePolicy square, int games, int rows,
+                                uint32_t seed, int threads)
+{
+    const int cols = rows - 1;
+    const auto score_cols = score_cols_for(cols);
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::max(1, std::min(threads, games));
+
+    MatchResult result;
+    std::mutex lock;
+    std::atomic<int> next{0};
+    auto start = std::chrono::steady_clock::now();
+    auto work = [&]
+    {
+        for (int game = next++; game < games; game = next++)
+        {
+            uint32_t game_seed = seed + 2 * static_cast<uint32_t>(game);
+            BaselineAgent agents[2] = {BaselineAgent("circle", circle, game_seed),
+                                       BaselineAgent("square", square, game_seed + 1)};
+            auto board = standard_start_board(rows, cols);
+            PositionTracker positions(rows, cols);
+            for (int y = 0; y < rows; y++)
+            {
+                for (int x = 0; x < cols; x++)
+                    positions.set_cell(x, y, piece_code(board[y][x]));
+            }
+
+            std::string winner;
+            int ply = 0;
+            MoveUndo undo;
+            for (; ply < MATCH_TURN_LIMIT; ply++)
+            {
+                const std::string side = (ply % 2 == 0) ? "circle" : "square";
+                Move move = agents[ply % 2].choose_board(board, rows, cols, score_cols, 600.0, 600.0);
+                auto legal = generate_all_valid_moves(board, side, rows, cols, score_cols);
+                auto chosen = find_move(legal, move);
+                if (!chosen)
+                {
+                    // No move or an illegal one loses, as in the Python engine
+                    winner = get_opponent(side);
+                    break;
+                }
+                make_move(board, *chosen, undo);
+                for (const auto &changed : undo.cells)
+                    positions.set_cell(changed.first.x, changed.first.y,
+                                       piece_code(board[changed.first.y][changed.first.x]));
+                winner = check_win(board, rows, cols, score_cols);
+                if (!winner.empty())
+                {
+                    ply++;
+                    break;
+                }
+                if (positions.move_applied())
+                {
+                    ply++;
+                    break;
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+            result.games++;
+            result.plies += ply;
+            if (winner == "circle")
+                result.circle_wins++;
+            else if (winner == "square")
+                result.square_wins++;
+            else
+                result.draws++;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++)
+        workers.emplace_back(work);
+    work();
+    for (auto &w : workers)
+        w.join();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,83 @@
+// Native baseline opponents
+//
+// Graded reference policies behind StudentAgent's choose() interface, so
+// self-play and regression runs can play many games without the Python
+// engine. Roughly from weakest to strongest:
+//
+//   random     a uniformly random legal move
+//   greedy     the move leaving the stones it needs to win nearest their goal
+//   one_ply    the move with the best evaluate_board() after it
+//   reference  StudentAgent's choose() stopped after its first iteration,
+//              i.e. the current heuristic at a fixed depth
+//
+// play_baseline_match() plays whole games between two policies on a pool of
+// threads, with the Python engine's turn limit and stalemate rule.
+
+#ifndef BASELINES_H
+#define BASELINES_H
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+#include "search.h"
+
+enum class BaselinePolicy
+{
+    Random,
+    Greedy,
+    OnePly,
+    Reference
+};
+
+class BaselineAgent
+{
+public:
+    BaselineAgent(const std::string &player, BaselinePolicy policy, uint32_t seed = 1);
+
+    BaselinePolicy policy() const { return policy_; }
+
+    // Same arguments as StudentAgent::choose(); the clocks only matter to
+    // the reference policy. An action-less Move when there is no legal move.
+    Move choose(const PyBoard &py_board, int rows, int cols, const std::vector<int> &score_cols,
+                double current_player_time, double opponent_time);
+
+    Move choose_board(const std::vector<std::vector<Cell>> &board, int rows, int cols,
+                      const std::vector<int> &score_cols, double current_player_time, double opponent_time);
+
+private:
+    // Index of the best of `moves` by `score` (higher is better), ties
+    // broken at random.
+    template <typename Score>
+    size_t best_move(const std::vector<std::unordered_map<std::string, std::string>> &moves, Score score);
+
+    std::string player_;
+    BaselinePolicy policy_;
+    std::mt19937 rng_;
+    std::unique_ptr<StudentAgent> reference_;
+};
+
+// Python engine limits: a game past this many moves is a draw.
+constexpr int MATCH_TURN_LIMIT = 1000;
+
+struct MatchResult
+{
+    int games = 0;
+    int circle_wins = 0;
+    int square_wins = 0;
+    int draws = 0;
+    long long plies = 0;
+    double seconds = 0.0;
+};
+
+// `games` games from the standard start on the `rows` board, circle
+// playing `circle` and square `square`, each game seeded from `seed`.
+// threads = 0 uses every core.
+MatchResult play_baseline_match(BaselinePolicy circle, BaselinePolicy square, int games, int rows,
+                                uint32_t seed = 1, int threads = 0);
+
+#endif // BASELINES_H
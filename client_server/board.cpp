@@ -0,0 +1,116 @@
+#include "board.h"
+
+int get_win_count(int cols)
+{
+    if (cols <= 12)
+        return 4;
+    if (cols <= 14)
+        return 5;
+    return 6;
+}
+
+std::string check_win(const std::vector<std::vector<Cell>> &board,
+                      int rows, int cols, const std::vector<int> &score_cols)
+{
+    const int WIN_COUNT = get_win_count(cols);
+    int top = top_score_row();
+    int bot = bottom_score_row(rows);
+    int ccount = 0, scount = 0;
+
+    for (int x : score_cols)
+    {
+        if (in_bounds(x, top, rows, cols))
+        {
+            const Cell &p = board[top][x];
+            if (!p.isEmpty() && p.owner == "circle" && p.side == "stone")
+                ccount++;
+        }
+        if (in_bounds(x, bot, rows, cols))
+        {
+            const Cell &q = board[bot][x];
+            if (!q.isEmpty() && q.owner == "square" && q.side == "stone")
+                scount++;
+        }
+    }
+
+    if (ccount >= WIN_COUNT)
+        return "circle";
+    if (scount >= WIN_COUNT)
+        return "square";
+    return "";
+}
+
+uint64_t board_hash(const std::vector<std::vector<Cell>> &board, int rows, int cols)
+{
+    uint64_t h = 0;
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            int piece = piece_code(board[y][x]);
+            if (piece)
+                h ^= zobrist_key(y * cols + x, piece);
+        }
+    }
+    return h;
+}
+
+std::vector<std::vector<Cell>> standard_start_board(int rows, int cols)
+{
+    std::vector<std::vector<Cell>> board(rows, std::vector<Cell>(cols));
+    int per_row = cols / 2;
+    int first = (cols - per_row) / 2;
+    for (int x = first; x < first + per_row; x++)
+    {
+        for (int y : {3, 4})
+        {
+            board[y][x].owner = "square";
+            board[y][x].side = "stone";
+        }
+        for (int y : {rows - 5, rows - 4})
+        {
+            board[y][x].owner = "circle";
+            board[y][x].side = "stone";
+        }
+    }
+    return board;
+}
+
+std::vector<std::vector<Cell>> from_py_board(const PyBoard &py_board, int rows, int cols)
+{
+    std::vector<std::vector<Cell>> board(rows, std::vector<Cell>(cols));
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const auto &cell_dict = py_board[y][x];
+            if (!cell_dict.empty())
+            {
+                Cell cell;
+                if (cell_dict.count("owner"))
+                    cell.owner = cell_dict.at("owner");
+                if (cell_dict.count("side"))
+                    cell.side = cell_dict.at("side");
+                if (cell_dict.count("orientation"))
+                    cell.orientation = cell_dict.at("orientation");
+                board[y][x] = cell;
+            }
+        }
+    }
+    return board;
+}
+
+PyBoard to_py_board(const std::vector<std::vector<Cell>> &board)
+{
+    PyBoard py_board(board.size(), std::vector<std::unordered_map<std::string, std::string>>(board[0].size()));
+    for (size_t y = 0; y < board.size(); y++)
+    {
+        for (size_t x = 0; x < board[y].size(); x++)
+        {
+            const Cell &cell = board[y][x];
+            if (!cell.isEmpty())
+                py_board[y][x] = {{"owner", cell.owner}, {"side", cell.side}, {"orientation", cell.orientation}};
+        }
+    }
+    return py_board;
+}
@@ -0,0 +1,259 @@
+// Board representation shared by the whole engine
+//
+// Cells, moves and the rule helpers every other part of the engine uses:
+// bounds, score rows and columns, the win check and the Zobrist keys that
+// position hashes are built from. Boards are row-major vectors of Cell
+// indexed board[y][x].
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ==================== UTILITY STRUCTURES ====================
+
+struct Position
+{
+    int x, y;
+    Position() : x(0), y(0) {}
+    Position(int x_, int y_) : x(x_), y(y_) {}
+
+    bool operator==(const Position &other) const
+    {
+        return x == other.x && y == other.y;
+    }
+
+    bool operator!=(const Position &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Hash function for Position
+namespace std
+{
+    template <>
+    struct hash<Position>
+    {
+        size_t operator()(const Position &p) const
+        {
+            return hash<int>()(p.x) ^ (hash<int>()(p.y) << 1);
+        }
+    };
+}
+
+struct Cell
+{
+    std::string owner;       // "circle" or "square" or ""
+    std::string side;        // "stone" or "river" or ""
+    std::string orientation; // "horizontal" or "vertical" or ""
+
+    Cell() : owner(""), side(""), orientation("") {}
+
+    bool isEmpty() const
+    {
+        return owner.empty();
+    }
+};
+
+struct Move
+{
+    std::string action;         // "move", "push", "flip", "rotate"
+    std::vector<int> from_pos;  // [x, y]
+    std::vector<int> to_pos;    // [x, y]
+    std::vector<int> pushed_to; // [x, y] for push actions
+    std::string orientation;    // for flip actions
+
+    Move() : action(""), from_pos(2, 0), to_pos(2, 0), pushed_to(2, 0), orientation("") {}
+};
+
+// ==================== UTILITY FUNCTIONS ====================
+
+inline bool in_bounds(int x, int y, int rows, int cols)
+{
+    return x >= 0 && x < cols && y >= 0 && y < rows;
+}
+
+// Score columns, centred: 4 wide up to 12 columns, 5 up to 14, 6 beyond,
+// as in the Python engine.
+inline std::vector<int> score_cols_for(int cols)
+{
+    int w = cols <= 12 ? 4 : cols <= 14 ? 5 : 6;
+    int start = std::max(0, (cols - w) / 2);
+    std::vector<int> result;
+    for (int i = start; i < start + w; i++)
+    {
+        result.push_back(i);
+    }
+    return result;
+}
+
+inline int top_score_row()
+{
+    return 2;
+}
+
+inline int bottom_score_row(int rows)
+{
+    return rows - 3;
+}
+
+inline std::string get_opponent(const std::string &player)
+{
+    return (player == "circle") ? "square" : "circle";
+}
+
+inline bool is_opponent_score_cell(int x, int y, const std::string &player,
+                                   int rows, int cols, const std::vector<int> &score_cols)
+{
+    int target_row = (player == "circle") ? bottom_score_row(rows) : top_score_row();
+    if (y != target_row)
+        return false;
+    return std::find(score_cols.begin(), score_cols.end(), x) != score_cols.end();
+}
+
+inline bool is_my_score_cell(int x, int y, const std::string &player,
+                             int rows, int cols, const std::vector<int> &score_cols)
+{
+    int target_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
+    if (y != target_row)
+        return false;
+    return std::find(score_cols.begin(), score_cols.end(), x) != score_cols.end();
+}
+
+// Largest board the fixed-size search scratch and the Zobrist keys cover.
+constexpr int MAX_BOARD_CELLS = 32 * 32;
+constexpr int MAX_BOARD_SIDE = 32;
+// Smallest board with both start formations clear of each other and of the
+// score rows, and room beside the score columns.
+constexpr int MIN_BOARD_ROWS = 10;
+constexpr int MIN_BOARD_COLS = 8;
+
+// Sizes the engine handles: the official 13x12, 15x14 and 17x16 and any
+// other up to 32x32.
+inline bool supported_board(int rows, int cols)
+{
+    return rows >= MIN_BOARD_ROWS && rows <= MAX_BOARD_SIDE && cols >= MIN_BOARD_COLS && cols <= MAX_BOARD_SIDE;
+}
+
+// Piece codes 1..6 (owner x stone/horizontal/vertical) per cell.
+inline uint64_t zobrist_key(int cell, int piece)
+{
+    static const std::vector<uint64_t> table = []
+    {
+        std::vector<uint64_t> t(MAX_BOARD_CELLS * 7);
+        uint64_t x = 0x9E3779B97F4A7C15ULL;
+        for (auto &v : t)
+        {
+            // splitmix64
+            uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            v = z ^ (z >> 31);
+        }
+        return t;
+    }();
+    return table[cell * 7 + piece];
+}
+
+// ==================== CELL SETS ====================
+//
+// A set of cells as a bitset over the row-major cell index. CellSet<Words>
+// covers boards of up to 64 * Words cells. with_cell_set() chooses the word
+// count at run time: the exact count for the three official sizes, so their
+// clears are fixed-length, and the 32x32 maximum for any other board.
+
+constexpr int CELL_SET_MAX_WORDS = (MAX_BOARD_CELLS + 63) / 64;
+
+template <int Words>
+class CellSet
+{
+public:
+    bool contains(int cell) const
+    {
+        return (bits_[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+    // Adds `cell`; false if it was already in the set.
+    bool insert(int cell)
+    {
+        uint64_t bit = uint64_t(1) << (cell & 63);
+        uint64_t &word = bits_[cell >> 6];
+        if (word & bit)
+            return false;
+        word |= bit;
+        return true;
+    }
+
+    void clear() { bits_.fill(0); }
+
+private:
+    std::array<uint64_t, Words> bits_{};
+};
+
+// f(set) with an empty CellSet sized for a rows x cols board.
+template <typename F>
+decltype(auto) with_cell_set(int rows, int cols, F &&f)
+{
+    switch ((rows * cols + 63) / 64)
+    {
+    case 3: // 13x12
+    {
+        CellSet<3> set;
+        return f(set);
+    }
+    case 4: // 15x14
+    {
+        CellSet<4> set;
+        return f(set);
+    }
+    case 5: // 17x16
+    {
+        CellSet<5> set;
+        return f(set);
+    }
+    default:
+    {
+        CellSet<CELL_SET_MAX_WORDS> set;
+        return f(set);
+    }
+    }
+}
+
+inline int piece_code(const Cell &cell)
+{
+    if (cell.isEmpty())
+        return 0;
+    int base = (cell.owner == "circle") ? 0 : 3;
+    if (cell.side == "stone")
+        return base + 1;
+    return base + ((cell.orientation == "horizontal") ? 2 : 3);
+}
+
+// Score cells a side must fill to win on a board `cols` wide: all of
+// score_cols_for(cols), as in gameEngine.get_win_count().
+int get_win_count(int cols);
+
+// The winning side, or "" while nobody has filled their score row.
+std::string check_win(const std::vector<std::vector<Cell>> &board,
+                      int rows, int cols, const std::vector<int> &score_cols);
+
+// Zobrist hash of every piece on the board.
+uint64_t board_hash(const std::vector<std::vector<Cell>> &board, int rows, int cols);
+
+// Same layout as gameEngine.default_start_board().
+std::vector<std::vector<Cell>> standard_start_board(int rows, int cols);
+
+// Board layout passed in from Python: one {owner, side, orientation} dict per cell.
+using PyBoard = std::vector<std::vector<std::unordered_map<std::string, std::string>>>;
+
+std::vector<std::vector<Cell>> from_py_board(const PyBoard &py_board, int rows, int cols);
+PyBoard to_py_board(const std::vector<std::vector<Cell>> &board);
+
+#endif // BOARD_H
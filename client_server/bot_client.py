@@ -9,6 +9,8 @@ import time
 import json
 import sys
 import argparse
+import queue
+import threading
 from typing import Dict, Any, Optional
 import logging
 
@@ -87,11 +89,17 @@ class BotClient:
             logger.error(f"Disconnect error: {e}")
             return False
     
-    def get_game_state(self) -> Optional[Dict[str, Any]]:
-        """Get current game state from server"""
+    def get_game_state(self, delta: bool = False, keyframe: bool = False) -> Optional[Dict[str, Any]]:
+        """Get current game state from server, optionally in delta format"""
         try:
+            params = {}
+            if delta:
+                params["delta"] = "1"
+            if keyframe:
+                params["keyframe"] = "1"
             response = requests.get(
                 f"{self.server_url}/bot/game_state/{self.player}",
+                params=params,
                 timeout=10
             )
             
@@ -235,14 +243,154 @@ class BotClient:
             # Disconnect from server
             self.disconnect()
 
+    def _start_ponder(self, game_state: Dict[str, Any], board=None):
+        """Let the agent search on the opponent's time, if it supports it."""
+        if not hasattr(self.agent, "ponder"):
+            return
+        if board is not None:
+            target = self.agent.ponder_tracked
+            args = (board, game_state["time_left"], game_state["opponent_time"])
+        else:
+            target = self.agent.ponder
+            args = (
+                self.convert_board_format(game_state["board"]),
+                game_state["rows"],
+                game_state["cols"],
+                game_state["score_cols"],
+                game_state["time_left"],
+                game_state["opponent_time"]
+            )
+        self._ponder_thread = threading.Thread(target=target, args=args, daemon=True)
+        self._ponder_thread.start()
+
+    def _stop_ponder(self):
+        thread = getattr(self, "_ponder_thread", None)
+        if thread is not None:
+            self.agent.stop_ponder()
+            thread.join()
+            self._ponder_thread = None
+
+    def play_game_push(self):
+        """Event-driven game loop.
+
+        The server pushes a 'bot_state' message on every change, so the bot
+        answers as soon as its turn starts instead of on the next poll, and
+        ponders while the opponent thinks. Agents that can search a native
+        DeltaBoard get delta-format states (move + checksum) instead of the
+        full board. Falls back to play_game() when python-socketio is not
+        installed.
+        """
+        try:
+            import socketio
+        except ImportError:
+            logger.warning("python-socketio not installed, falling back to polling")
+            return self.play_game()
+
+        logger.info(f"Starting push game loop for {self.player} using {self.strategy} strategy")
+        if not self.connect():
+            logger.error("Failed to connect to server")
+            return
+
+        delta = hasattr(self.agent, "choose_tracked")
+        board = None
+        states = queue.Queue()
+        sio = socketio.Client()
+        sio.on('bot_state', states.put)
+        handled = None  # (turn_count, your_turn) of the last state acted on
+
+        try:
+            sio.connect(self.server_url)
+            sio.emit('bot_subscribe', {"player": self.player, "delta": delta})
+            while self.connected:
+                try:
+                    game_state = states.get(timeout=5)
+                except queue.Empty:
+                    # Safety net for a missed push
+                    game_state = self.get_game_state(delta=delta)
+                    if not game_state:
+                        continue
+                # Only the newest state matters; a skipped delta just
+                # costs a keyframe below
+                while not states.empty():
+                    game_state = states.get_nowait()
+
+                if delta:
+                    # The ponder thread reads the board, stop it first
+                    self._stop_ponder()
+                    if board is None:
+                        from student_agent_cpp import DeltaBoard
+                        board = DeltaBoard(game_state["rows"], game_state["cols"])
+                    if not board.update(game_state):
+                        logger.info("Board out of sync, requesting keyframe")
+                        game_state = self.get_game_state(delta=True, keyframe=True)
+                        if not game_state or not board.update(game_state):
+                            logger.error("Could not resync board")
+                            continue
+
+                if game_state["game_status"] == "finished":
+                    logger.info("Game finished!")
+                    break
+                if game_state["game_status"] != "active":
+                    self._stop_ponder()
+                    handled = None
+                    continue
+
+                key = (game_state["turn_count"], game_state["your_turn"])
+                if key == handled:
+                    continue
+                handled = key
+
+                if not game_state["your_turn"]:
+                    self._start_ponder(game_state, board)
+                    continue
+
+                logger.info(f"My turn! Time left: {game_state['time_left']:.1f}s")
+                start_time = game_state.get("timestamp", time.time())
+                self._stop_ponder()
+                if delta:
+                    move = self.agent.choose_tracked(board, game_state["time_left"], game_state["opponent_time"])
+                else:
+                    move = self.agent.choose(
+                        self.convert_board_format(game_state["board"]),
+                        game_state["rows"],
+                        game_state["cols"],
+                        game_state["score_cols"],
+                        game_state["time_left"],
+                        game_state["opponent_time"]
+                    )
+                thinking_time = time.time() - start_time
+
+                if move is None:
+                    logger.warning("Agent returned no move")
+                    handled = None
+                    continue
+
+                logger.info(f"Agent chose move (thinking time: {thinking_time:.2f}s): {move}")
+                if not self.make_move(move, thinking_time):
+                    logger.error("Failed to send move")
+                    handled = None
+
+        except KeyboardInterrupt:
+            logger.info("Bot interrupted by user")
+        except Exception as e:
+            logger.error(f"Unexpected error in game loop: {e}")
+        finally:
+            self._stop_ponder()
+            if sio.connected:
+                sio.disconnect()
+            self.disconnect()
+
 def main():
     """Main function"""
     parser = argparse.ArgumentParser(description="Bot client for River and Stones game")
     parser.add_argument("player", choices=["circle", "square"], help="Player side")
     parser.add_argument("port", type=int, help="Server port (8181 for circle, 8182 for square)")
     parser.add_argument("--server", default="localhost", help="Server host (default: localhost)")
-    parser.add_argument("--strategy", default="random", choices=["random", "student", "student_cpp"],
+    parser.add_argument("--strategy", default="random", choices=["random", "student", "student_cpp", "native_random",
+                                                                 "native_greedy", "native_one_ply", "native_reference"],
                        help="Bot strategy (default: random)")
+    parser.add_argument("--poll", action="store_true",
+                       help="Poll the server for state instead of subscribing to pushed updates")
     parser.add_argument("--verbose", "-v", action="store_true", help="Verbose logging")
     
     args = parser.parse_args()
@@ -270,7 +418,10 @@ Strategy: {args.strategy}
 Press Ctrl+C to stop the bot.
 """)
     
-    bot.play_game()
+    if args.poll:
+        bot.play_game()
+    else:
+        bot.play_game_push()
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
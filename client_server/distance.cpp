@@ -0,0 +1,799 @@
+#include "distance.h"
+
+#include <array>
+#include <cstdlib>
+#include <deque>
+#include <sstream>
+#include <unordered_map>
+
+#include "flow.h"
+#include "pattern_db.h"
+
+// ==================== BFS PATHFINDING ====================
+
+static std::string make_bfs_key(int sx, int sy, const std::vector<Position> &goals, bool use_rivers, const std::string &player)
+{
+    std::ostringstream oss;
+    oss << sx << "," << sy << ":" << (use_rivers ? "R1" : "R0") << ":" << player << ":";
+    for (const auto &g : goals)
+    {
+        oss << g.x << "," << g.y << ";";
+    }
+    return oss.str();
+}
+
+static thread_local std::unordered_map<std::string, PathResult> GLOBAL_BFS_CACHE;
+
+void clear_bfs_cache()
+{
+    GLOBAL_BFS_CACHE.clear();
+}
+
+PathResult bfs_distance_to_goals(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers)
+{
+    Position start(start_x, start_y);
+
+    // Check if already at goal
+    for (const auto &goal : goal_cells)
+    {
+        if (start == goal)
+        {
+            return PathResult(0.0, {start});
+        }
+    }
+
+    struct QueueNode
+    {
+        Position pos;
+        int dist;
+        std::vector<Position> path;
+    };
+
+    std::deque<QueueNode> queue;
+    CellSet<CELL_SET_MAX_WORDS> visited;
+
+    queue.push_back({start, 0, {start}});
+    visited.insert(start_y * cols + start_x);
+
+    while (!queue.empty())
+    {
+        QueueNode node = queue.front();
+        queue.pop_front();
+
+        std::vector<std::pair<int, int>> dirs = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+        for (auto [dx, dy] : dirs)
+        {
+            int nx = node.pos.x + dx;
+            int ny = node.pos.y + dy;
+            Position next_pos(nx, ny);
+
+            if (!in_bounds(nx, ny, rows, cols))
+                continue;
+            if (visited.contains(ny * cols + nx))
+                continue;
+            if (is_opponent_score_cell(nx, ny, player, rows, cols, score_cols))
+                continue;
+
+            const Cell &cell = board[ny][nx];
+            std::vector<Position> new_path = node.path;
+            new_path.push_back(next_pos);
+
+            // Empty cell - can move here
+            if (cell.isEmpty())
+            {
+                for (const auto &goal : goal_cells)
+                {
+                    if (next_pos == goal)
+                    {
+                        return PathResult(node.dist + 1, new_path);
+                    }
+                }
+                visited.insert(ny * cols + nx);
+                queue.push_back({next_pos, node.dist + 1, new_path});
+            }
+            // River cell - can flow through if use_rivers
+            else if (use_rivers && cell.side == "river")
+            {
+                auto flow_dests = get_river_flow_destinations(
+                    board, nx, ny, node.pos.x, node.pos.y, player, rows, cols, score_cols);
+
+                for (const auto &flow_pos : flow_dests)
+                {
+                    if (!visited.contains(flow_pos.y * cols + flow_pos.x))
+                    {
+                        std::vector<Position> flow_path = new_path;
+                        flow_path.push_back(flow_pos);
+
+                        for (const auto &goal : goal_cells)
+                        {
+                            if (flow_pos == goal)
+                            {
+                                return PathResult(node.dist + 1, flow_path);
+                            }
+                        }
+                        visited.insert(flow_pos.y * cols + flow_pos.x);
+                        queue.push_back({flow_pos, node.dist + 1, flow_path});
+                    }
+                }
+            }
+        }
+    }
+
+    return PathResult(); // No path found
+}
+
+PathResult bfs_distance_to_goals_cached(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers)
+{
+    GLOBAL_BFS_CACHE.clear();
+    std::string key = make_bfs_key(start_x, start_y, goal_cells, use_rivers, player);
+    auto it = GLOBAL_BFS_CACHE.find(key);
+    if (it != GLOBAL_BFS_CACHE.end())
+    {
+        return it->second;
+    }
+    PathResult res = bfs_distance_to_goals(board, start_x, start_y, goal_cells, player, rows, cols, score_cols, use_rivers);
+    GLOBAL_BFS_CACHE.emplace(key, res);
+    return res;
+}
+
+std::pair<double, std::string> bfs_distance_with_flip(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    const Cell &piece = board[start_y][start_x];
+    if (piece.isEmpty() || piece.owner != player)
+    {
+        return {std::numeric_limits<double>::infinity(), "none"};
+    }
+
+    auto current_result = bfs_distance_to_goals_cached(board, start_x, start_y, goal_cells, player, rows, cols, score_cols);
+    double current_dist = current_result.distance;
+
+    if (piece.side == "stone")
+    {
+        double best_dist = current_dist;
+        std::string best_orient = "none";
+
+        // Try horizontal river
+        auto board_copy = board;
+        board_copy[start_y][start_x].side = "river";
+        board_copy[start_y][start_x].orientation = "horizontal";
+        GLOBAL_BFS_CACHE.clear();
+        auto h_result = bfs_distance_to_goals_cached(board_copy, start_x, start_y, goal_cells, player, rows, cols, score_cols);
+        if (h_result.distance < best_dist)
+        {
+            best_dist = h_result.distance;
+            best_orient = "horizontal";
+        }
+
+        // Try vertical river
+        board_copy[start_y][start_x].orientation = "vertical";
+        GLOBAL_BFS_CACHE.clear();
+        auto v_result = bfs_distance_to_goals_cached(board_copy, start_x, start_y, goal_cells, player, rows, cols, score_cols);
+        if (v_result.distance < best_dist)
+        {
+            best_dist = v_result.distance;
+            best_orient = "vertical";
+        }
+
+        return {best_dist, best_orient};
+    }
+
+    return {current_dist, "none"};
+}
+
+// ==================== GUIDED GOAL SEARCH ====================
+//
+// A* and bidirectional alternatives to bfs_distance_to_goals for one stone.
+// Both expand exactly the same steps as the BFS (plain steps onto empty
+// cells, one river flow per step) and return the same distance; the path
+// may be a different shortest path. They share fixed scratch arrays whose
+// contents are invalidated by bumping an epoch instead of clearing.
+
+struct SearchScratch
+{
+    std::array<uint32_t, MAX_BOARD_CELLS> seen{};      // forward g/parent valid when == epoch
+    std::array<uint32_t, MAX_BOARD_CELLS> closed{};    // A*: popped with its final g
+    std::array<uint32_t, MAX_BOARD_CELLS> seen_back{}; // backward g/child valid when == epoch
+    std::array<int, MAX_BOARD_CELLS> g{}, g_back{};
+    std::array<int, MAX_BOARD_CELLS> parent{}, parent_via{}; // via: river cell of a flow step, or -1
+    std::array<int, MAX_BOARD_CELLS> child{}, child_via{};
+    std::array<int, MAX_BOARD_CELLS> river_dist{};
+
+    // Open set: one intrusive list per f value (A*), or two FIFOs (bidirectional).
+    std::array<int, MAX_BOARD_CELLS> next{}, prev{}, f{};
+    std::array<int, 2 * MAX_BOARD_CELLS> bucket{};
+    std::array<uint32_t, 2 * MAX_BOARD_CELLS> bucket_seen{};
+    std::array<int, MAX_BOARD_CELLS> fifo{}, fifo_back{};
+
+    uint32_t epoch = 0;
+
+    void begin()
+    {
+        if (++epoch == 0)
+        {
+            seen.fill(0);
+            closed.fill(0);
+            seen_back.fill(0);
+            bucket_seen.fill(0);
+            epoch = 1;
+        }
+    }
+
+    int bucket_head(int fv) const { return bucket_seen[fv] == epoch ? bucket[fv] : -1; }
+
+    void push(int c, int fv)
+    {
+        int head = bucket_head(fv);
+        next[c] = head;
+        prev[c] = -1;
+        if (head >= 0)
+            prev[head] = c;
+        bucket[fv] = c;
+        bucket_seen[fv] = epoch;
+        f[c] = fv;
+    }
+
+    void unlink(int c)
+    {
+        if (prev[c] >= 0)
+            next[prev[c]] = next[c];
+        else
+            bucket[f[c]] = next[c];
+        if (next[c] >= 0)
+            prev[next[c]] = prev[c];
+    }
+};
+
+static thread_local SearchScratch SEARCH_SCRATCH;
+
+size_t search_scratch_bytes()
+{
+    return sizeof(SearchScratch);
+}
+
+// Calls step(dest, via) for every cell a stone at (fx, fy) reaches in one
+// move, in the same way bfs_distance_to_goals expands a node. Like the BFS,
+// a river standing on the start square is never flowed through.
+template <typename Step>
+void for_each_goal_step(
+    const std::vector<std::vector<Cell>> &board,
+    int fx, int fy, int start,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers,
+    Step step)
+{
+    static const int DX[4] = {1, -1, 0, 0};
+    static const int DY[4] = {0, 0, 1, -1};
+    for (int d = 0; d < 4; d++)
+    {
+        int nx = fx + DX[d];
+        int ny = fy + DY[d];
+        if (!in_bounds(nx, ny, rows, cols))
+            continue;
+        if (is_opponent_score_cell(nx, ny, player, rows, cols, score_cols))
+            continue;
+
+        const Cell &cell = board[ny][nx];
+        if (cell.isEmpty())
+        {
+            step(ny * cols + nx, -1);
+        }
+        else if (use_rivers && cell.side == "river" && ny * cols + nx != start)
+        {
+            for (const auto &p : get_river_flow_destinations(board, nx, ny, fx, fy, player, rows, cols, score_cols))
+            {
+                step(p.y * cols + p.x, ny * cols + nx);
+            }
+        }
+    }
+}
+
+// Manhattan distance from every cell to the nearest river cell, or a large
+// value if there are none. Two chamfer passes.
+static void compute_river_distance(
+    const std::vector<std::vector<Cell>> &board, int rows, int cols, std::array<int, MAX_BOARD_CELLS> &out)
+{
+    const int FAR = rows + cols;
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            int d = (board[y][x].side == "river") ? 0 : FAR;
+            if (x > 0)
+                d = std::min(d, out[y * cols + x - 1] + 1);
+            if (y > 0)
+                d = std::min(d, out[(y - 1) * cols + x] + 1);
+            out[y * cols + x] = d;
+        }
+    }
+    for (int y = rows - 1; y >= 0; y--)
+    {
+        for (int x = cols - 1; x >= 0; x--)
+        {
+            int &d = out[y * cols + x];
+            if (x + 1 < cols)
+                d = std::min(d, out[y * cols + x + 1] + 1);
+            if (y + 1 < rows)
+                d = std::min(d, out[(y + 1) * cols + x] + 1);
+        }
+    }
+}
+
+static PathResult build_goal_path(const SearchScratch &s, int start, int meet, int cols, bool with_back)
+{
+    std::vector<Position> path;
+    for (int c = meet; c != start; c = s.parent[c])
+    {
+        path.push_back(Position(c % cols, c / cols));
+        if (s.parent_via[c] >= 0)
+            path.push_back(Position(s.parent_via[c] % cols, s.parent_via[c] / cols));
+    }
+    path.push_back(Position(start % cols, start / cols));
+    std::reverse(path.begin(), path.end());
+
+    int dist = s.g[meet];
+    if (with_back)
+    {
+        dist += s.g_back[meet];
+        for (int c = meet; s.g_back[c] > 0; c = s.child[c])
+        {
+            if (s.child_via[c] >= 0)
+                path.push_back(Position(s.child_via[c] % cols, s.child_via[c] / cols));
+            path.push_back(Position(s.child[c] % cols, s.child[c] / cols));
+        }
+    }
+    return PathResult(dist, path);
+}
+
+// A* with h = min(Manhattan distance to the nearest goal, Manhattan distance
+// to the nearest river). Reaching a river's neighbour costs at least
+// (distance - 1) and the flow itself one more, so h is admissible and
+// consistent even though a flow can cross the whole board.
+PathResult astar_distance_to_goals(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers)
+{
+    Position start_pos(start_x, start_y);
+    for (const auto &goal : goal_cells)
+    {
+        if (start_pos == goal)
+            return PathResult(0.0, {start_pos});
+    }
+
+    SearchScratch &s = SEARCH_SCRATCH;
+    s.begin();
+    if (use_rivers)
+        compute_river_distance(board, rows, cols, s.river_dist);
+
+    auto h = [&](int c)
+    {
+        int x = c % cols, y = c / cols;
+        int best = rows + cols;
+        for (const auto &goal : goal_cells)
+            best = std::min(best, std::abs(goal.x - x) + std::abs(goal.y - y));
+        return use_rivers ? std::min(best, s.river_dist[c]) : best;
+    };
+    auto is_goal = [&](int c)
+    {
+        for (const auto &goal : goal_cells)
+        {
+            if (goal.y * cols + goal.x == c)
+                return true;
+        }
+        return false;
+    };
+
+    int start = start_y * cols + start_x;
+    s.seen[start] = s.epoch;
+    s.g[start] = 0;
+    s.push(start, h(start));
+
+    const int max_f = 2 * MAX_BOARD_CELLS - 1;
+    for (int fv = h(start); fv <= max_f;)
+    {
+        int u = s.bucket_head(fv);
+        if (u < 0)
+        {
+            fv++;
+            continue;
+        }
+        s.unlink(u);
+        s.closed[u] = s.epoch;
+        if (is_goal(u))
+            return build_goal_path(s, start, u, cols, false);
+
+        int gu = s.g[u];
+        for_each_goal_step(board, u % cols, u / cols, start, player, rows, cols, score_cols, use_rivers,
+                           [&](int v, int via)
+                           {
+                               if (s.closed[v] == s.epoch)
+                                   return;
+                               bool known = s.seen[v] == s.epoch;
+                               if (known && s.g[v] <= gu + 1)
+                                   return;
+                               if (known)
+                                   s.unlink(v);
+                               s.seen[v] = s.epoch;
+                               s.g[v] = gu + 1;
+                               s.parent[v] = u;
+                               s.parent_via[v] = via;
+                               s.push(v, std::min(gu + 1 + h(v), max_f));
+                           });
+    }
+    return PathResult();
+}
+
+// Level-synchronous BFS from the stone and, backwards, from the empty goal
+// cells. River flows only depend on the cell a stone flows from when that
+// cell is the occupied start square, so the backward side indexes every
+// river's flow destinations once and never steps back onto the start.
+PathResult bidirectional_distance_to_goals(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers)
+{
+    Position start_pos(start_x, start_y);
+    for (const auto &goal : goal_cells)
+    {
+        if (start_pos == goal)
+            return PathResult(0.0, {start_pos});
+    }
+
+    SearchScratch &s = SEARCH_SCRATCH;
+    s.begin();
+    const int start = start_y * cols + start_x;
+
+    // Reverse flow index: destination cell -> rivers flowing onto it.
+    std::unordered_map<int, std::vector<int>> flows_into;
+    if (use_rivers)
+    {
+        for (int y = 0; y < rows; y++)
+        {
+            for (int x = 0; x < cols; x++)
+            {
+                if (board[y][x].side != "river" || y * cols + x == start ||
+                    is_opponent_score_cell(x, y, player, rows, cols, score_cols))
+                    continue;
+                for (const auto &p : get_river_flow_destinations(board, x, y, -1, -1, player, rows, cols, score_cols))
+                    flows_into[p.y * cols + p.x].push_back(y * cols + x);
+            }
+        }
+    }
+    auto can_stand = [&](int c)
+    {
+        int x = c % cols, y = c / cols;
+        return c != start && board[y][x].isEmpty() && !is_opponent_score_cell(x, y, player, rows, cols, score_cols);
+    };
+
+    int best = std::numeric_limits<int>::max();
+    int meet = -1;
+
+    int f_head = 0, f_tail = 0, b_head = 0, b_tail = 0;
+    s.seen[start] = s.epoch;
+    s.g[start] = 0;
+    s.fifo[f_tail++] = start;
+    for (const auto &goal : goal_cells)
+    {
+        int c = goal.y * cols + goal.x;
+        if (!in_bounds(goal.x, goal.y, rows, cols) || !can_stand(c) || s.seen_back[c] == s.epoch)
+            continue;
+        s.seen_back[c] = s.epoch;
+        s.g_back[c] = 0;
+        s.fifo_back[b_tail++] = c;
+    }
+
+    int f_level = 0, b_level = 0;
+    bool forward_turn = true; // the start's own flows are only known forwards
+    while (f_head < f_tail && b_head < b_tail)
+    {
+        if (forward_turn)
+        {
+            int level_end = f_tail;
+            while (f_head < level_end)
+            {
+                int u = s.fifo[f_head++];
+                for_each_goal_step(board, u % cols, u / cols, start, player, rows, cols, score_cols, use_rivers,
+                                   [&](int v, int via)
+                                   {
+                                       if (s.seen[v] == s.epoch)
+                                           return;
+                                       s.seen[v] = s.epoch;
+                                       s.g[v] = f_level + 1;
+                                       s.parent[v] = u;
+                                       s.parent_via[v] = via;
+                                       s.fifo[f_tail++] = v;
+                                       if (s.seen_back[v] == s.epoch && s.g[v] + s.g_back[v] < best)
+                                       {
+                                           best = s.g[v] + s.g_back[v];
+                                           meet = v;
+                                       }
+                                   });
+            }
+            f_level++;
+        }
+        else
+        {
+            int level_end = b_tail;
+            while (b_head < level_end)
+            {
+                int v = s.fifo_back[b_head++];
+                auto reach = [&](int u, int via)
+                {
+                    if (s.seen_back[u] == s.epoch || !can_stand(u))
+                        return;
+                    s.seen_back[u] = s.epoch;
+                    s.g_back[u] = b_level + 1;
+                    s.child[u] = v;
+                    s.child_via[u] = via;
+                    s.fifo_back[b_tail++] = u;
+                    if (s.seen[u] == s.epoch && s.g[u] + s.g_back[u] < best)
+                    {
+                        best = s.g[u] + s.g_back[u];
+                        meet = u;
+                    }
+                };
+
+                int vx = v % cols, vy = v / cols;
+                for (auto [dx, dy] : {std::pair<int, int>{1, 0}, {-1, 0}, {0, 1}, {0, -1}})
+                {
+                    if (in_bounds(vx + dx, vy + dy, rows, cols))
+                        reach((vy + dy) * cols + vx + dx, -1);
+                }
+                auto it = flows_into.find(v);
+                if (it == flows_into.end())
+                    continue;
+                for (int r : it->second)
+                {
+                    int rx = r % cols, ry = r / cols;
+                    for (auto [dx, dy] : {std::pair<int, int>{1, 0}, {-1, 0}, {0, 1}, {0, -1}})
+                    {
+                        if (in_bounds(rx + dx, ry + dy, rows, cols))
+                            reach((ry + dy) * cols + rx + dx, r);
+                    }
+                }
+            }
+            b_level++;
+        }
+
+        if (best <= f_level + b_level)
+            break;
+        forward_turn = (f_tail - f_head) <= (b_tail - b_head);
+    }
+
+    if (meet < 0)
+        return PathResult();
+    return build_goal_path(s, start, meet, cols, true);
+}
+
+// ==================== DISTANCE FIELDS ====================
+//
+// Goal distance of every cell for one side in a single backward BFS: the
+// one-move steps of all standable cells are inverted into predecessor lists
+// and searched from the score cells. Cheaper than a search per stone when
+// every stone, or every move's landing cell, needs a distance.
+
+std::vector<int> compute_goal_distance_field(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    int n = rows * cols;
+    std::vector<std::vector<int>> preds(n);
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &cell = board[y][x];
+            if (!cell.isEmpty() && !(cell.owner == player && cell.side == "stone"))
+                continue;
+            int u = y * cols + x;
+            for_each_goal_step(board, x, y, u, player, rows, cols, score_cols, true,
+                               [&](int v, int)
+                               { preds[v].push_back(u); });
+        }
+    }
+
+    std::vector<int> dist(n, FIELD_UNREACHABLE);
+    std::vector<int> queue;
+    queue.reserve(n);
+    int score_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
+    for (int x : score_cols)
+    {
+        const Cell &cell = board[score_row][x];
+        if (cell.isEmpty() || (cell.owner == player && cell.side == "stone"))
+        {
+            dist[score_row * cols + x] = 0;
+            queue.push_back(score_row * cols + x);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        int v = queue[head];
+        for (int u : preds[v])
+        {
+            if (dist[u] != FIELD_UNREACHABLE)
+                continue;
+            dist[u] = dist[v] + 1;
+            queue.push_back(u);
+        }
+    }
+    return dist;
+}
+
+// ==================== PUSH OUTCOMES ====================
+
+GoalFields::GoalFields(const std::vector<std::vector<Cell>> &board, int rows, int cols,
+                       const std::vector<int> &score_cols)
+    : circle(compute_goal_distance_field(board, "circle", rows, cols, score_cols)),
+      square(compute_goal_distance_field(board, "square", rows, cols, score_cols))
+{
+}
+
+// `owner`'s stone at (x, y), capped at rows * cols when it cannot get home.
+static int stone_goal_distance(const std::vector<int> &field, int x, int y, const std::string &owner,
+                               int rows, int cols, const std::vector<int> &score_cols)
+{
+    const int far = rows * cols;
+    if (is_my_score_cell(x, y, owner, rows, cols, score_cols))
+        return 0;
+    if (field[y * cols + x] != FIELD_UNREACHABLE)
+        return std::min(field[y * cols + x], far);
+    int best = far;
+    for (auto [dx, dy] : {std::pair<int, int>{1, 0}, {-1, 0}, {0, 1}, {0, -1}})
+    {
+        int nx = x + dx, ny = y + dy;
+        if (in_bounds(nx, ny, rows, cols) && field[ny * cols + nx] != FIELD_UNREACHABLE)
+            best = std::min(best, field[ny * cols + nx] + 1);
+    }
+    return best;
+}
+
+PushOutcome evaluate_push(
+    const std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    const GoalFields &fields,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    PushOutcome out;
+    int fx = std::stoi(move.at("from_x")), fy = std::stoi(move.at("from_y"));
+    int tx = std::stoi(move.at("to_x")), ty = std::stoi(move.at("to_y"));
+    int px = std::stoi(move.at("pushed_x")), py = std::stoi(move.at("pushed_y"));
+    const Cell &pusher = board[fy][fx];
+    const Cell &pushed = board[ty][tx];
+
+    if (pusher.side == "stone")
+    {
+        const auto &field = fields.of(pusher.owner);
+        out.pusher_gain = stone_goal_distance(field, fx, fy, pusher.owner, rows, cols, score_cols) -
+                          stone_goal_distance(field, tx, ty, pusher.owner, rows, cols, score_cols);
+    }
+    if (pushed.side == "stone")
+    {
+        const auto &field = fields.of(pushed.owner);
+        out.pushed_gain = stone_goal_distance(field, tx, ty, pushed.owner, rows, cols, score_cols) -
+                          stone_goal_distance(field, px, py, pushed.owner, rows, cols, score_cols);
+        bool was_home = is_my_score_cell(tx, ty, pushed.owner, rows, cols, score_cols);
+        bool is_home = is_my_score_cell(px, py, pushed.owner, rows, cols, score_cols);
+        out.scores = is_home && !was_home;
+        out.ejects = was_home && !is_home;
+    }
+    out.net = out.pusher_gain + (pushed.owner == pusher.owner ? out.pushed_gain : -out.pushed_gain);
+    return out;
+}
+
+// ==================== PATTERN DATABASE DISTANCE ====================
+//
+// Looks up pattern_db.h with the stone's offset from its goal and its four
+// neighbours. Unlike the BFS this credits flipping or rotating an own
+// neighbour, so it sees river shortcuts that do not exist yet.
+
+static uint8_t pattern_cell_state(
+    const std::vector<std::vector<Cell>> &board,
+    int x, int y,
+    const std::string &owner,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    if (!in_bounds(x, y, rows, cols) || is_opponent_score_cell(x, y, owner, rows, cols, score_cols))
+        return PatternDB::BLOCK;
+    const Cell &cell = board[y][x];
+    if (cell.isEmpty())
+        return PatternDB::EMPTY;
+    bool own = cell.owner == owner;
+    if (cell.side == "stone")
+        return own ? PatternDB::OWN_STONE : PatternDB::BLOCK;
+    if (cell.orientation == "horizontal")
+        return own ? PatternDB::OWN_RIVER_H : PatternDB::RIVER_H;
+    return own ? PatternDB::OWN_RIVER_V : PatternDB::RIVER_V;
+}
+
+// The stone's offset from its goal and its neighbour pattern, as the
+// database indexes them.
+static void pattern_key(
+    const std::vector<std::vector<Cell>> &board,
+    int x, int y,
+    const std::string &owner,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    int &dy, int &dx, int &pattern)
+{
+    int score_row = (owner == "circle") ? top_score_row() : bottom_score_row(rows);
+    int toward = (owner == "circle") ? 1 : -1; // direction of the board's middle
+    dy = (y - score_row) * toward;
+
+    dx = 0;
+    int inward = -1;
+    if (x < score_cols.front())
+    {
+        dx = score_cols.front() - x;
+        inward = 1;
+    }
+    else if (x > score_cols.back())
+    {
+        dx = x - score_cols.back();
+    }
+
+    std::array<uint8_t, PatternDB::NEIGHBOURS> n = {
+        pattern_cell_state(board, x, y - toward, owner, rows, cols, score_cols),
+        pattern_cell_state(board, x, y + toward, owner, rows, cols, score_cols),
+        pattern_cell_state(board, x + inward, y, owner, rows, cols, score_cols),
+        pattern_cell_state(board, x - inward, y, owner, rows, cols, score_cols)};
+    pattern = PatternDB::encode(n);
+}
+
+int pattern_distance(
+    const std::vector<std::vector<Cell>> &board,
+    int x, int y,
+    const std::string &owner,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    int dy, dx, pattern;
+    pattern_key(board, x, y, owner, rows, cols, score_cols, dy, dx, pattern);
+    return PatternDB::Database::instance().distance(dy, dx, pattern);
+}
+
+int pattern_flip_saving(
+    const std::vector<std::vector<Cell>> &board,
+    int x, int y,
+    const std::string &owner,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    int dy, dx, pattern;
+    pattern_key(board, x, y, owner, rows, cols, score_cols, dy, dx, pattern);
+    return PatternDB::Database::instance().flip_saving(dy, dx, pattern);
+}
@@ -0,0 +1,157 @@
+// Goal distances for single stones and whole boards
+//
+// bfs_distance_to_goals is the reference search: plain steps onto empty
+// cells and one river flow per step, the fewest moves for one stone to reach
+// any of its goal cells. The A* and bidirectional searches expand the same
+// steps and return the same distance (the path may be a different shortest
+// path) on fixed per-thread scratch arrays. Distance fields give every
+// cell's distance for one side in a single backward search, and the
+// pattern-database distance credits flipping or rotating an own neighbour
+// into a river first. evaluate_push reads what a push does to both pieces
+// off the two sides' fields without making it.
+
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+
+struct PathResult
+{
+    double distance;
+    std::vector<Position> path;
+
+    PathResult() : distance(std::numeric_limits<double>::infinity()) {}
+    PathResult(double d, const std::vector<Position> &p) : distance(d), path(p) {}
+};
+
+PathResult bfs_distance_to_goals(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers = true);
+
+PathResult bfs_distance_to_goals_cached(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers = true);
+
+// Best goal distance after flipping the stone at (start_x, start_y) into a
+// river, with the orientation used ("none" if flipping does not help).
+std::pair<double, std::string> bfs_distance_with_flip(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// Searches and caches are per thread so AgentPool workers can search
+// concurrently. Moves that change rivers clear the calling thread's cache.
+void clear_bfs_cache();
+
+PathResult astar_distance_to_goals(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers = true);
+
+PathResult bidirectional_distance_to_goals(
+    const std::vector<std::vector<Cell>> &board,
+    int start_x, int start_y,
+    const std::vector<Position> &goal_cells,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool use_rivers = true);
+
+// Size of the scratch arrays each thread running A* or the bidirectional
+// search holds.
+size_t search_scratch_bytes();
+
+constexpr int FIELD_UNREACHABLE = std::numeric_limits<int>::max();
+
+// Goal distance of every cell (row-major) for `player`, FIELD_UNREACHABLE
+// where no sequence of moves reaches a score cell.
+std::vector<int> compute_goal_distance_field(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// ==================== PUSH OUTCOMES ====================
+//
+// Static exchange evaluation for pushes: the change in goal distance of the
+// pusher and of the pushed stone, read off the goal distance fields of the
+// position before the push. The fields only cover cells a stone could stand
+// on, so a piece's distance on an occupied cell is one more than its best
+// free neighbour's. Lanes the push opens or closes for later moves are not
+// seen; that is the price of not making the move.
+//
+// Under movegen's push rules only the mover's own stones can be pushed onto
+// or off their score cells: neither the pusher nor the pushed piece may end
+// on a cell the mover's opponent scores on. So `scores` and `ejects` are
+// never set for an opponent stone; verify_move() checks this on every push.
+
+struct GoalFields
+{
+    GoalFields(const std::vector<std::vector<Cell>> &board, int rows, int cols,
+               const std::vector<int> &score_cols);
+
+    const std::vector<int> &of(const std::string &owner) const
+    {
+        return owner == "circle" ? circle : square;
+    }
+
+    std::vector<int> circle, square;
+};
+
+struct PushOutcome
+{
+    int pusher_gain = 0; // moves the pushing stone saves (0 for a river)
+    int pushed_gain = 0; // moves the pushed stone saves; negative when pushed back
+    bool scores = false; // the pushed stone lands on one of its score cells (own stones only)
+    bool ejects = false; // the pushed stone leaves one (own stones only)
+    int net = 0;         // moves saved by the pusher's side minus the other side's
+};
+
+PushOutcome evaluate_push(
+    const std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    const GoalFields &fields,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// Moves for the stone at (x, y) to reach its score row per pattern_db.h.
+int pattern_distance(
+    const std::vector<std::vector<Cell>> &board,
+    int x, int y,
+    const std::string &owner,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// Moves the stone at (x, y) saves per pattern_db.h by flipping or rotating
+// one own neighbour first.
+int pattern_flip_saving(
+    const std::vector<std::vector<Cell>> &board,
+    int x, int y,
+    const std::string &owner,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+#endif // DISTANCE_H
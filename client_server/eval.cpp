@@ -0,0 +1,342 @@
+#include "eval.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+PhaseInfo detect_game_phase(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    std::string opponent = get_opponent(player);
+    int my_score_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
+    int opp_score_row = (player == "circle") ? bottom_score_row(rows) : top_score_row();
+
+    PhaseInfo info{GamePhase::Midgame, 0, 0, rows, rows};
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &cell = board[y][x];
+            if (cell.side != "stone")
+                continue;
+            if (cell.owner == player)
+            {
+                info.my_min_rows = std::min(info.my_min_rows, std::abs(y - my_score_row));
+                if (y == my_score_row && std::find(score_cols.begin(), score_cols.end(), x) != score_cols.end())
+                    info.my_scoring++;
+            }
+            else if (cell.owner == opponent)
+            {
+                info.opp_min_rows = std::min(info.opp_min_rows, std::abs(y - opp_score_row));
+                if (y == opp_score_row && std::find(score_cols.begin(), score_cols.end(), x) != score_cols.end())
+                    info.opp_scoring++;
+            }
+        }
+    }
+
+    int half_run = (bottom_score_row(rows) - top_score_row()) / 2;
+    if (info.my_scoring + info.opp_scoring > 0 || std::min(info.my_min_rows, info.opp_min_rows) <= 1)
+        info.phase = GamePhase::Endgame;
+    else if (info.my_min_rows > half_run && info.opp_min_rows > half_run)
+        info.phase = GamePhase::Opening;
+    return info;
+}
+
+std::shared_ptr<const ThreatMap> compute_threat_map(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &attacker,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    auto map = std::make_shared<ThreatMap>();
+    map->cols = cols;
+    map->path_count.assign(rows * cols, 0);
+    map->cut.assign(rows * cols, 0);
+
+    std::string defender = get_opponent(attacker);
+    int score_row = (attacker == "circle") ? top_score_row() : bottom_score_row(rows);
+    std::vector<Position> goals;
+    for (int x : score_cols)
+        goals.push_back(Position(x, score_row));
+
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &cell = board[y][x];
+            if (cell.side != "stone" || cell.owner != attacker)
+                continue;
+            for (auto [dx, dy] : {std::pair<int, int>{1, 0}, {-1, 0}, {0, 1}, {0, -1}})
+            {
+                int nx = x + dx, ny = y + dy;
+                if (in_bounds(nx, ny, rows, cols) && board[ny][nx].owner == defender)
+                {
+                    map->blocked++;
+                    break;
+                }
+            }
+            auto result = astar_distance_to_goals(board, x, y, goals, attacker, rows, cols, score_cols);
+            if (result.distance < std::numeric_limits<double>::infinity())
+                map->stones.push_back({x, y, result.distance, result.path});
+        }
+    }
+    std::stable_sort(map->stones.begin(), map->stones.end(),
+                     [](const StoneInfo &a, const StoneInfo &b)
+                     { return a.dist < b.dist; });
+
+    std::vector<std::vector<Cell>> probe;
+    for (const auto &s : map->stones)
+    {
+        map->min_dist = std::min(map->min_dist, s.dist);
+        for (const auto &p : s.path)
+        {
+            uint8_t &count = map->path_count[p.y * cols + p.x];
+            if (count < 255)
+                count++;
+        }
+        if (s.dist >= THREAT_CUT_RADIUS)
+            continue;
+
+        // Interior landing cells only: the start holds the stone and a goal
+        // cell cannot be entered by the defender anyway.
+        for (size_t i = 1; i + 1 < s.path.size(); i++)
+        {
+            Position p = s.path[i];
+            int c = p.y * cols + p.x;
+            if (map->cut[c] || !board[p.y][p.x].isEmpty() ||
+                is_opponent_score_cell(p.x, p.y, defender, rows, cols, score_cols))
+                continue;
+            if (probe.empty())
+                probe = board;
+            probe[p.y][p.x].owner = defender;
+            probe[p.y][p.x].side = "stone";
+            auto blocked = astar_distance_to_goals(probe, s.x, s.y, goals, attacker, rows, cols, score_cols);
+            probe[p.y][p.x] = Cell();
+            if (blocked.distance > s.dist)
+            {
+                map->cut[c] = 1;
+                map->cut_cells.push_back(p);
+            }
+        }
+    }
+    return map;
+}
+
+// Heap bytes one cached map holds, its hash node included.
+static size_t threat_map_bytes(const ThreatMap &map)
+{
+    size_t bytes = sizeof(ThreatMap) + map.stones.capacity() * sizeof(StoneInfo) + map.path_count.capacity() +
+                   map.cut.capacity() + map.cut_cells.capacity() * sizeof(Position);
+    for (const auto &s : map.stones)
+        bytes += s.path.capacity() * sizeof(Position);
+    // shared_ptr control block, hash node and bucket
+    return bytes + 2 * sizeof(void *) + sizeof(std::pair<const uint64_t, std::shared_ptr<const ThreatMap>>) +
+           2 * sizeof(void *);
+}
+
+struct ThreatCacheTotals
+{
+    std::atomic<size_t> entries{0}, bytes{0};
+    std::atomic<uint64_t> probes{0}, hits{0};
+    std::atomic<int> threads{0};
+};
+
+// One thread's cache; its totals include it for as long as it lives.
+struct ThreatCache
+{
+    ThreatCacheTotals &totals;
+    std::unordered_map<uint64_t, std::shared_ptr<const ThreatMap>> maps;
+    size_t bytes = 0;
+
+    explicit ThreatCache(ThreatCacheTotals &t) : totals(t) { totals.threads++; }
+    ~ThreatCache()
+    {
+        clear();
+        totals.threads--;
+    }
+
+    void clear()
+    {
+        totals.entries -= maps.size();
+        totals.bytes -= bytes;
+        maps.clear();
+        bytes = 0;
+    }
+};
+
+static ThreatCacheTotals SHARED_THREAT_TOTALS;
+static thread_local ThreatCache SHARED_THREAT_CACHE(SHARED_THREAT_TOTALS);
+
+// Set by ThreatCacheScope; nullptr for the shared cache.
+static thread_local ThreatCacheAccount *CURRENT_THREAT_ACCOUNT = nullptr;
+static thread_local ThreatCache *CURRENT_THREAT_CACHE = nullptr;
+
+CacheStats threat_cache_stats()
+{
+    int threads = std::max(1, SHARED_THREAT_TOTALS.threads.load());
+    CacheStats s;
+    s.name = "threat maps (shared)";
+    s.bytes = SHARED_THREAT_TOTALS.bytes;
+    s.entries = SHARED_THREAT_TOTALS.entries;
+    s.capacity = THREAT_CACHE_LIMIT * threads;
+    s.probes = SHARED_THREAT_TOTALS.probes;
+    s.hits = SHARED_THREAT_TOTALS.hits;
+    return s;
+}
+
+void reset_threat_cache_counters()
+{
+    SHARED_THREAT_TOTALS.probes = 0;
+    SHARED_THREAT_TOTALS.hits = 0;
+}
+
+ThreatCacheAccount::ThreatCacheAccount(size_t bytes_per_thread)
+    : budget_(bytes_per_thread), totals_(std::make_unique<ThreatCacheTotals>())
+{
+}
+
+ThreatCacheAccount::~ThreatCacheAccount()
+{
+    caches_.clear(); // before the totals they update
+}
+
+ThreatCache &ThreatCacheAccount::cache_for_thread()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &cache = caches_[std::this_thread::get_id()];
+    if (!cache)
+        cache = std::make_unique<ThreatCache>(*totals_);
+    return *cache;
+}
+
+CacheStats ThreatCacheAccount::stats() const
+{
+    int threads = std::max(1, totals_->threads.load());
+    CacheStats s;
+    s.name = "threat maps";
+    s.bytes = totals_->bytes;
+    s.budget_bytes = budget_ * threads;
+    s.entries = totals_->entries;
+    s.probes = totals_->probes;
+    s.hits = totals_->hits;
+    return s;
+}
+
+ThreatCacheScope::ThreatCacheScope(ThreatCacheAccount *account)
+{
+    if (account == CURRENT_THREAT_ACCOUNT)
+        return;
+    active_ = true;
+    previous_account_ = CURRENT_THREAT_ACCOUNT;
+    previous_cache_ = CURRENT_THREAT_CACHE;
+    CURRENT_THREAT_ACCOUNT = account;
+    CURRENT_THREAT_CACHE = account ? &account->cache_for_thread() : nullptr;
+}
+
+ThreatCacheScope::~ThreatCacheScope()
+{
+    if (!active_)
+        return;
+    CURRENT_THREAT_ACCOUNT = previous_account_;
+    CURRENT_THREAT_CACHE = previous_cache_;
+}
+
+std::shared_ptr<const ThreatMap> analyse_threats(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &attacker,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    uint64_t key = board_hash(board, rows, cols) ^ (attacker == "circle" ? zobrist_key(0, 0) : 0);
+    ThreatCache &cache = CURRENT_THREAT_CACHE ? *CURRENT_THREAT_CACHE : SHARED_THREAT_CACHE;
+    cache.totals.probes.fetch_add(1, std::memory_order_relaxed);
+    auto it = cache.maps.find(key);
+    if (it != cache.maps.end())
+    {
+        cache.totals.hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+    auto map = compute_threat_map(board, attacker, rows, cols, score_cols);
+    size_t bytes = threat_map_bytes(*map);
+    size_t budget = CURRENT_THREAT_ACCOUNT ? CURRENT_THREAT_ACCOUNT->budget() : 0;
+    if (budget ? cache.bytes + bytes > budget : cache.maps.size() >= THREAT_CACHE_LIMIT)
+        cache.clear();
+    cache.maps.emplace(key, map);
+    cache.bytes += bytes;
+    cache.totals.entries++;
+    cache.totals.bytes += bytes;
+    return map;
+}
+
+// Goal distance for every stone of `owner` that can reach its score row.
+// One distance field serves all the stones at once; its distances are the
+// per-stone BFS distances, but no paths are kept.
+std::vector<StoneInfo> collect_stone_distances(const EvalContext &ctx, const std::string &owner)
+{
+    auto field = compute_goal_distance_field(ctx.board, owner, ctx.rows, ctx.cols, ctx.score_cols);
+
+    std::vector<StoneInfo> stones;
+    for (int y = 0; y < ctx.rows; y++)
+    {
+        for (int x = 0; x < ctx.cols; x++)
+        {
+            const Cell &cell = ctx.board[y][x];
+            if (cell.side != "stone" || cell.owner != owner)
+                continue;
+            int dist = field[y * ctx.cols + x];
+            if (dist != FIELD_UNREACHABLE)
+                stones.push_back({x, y, static_cast<double>(dist), {}});
+        }
+    }
+    return stones;
+}
+
+double evaluate_board(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    const double WIN_SCORE = 1e15;
+    const double LOSE_SCORE = -1e15;
+
+    std::string opponent = get_opponent(player);
+    PhaseInfo info = detect_game_phase(board, player, rows, cols, score_cols);
+
+    // Winning conditions
+    if (info.my_scoring >= get_win_count(cols))
+        return WIN_SCORE;
+    if (info.opp_scoring >= get_win_count(cols))
+        return LOSE_SCORE;
+
+    switch (info.phase)
+    {
+    case GamePhase::Opening:
+    {
+        EvalContext ctx(board, player, opponent, rows, cols, score_cols, info, OPENING_WEIGHTS);
+        return OpeningEvaluator::evaluate(ctx);
+    }
+    case GamePhase::Midgame:
+    {
+        EvalContext ctx(board, player, opponent, rows, cols, score_cols, info, MIDGAME_WEIGHTS);
+        return MidgameEvaluator::evaluate(ctx);
+    }
+    default:
+    {
+        EvalContext ctx(board, player, opponent, rows, cols, score_cols, info, ENDGAME_WEIGHTS);
+        return EndgameEvaluator::evaluate(ctx);
+    }
+    }
+}
+
+std::vector<std::tuple<std::string, std::string, double, long long>> eval_feature_stats()
+{
+    std::vector<std::tuple<std::string, std::string, double, long long>> out;
+    OpeningEvaluator::report("opening", out);
+    MidgameEvaluator::report("midgame", out);
+    EndgameEvaluator::report("endgame", out);
+    return out;
+}
@@ -0,0 +1,656 @@
+// Position evaluation
+//
+// Game phase detection, the per-position threat map shared by evaluation,
+// defensive flips and move ordering, and the phase evaluators assembled from
+// feature policy types.
+
+#ifndef EVAL_H
+#define EVAL_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+#include "distance.h"
+#include "memory.h"
+
+// ==================== GAME PHASE DETECTION ====================
+
+enum class GamePhase
+{
+    Opening,
+    Midgame,
+    Endgame
+};
+
+struct PhaseInfo
+{
+    GamePhase phase;
+    int my_scoring, opp_scoring;
+    int my_min_rows, opp_min_rows; // closest stone's row distance to its score row
+};
+
+// Weights used by the phase kernels. A kernel only reads the terms it computes.
+struct EvalWeights
+{
+    double scoring_stone;
+    double my_min_distance;
+    double opp_min_distance;
+    double within_1_rows;
+    double my_river;
+    double my_river_near_goal;
+    double my_river_horizontal;
+    double my_river_vertical;
+    double my_river_near_stone;
+    double river_on_opp_path;
+    double opp_river;
+    double opp_river_near_goal;
+    double opp_river_near_stone;
+    double opp_blocked;
+    double advancement;
+    double clear_path;
+    double river_potential;
+};
+
+static constexpr EvalWeights OPENING_WEIGHTS = {
+    0.0, 1e5, 1e7, 1e6,
+    1e4, 1e10 + 1e6, 1e5, 1e6, 5e8 + 1e6, 0.0, 1e4, 1e3, 1e6,
+    0.0, 1e5, 1e12, 1e8};
+
+static constexpr EvalWeights MIDGAME_WEIGHTS = {
+    1e14, 1e5, 1e7, 1e6,
+    1e4, 1e10 + 1e6, 1e5, 1e6, 5e8 + 1e6, 1e6, 1e4, 1e3, 1e6,
+    1e8, 1e5, 1e12, 1e8};
+
+static constexpr EvalWeights ENDGAME_WEIGHTS = {
+    1e14, 1e6, 1e8, 1e7,
+    0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+    1e9, 0.0, 0.0, 0.0};
+
+// One pass over the stones: scoring counts and the closest row distance per
+// side. Row distance ignores rivers, so the opening threshold is conservative.
+PhaseInfo detect_game_phase(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// ==================== THREAT ANALYSIS ====================
+//
+// One pass per position and attacking side: every attacker stone that can
+// reach its score row with its distance and path, how often each cell lies
+// on those paths, and the critical cut cells where a single defending piece
+// lengthens a near threat. Evaluation, defensive-flip scoring and move
+// ordering all read the same map, cached by a Zobrist hash of the board.
+
+struct StoneInfo
+{
+    int x, y;
+    double dist;
+    std::vector<Position> path;
+};
+
+// Threats closer than this get their cut cells computed.
+constexpr double THREAT_CUT_RADIUS = 6.0;
+
+struct ThreatMap
+{
+    std::vector<StoneInfo> stones; // reachable attacker stones, nearest first
+    std::vector<uint8_t> path_count; // per cell: number of stone paths through it
+    std::vector<uint8_t> cut;        // per cell: blocking it lengthens a near threat
+    std::vector<Position> cut_cells;
+    int blocked = 0; // attacker stones with a defending piece orthogonally adjacent
+    double min_dist = std::numeric_limits<double>::infinity();
+    int cols = 0;
+
+    int paths_through(int x, int y) const { return path_count[y * cols + x]; }
+    bool is_cut(int x, int y) const { return cut[y * cols + x] != 0; }
+};
+
+std::shared_ptr<const ThreatMap> compute_threat_map(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &attacker,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// compute_threat_map through a per-thread cache keyed by board hash.
+std::shared_ptr<const ThreatMap> analyse_threats(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &attacker,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// By default every thread has one cache, shared by whichever agents search
+// on it and emptied once it holds THREAT_CACHE_LIMIT maps.
+constexpr size_t THREAT_CACHE_LIMIT = 1 << 15;
+
+// The shared caches summed over all threads; probes and hits since the last
+// reset.
+CacheStats threat_cache_stats();
+void reset_threat_cache_counters();
+
+struct ThreatCache;
+struct ThreatCacheTotals;
+
+// Threat caches of one owner (an agent with a memory budget): a cache per
+// thread it searches on, each emptied when the next map would take it over
+// the byte budget, with their own counters. analyse_threats uses them on
+// threads where a ThreatCacheScope for the account is open.
+class ThreatCacheAccount
+{
+public:
+    explicit ThreatCacheAccount(size_t bytes_per_thread);
+    ~ThreatCacheAccount();
+    ThreatCacheAccount(const ThreatCacheAccount &) = delete;
+    ThreatCacheAccount &operator=(const ThreatCacheAccount &) = delete;
+
+    void set_budget(size_t bytes_per_thread) { budget_ = bytes_per_thread; }
+    size_t budget() const { return budget_; }
+    CacheStats stats() const;
+
+private:
+    friend class ThreatCacheScope;
+    // The calling thread's cache, made on its first use.
+    ThreatCache &cache_for_thread();
+
+    std::atomic<size_t> budget_;
+    std::unique_ptr<ThreatCacheTotals> totals_;
+    mutable std::mutex mutex_; // guards caches_
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreatCache>> caches_;
+};
+
+// Makes `account` the calling thread's threat cache until the scope closes;
+// nullptr selects the shared cache. Cheap when the account is already the
+// current one, so every minimax node can open one.
+class ThreatCacheScope
+{
+public:
+    explicit ThreatCacheScope(ThreatCacheAccount *account);
+    ~ThreatCacheScope();
+    ThreatCacheScope(const ThreatCacheScope &) = delete;
+    ThreatCacheScope &operator=(const ThreatCacheScope &) = delete;
+
+private:
+    bool active_ = false;
+    ThreatCacheAccount *previous_account_ = nullptr;
+    ThreatCache *previous_cache_ = nullptr;
+};
+
+// ==================== EVALUATION FEATURES ====================
+//
+// Each feature is a policy type with a name, an accumulator State, an
+// on_cell hook called for every occupied cell and a finish step that turns
+// the state into a score. Evaluator<Features...> fuses the hooks of all
+// listed features into one board pass; a feature left out of the list
+// costs nothing. Build with -DEVAL_PROFILE=1 to time each feature.
+
+#ifndef EVAL_PROFILE
+#define EVAL_PROFILE 0
+#endif
+
+struct EvalContext
+{
+    const std::vector<std::vector<Cell>> &board;
+    const std::string &player;
+    const std::string &opponent;
+    int rows, cols;
+    const std::vector<int> &score_cols;
+    const PhaseInfo &info;
+    const EvalWeights &w;
+    int my_score_row, opp_score_row;
+    std::vector<StoneInfo> my_stones;  // filled only if a feature needs them, without paths
+    std::shared_ptr<const ThreatMap> threats; // opponent's, set only if a feature needs it
+
+    EvalContext(const std::vector<std::vector<Cell>> &board_, const std::string &player_,
+                const std::string &opponent_, int rows_, int cols_,
+                const std::vector<int> &score_cols_, const PhaseInfo &info_, const EvalWeights &w_)
+        : board(board_), player(player_), opponent(opponent_), rows(rows_), cols(cols_),
+          score_cols(score_cols_), info(info_), w(w_),
+          my_score_row((player_ == "circle") ? top_score_row() : bottom_score_row(rows_)),
+          opp_score_row((player_ == "circle") ? bottom_score_row(rows_) : top_score_row())
+    {
+    }
+};
+
+inline double proximity_term(double dist)
+{
+    return std::pow(2, 35.0 - std::min(dist, 35.0)) * 1000.0;
+}
+
+// Goal distance for every stone of `owner` that can reach its score row,
+// from one distance field (paths are left empty).
+std::vector<StoneInfo> collect_stone_distances(const EvalContext &ctx, const std::string &owner);
+
+struct EvalFeature
+{
+    static constexpr bool needs_my_stones = false;
+    static constexpr bool needs_threats = false;
+    struct State
+    {
+    };
+    template <typename S>
+    static void on_cell(S &, const EvalContext &, int, int, const Cell &) {}
+    template <typename S>
+    static double finish(const S &, const EvalContext &) { return 0.0; }
+};
+
+struct ScoringStonesFeature : EvalFeature
+{
+    static constexpr const char *name = "scoring_stones";
+    static double finish(const State &, const EvalContext &ctx)
+    {
+        return (ctx.info.my_scoring - ctx.info.opp_scoring) * ctx.w.scoring_stone;
+    }
+};
+
+struct MyDistanceFeature : EvalFeature
+{
+    static constexpr const char *name = "my_distance";
+    static constexpr bool needs_my_stones = true;
+    static double finish(const State &, const EvalContext &ctx)
+    {
+        double score = 0.0;
+        double min_dist = 999.0;
+        for (const auto &s : ctx.my_stones)
+        {
+            score += proximity_term(s.dist);
+            min_dist = std::min(min_dist, s.dist);
+            if (std::abs(s.y - ctx.my_score_row) <= 1)
+                score += ctx.w.within_1_rows;
+        }
+        return score - min_dist * ctx.w.my_min_distance;
+    }
+};
+
+struct OppThreatFeature : EvalFeature
+{
+    static constexpr const char *name = "opp_threat";
+    static constexpr bool needs_threats = true;
+
+    static double threat_bonus(double dist)
+    {
+        if (dist <= 1)
+            return 1e14;
+        if (dist <= 2)
+            return 1e12;
+        if (dist <= 3)
+            return 1e11;
+        if (dist <= 4)
+            return 1e10;
+        return 0.0;
+    }
+
+    static double finish(const State &, const EvalContext &ctx)
+    {
+        double score = 0.0;
+        double min_dist = 999.0;
+        for (const auto &s : ctx.threats->stones)
+        {
+            score -= proximity_term(s.dist) + threat_bonus(s.dist);
+            min_dist = std::min(min_dist, s.dist);
+        }
+        return score + min_dist * ctx.w.opp_min_distance;
+    }
+};
+
+// Opening stand-in for OppThreatFeature: row distance instead of a BFS per
+// opponent stone.
+struct OppRowRaceFeature : EvalFeature
+{
+    static constexpr const char *name = "opp_row_race";
+    struct State
+    {
+        double penalty = 0.0;
+        double min_rows = 999.0;
+    };
+    static void on_cell(State &s, const EvalContext &ctx, int, int y, const Cell &cell)
+    {
+        if (cell.side != "stone" || cell.owner != ctx.opponent)
+            return;
+        double row_dist = std::abs(y - ctx.opp_score_row);
+        s.penalty += proximity_term(row_dist);
+        s.min_rows = std::min(s.min_rows, row_dist);
+    }
+    static double finish(const State &s, const EvalContext &ctx)
+    {
+        return s.min_rows * ctx.w.opp_min_distance - s.penalty;
+    }
+};
+
+struct RiverFeature : EvalFeature
+{
+    static constexpr const char *name = "rivers";
+    static constexpr bool needs_my_stones = true;
+    struct State
+    {
+        double score = 0.0;
+    };
+    static void on_cell(State &s, const EvalContext &ctx, int x, int y, const Cell &cell)
+    {
+        if (cell.side != "river")
+            return;
+        const EvalWeights &w = ctx.w;
+
+        int near_my_stones = 0;
+        for (const auto &stone : ctx.my_stones)
+        {
+            if (std::abs(x - stone.x) + std::abs(y - stone.y) <= 1)
+                near_my_stones++;
+        }
+
+        if (cell.owner == ctx.player)
+        {
+            s.score += w.my_river;
+            if (std::abs(y - ctx.my_score_row) <= 1)
+                s.score += w.my_river_near_goal;
+            s.score += (cell.orientation == "horizontal") ? w.my_river_horizontal : w.my_river_vertical;
+            s.score += near_my_stones * w.my_river_near_stone;
+
+            if (ctx.threats)
+                s.score += ctx.threats->paths_through(x, y) * w.river_on_opp_path;
+        }
+        else
+        {
+            s.score -= w.opp_river;
+            if (std::abs(y - ctx.opp_score_row) <= 2)
+                s.score -= w.opp_river_near_goal;
+            s.score += near_my_stones * w.opp_river_near_stone;
+        }
+    }
+    static double finish(const State &s, const EvalContext &) { return s.score; }
+};
+
+// Opponent stones with one of my pieces orthogonally adjacent.
+struct OppBlockedFeature : EvalFeature
+{
+    static constexpr const char *name = "opp_blocked";
+    static constexpr bool needs_threats = true;
+    static double finish(const State &, const EvalContext &ctx) { return ctx.threats->blocked * ctx.w.opp_blocked; }
+};
+
+struct AdvancementFeature : EvalFeature
+{
+    static constexpr const char *name = "advancement";
+    struct State
+    {
+        int diff = 0;
+    };
+    static void on_cell(State &s, const EvalContext &ctx, int, int y, const Cell &cell)
+    {
+        if (cell.side != "stone")
+            return;
+        if (cell.owner == ctx.player)
+            s.diff += ctx.rows - std::abs(y - ctx.my_score_row);
+        else
+            s.diff -= ctx.rows - std::abs(y - ctx.opp_score_row);
+    }
+    static double finish(const State &s, const EvalContext &ctx) { return s.diff * ctx.w.advancement; }
+};
+
+// Vertical river lanes towards the score row and horizontal river lanes
+// feeding the score columns, each cut off by the first opponent piece.
+struct ClearPathFeature : EvalFeature
+{
+    static constexpr const char *name = "clear_paths";
+    static double finish(const State &, const EvalContext &ctx)
+    {
+        const auto &board = ctx.board;
+        auto is_river = [&](int x, int y, const char *orientation)
+        {
+            const Cell &c = board[y][x];
+            return !c.isEmpty() && c.side == "river" && c.orientation == orientation;
+        };
+        auto is_opp = [&](int x, int y)
+        {
+            return board[y][x].owner == ctx.opponent;
+        };
+
+        int paths = 0;
+        int toward = (ctx.my_score_row == top_score_row()) ? 1 : -1;
+        for (int x = 0; x < ctx.cols; x++)
+        {
+            for (int y = ctx.my_score_row + toward; y != ctx.opp_score_row; y += toward)
+            {
+                if (is_river(x, y, "vertical"))
+                {
+                    paths++;
+                    break;
+                }
+                if (is_opp(x, y))
+                    break;
+            }
+            for (int y = ctx.my_score_row - toward; y >= 0 && y < ctx.rows; y -= toward)
+            {
+                if (is_river(x, y, "vertical"))
+                {
+                    paths++;
+                    break;
+                }
+                if (is_opp(x, y))
+                    break;
+            }
+        }
+
+        auto scan_lane = [&](int x_start, int step)
+        {
+            for (int x = x_start; x >= 0 && x < ctx.cols; x += step)
+            {
+                for (int y : {ctx.my_score_row, ctx.my_score_row + 1, ctx.my_score_row - 1})
+                {
+                    if (is_river(x, y, "horizontal"))
+                    {
+                        paths++;
+                        return;
+                    }
+                    if (is_opp(x, y))
+                        return;
+                }
+            }
+        };
+        scan_lane(*std::min_element(ctx.score_cols.begin(), ctx.score_cols.end()) - 1, -1);
+        scan_lane(*std::max_element(ctx.score_cols.begin(), ctx.score_cols.end()) + 1, 1);
+
+        return paths * ctx.w.clear_path;
+    }
+};
+
+// My pieces standing in a score column between the opponent's score row and
+// mine. Not part of any evaluator at the moment.
+struct BlockingPiecesFeature : EvalFeature
+{
+    static constexpr const char *name = "blocking_pieces";
+    static double finish(const State &, const EvalContext &ctx)
+    {
+        int direction = (ctx.player == "circle") ? 1 : -1;
+        int blocking = 0;
+        for (int x : ctx.score_cols)
+        {
+            for (int y = ctx.opp_score_row; y != ctx.my_score_row && y >= 0 && y < ctx.rows; y += direction)
+            {
+                if (ctx.board[y][x].owner == ctx.player)
+                {
+                    blocking++;
+                    break;
+                }
+            }
+        }
+        return blocking * 1e6;
+    }
+};
+
+// Flat bonus bands for stones close to goal, scaled by how many already
+// score. Not part of any evaluator at the moment.
+struct ProximityBandsFeature : EvalFeature
+{
+    static constexpr const char *name = "proximity_bands";
+    static constexpr bool needs_my_stones = true;
+    static double finish(const State &, const EvalContext &ctx)
+    {
+        double score = 0.0;
+        for (const auto &s : ctx.my_stones)
+        {
+            if (s.dist <= 2)
+                score += 2e6 + ctx.info.my_scoring * 5e5;
+            else if (s.dist <= 4)
+                score += 1e5 + ctx.info.my_scoring * 5e4;
+        }
+        return score;
+    }
+};
+
+// Moves a stone would save by flipping or rotating an own neighbour into a
+// river, per the pattern database: its distance with the flip against its
+// distance with the same neighbours left alone. Obstacles elsewhere on the
+// board lengthen both alike and earn nothing. A stone the plain BFS already
+// brings within the flipped distance gains at most the difference.
+struct RiverPotentialFeature : EvalFeature
+{
+    static constexpr const char *name = "river_potential";
+    static constexpr bool needs_my_stones = true;
+    static double finish(const State &, const EvalContext &ctx)
+    {
+        double score = 0.0;
+        for (const auto &s : ctx.my_stones)
+        {
+            int saving = pattern_flip_saving(ctx.board, s.x, s.y, ctx.player, ctx.rows, ctx.cols, ctx.score_cols);
+            if (saving == 0)
+                continue;
+            int pdb = pattern_distance(ctx.board, s.x, s.y, ctx.player, ctx.rows, ctx.cols, ctx.score_cols);
+            if (pdb < s.dist)
+                score += std::min<double>(saving, s.dist - pdb) * ctx.w.river_potential;
+        }
+        return score;
+    }
+};
+
+// Updated from every searching thread: agent pool workers and YBWC helpers
+// evaluate concurrently.
+struct FeatureStats
+{
+    std::atomic<long long> nanoseconds{0};
+    std::atomic<long long> calls{0};
+};
+
+template <typename... Features>
+struct Evaluator
+{
+    static constexpr size_t size = sizeof...(Features);
+    static constexpr std::array<const char *, size> names = {Features::name...};
+    static constexpr bool needs_my_stones = (false || ... || Features::needs_my_stones);
+    static constexpr bool needs_threats = (false || ... || Features::needs_threats);
+
+    // Accumulated only when EVAL_PROFILE is set; the last slot is the stone
+    // distances and threat map.
+    static inline std::array<FeatureStats, size + 1> stats{};
+
+    static double evaluate(EvalContext &ctx)
+    {
+        // Read the clock only when profiling: the call cannot be optimised out
+        std::chrono::steady_clock::time_point t0;
+        if constexpr (EVAL_PROFILE)
+            t0 = std::chrono::steady_clock::now();
+        if constexpr (needs_my_stones)
+            ctx.my_stones = collect_stone_distances(ctx, ctx.player);
+        if constexpr (needs_threats)
+            ctx.threats = analyse_threats(ctx.board, ctx.opponent, ctx.rows, ctx.cols, ctx.score_cols);
+        if constexpr (EVAL_PROFILE)
+        {
+            record(size, t0);
+            return run_profiled(ctx, std::index_sequence_for<Features...>{});
+        }
+        return run(ctx, std::index_sequence_for<Features...>{});
+    }
+
+    static void report(const std::string &label,
+                       std::vector<std::tuple<std::string, std::string, double, long long>> &out)
+    {
+        for (size_t i = 0; i <= size; i++)
+        {
+            out.emplace_back(label, i < size ? names[i] : "stone_bfs", stats[i].nanoseconds * 1e-9,
+                             stats[i].calls.load());
+        }
+    }
+
+private:
+    static void record(size_t index, std::chrono::steady_clock::time_point t0)
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0);
+        stats[index].nanoseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+        stats[index].calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <size_t... I>
+    static double run(const EvalContext &ctx, std::index_sequence<I...>)
+    {
+        std::tuple<typename Features::State...> states;
+        for (int y = 0; y < ctx.rows; y++)
+        {
+            for (int x = 0; x < ctx.cols; x++)
+            {
+                const Cell &cell = ctx.board[y][x];
+                if (cell.isEmpty())
+                    continue;
+                (Features::on_cell(std::get<I>(states), ctx, x, y, cell), ...);
+            }
+        }
+        return (0.0 + ... + Features::finish(std::get<I>(states), ctx));
+    }
+
+    // One pass per feature so each can be timed on its own.
+    template <size_t... I>
+    static double run_profiled(const EvalContext &ctx, std::index_sequence<I...>)
+    {
+        return (0.0 + ... + run_one<I, Features>(ctx));
+    }
+
+    template <size_t I, typename F>
+    static double run_one(const EvalContext &ctx)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        typename F::State state;
+        for (int y = 0; y < ctx.rows; y++)
+        {
+            for (int x = 0; x < ctx.cols; x++)
+            {
+                const Cell &cell = ctx.board[y][x];
+                if (!cell.isEmpty())
+                    F::on_cell(state, ctx, x, y, cell);
+            }
+        }
+        double score = F::finish(state, ctx);
+        record(I, t0);
+        return score;
+    }
+};
+
+using OpeningEvaluator = Evaluator<MyDistanceFeature, OppRowRaceFeature, RiverFeature,
+                                   AdvancementFeature, ClearPathFeature, RiverPotentialFeature>;
+using MidgameEvaluator = Evaluator<ScoringStonesFeature, MyDistanceFeature, OppThreatFeature, RiverFeature,
+                                   OppBlockedFeature, AdvancementFeature, ClearPathFeature, RiverPotentialFeature>;
+using EndgameEvaluator = Evaluator<ScoringStonesFeature, MyDistanceFeature, OppThreatFeature, OppBlockedFeature>;
+
+// Score of `board` for `player`: the evaluator of the detected phase, or
+// +-1e15 when a side has already won.
+double evaluate_board(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &player,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// (phase, feature, seconds, calls) for every evaluator feature. Only
+// non-zero in builds with EVAL_PROFILE.
+std::vector<std::tuple<std::string, std::string, double, long long>> eval_feature_stats();
+
+#endif // EVAL_H
@@ -0,0 +1,111 @@
+#include "flow.h"
+
+#include <deque>
+
+// The search behind get_river_flow_destinations on the board's cell sets.
+template <typename CellSetType>
+static std::vector<Position> flow_destinations(
+    CellSetType &visited,
+    const std::vector<std::vector<Cell>> &board,
+    int rx, int ry, int sx, int sy, const std::string &player,
+    int rows, int cols, const std::vector<int> &score_cols,
+    bool river_push)
+{
+    // Destinations in the order first reached, each once
+    CellSetType found;
+    std::vector<Position> destinations;
+    auto reach = [&](int x, int y)
+    {
+        if (found.insert(y * cols + x))
+            destinations.push_back(Position(x, y));
+    };
+    std::deque<Position> queue;
+    queue.push_back(Position(rx, ry));
+
+    while (!queue.empty())
+    {
+        Position pos = queue.front();
+        queue.pop_front();
+
+        if (!in_bounds(pos.x, pos.y, rows, cols) || !visited.insert(pos.y * cols + pos.x))
+            continue;
+
+        const Cell *cell = &board[pos.y][pos.x];
+        if (river_push && pos.x == rx && pos.y == ry)
+        {
+            cell = &board[sy][sx];
+        }
+
+        if (cell->isEmpty())
+        {
+            if (!is_opponent_score_cell(pos.x, pos.y, player, rows, cols, score_cols))
+            {
+                reach(pos.x, pos.y);
+            }
+            continue;
+        }
+
+        if (cell->side != "river")
+            continue;
+
+        std::vector<std::pair<int, int>> dirs;
+        if (cell->orientation == "horizontal")
+        {
+            dirs = {{1, 0}, {-1, 0}};
+        }
+        else
+        {
+            dirs = {{0, 1}, {0, -1}};
+        }
+
+        for (auto [dx, dy] : dirs)
+        {
+            int nx = pos.x + dx;
+            int ny = pos.y + dy;
+
+            while (in_bounds(nx, ny, rows, cols))
+            {
+                if (is_opponent_score_cell(nx, ny, player, rows, cols, score_cols))
+                {
+                    break;
+                }
+
+                const Cell &next_cell = board[ny][nx];
+
+                if (next_cell.isEmpty())
+                {
+                    reach(nx, ny);
+                    nx += dx;
+                    ny += dy;
+                    continue;
+                }
+
+                if (nx == sx && ny == sy)
+                {
+                    nx += dx;
+                    ny += dy;
+                    continue;
+                }
+
+                if (next_cell.side == "river")
+                {
+                    queue.push_back(Position(nx, ny));
+                    break;
+                }
+                break;
+            }
+        }
+    }
+    return destinations;
+}
+
+std::vector<Position> get_river_flow_destinations(
+    const std::vector<std::vector<Cell>> &board,
+    int rx, int ry, int sx, int sy, const std::string &player,
+    int rows, int cols, const std::vector<int> &score_cols,
+    bool river_push)
+{
+    return with_cell_set(rows, cols, [&](auto &visited)
+                         { return flow_destinations(visited, board, rx, ry, sx, sy, player, rows, cols, score_cols,
+                                                    river_push); });
+}
@@ -0,0 +1,24 @@
+// River flow: where a piece entering a river is carried to
+//
+// A river carries a piece along its orientation until the next occupied
+// cell, and into any further river it runs into. The destinations are the
+// empty cells passed on the way, except the opponent's score cells.
+
+#ifndef FLOW_H
+#define FLOW_H
+
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+// Cells a piece at (sx, sy) reaches by entering the river at (rx, ry). With
+// river_push the river cell is treated as holding the piece from (sx, sy),
+// for a river pushing the piece standing on it.
+std::vector<Position> get_river_flow_destinations(
+    const std::vector<std::vector<Cell>> &board,
+    int rx, int ry, int sx, int sy, const std::string &player,
+    int rows, int cols, const std::vector<int> &score_cols,
+    bool river_push = false);
+
+#endif // FLOW_H
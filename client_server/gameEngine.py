@@ -1,5 +1,6 @@
 import argparse, json, copy, time
 import queue
+import random
 from typing import List, Optional, Dict, Any, Tuple
 
 # Agent factory now expects only (side, strategy)
@@ -102,19 +103,80 @@ def save_board_to_file(board, path: str):
         json.dump(data, fh, indent=2)
 
 
-def board_to_hash(board: List[List[Optional[Piece]]]) -> str:
-    """Convert board state to a hashable string for stalemate detection."""
-    state = []
-    for row in board:
-        row_state = []
-        for cell in row:
-            if cell is None:
-                row_state.append("_")
-            else:
-                # Format: owner_side_orientation (e.g., "circle_stone_None" or "square_river_horizontal")
-                row_state.append(f"{cell.owner}_{cell.side}_{cell.orientation}")
-        state.append("|".join(row_state))
-    return "||".join(state)
+# ---------------- Stalemate detection ----------------
+# Every STALEMATE_INTERVAL moves the position is compared with the one at the
+# previous check; STALEMATE_REPEATS equal checks in a row are a draw. The
+# position is a 64-bit Zobrist hash updated from the cells each move touched,
+# computed natively when the C++ module is built.
+STALEMATE_INTERVAL = 4
+STALEMATE_REPEATS = 3
+
+try:
+    from build.student_agent_module import PositionTracker as _NativePositionTracker
+except ImportError:
+    _NativePositionTracker = None
+
+PIECE_CODES = {
+    ("circle", "stone", None): 1, ("circle", "river", "horizontal"): 2, ("circle", "river", "vertical"): 3,
+    ("square", "stone", None): 4, ("square", "river", "horizontal"): 5, ("square", "river", "vertical"): 6,
+}
+
+def piece_code(piece: Optional[Piece]) -> int:
+    """0 for an empty cell, 1-6 by owner, side and river orientation."""
+    if piece is None:
+        return 0
+    return PIECE_CODES[(piece.owner, piece.side, piece.orientation if piece.side == "river" else None)]
+
+def move_cells(move: Dict[str, Any]) -> List[Tuple[int, int]]:
+    """Cells an applied move may have changed."""
+    cells = []
+    for key in ("from", "to", "pushed_to"):
+        if move.get(key) and (key == "from" or move.get("action") in ("move", "push")):
+            cells.append((int(move[key][0]), int(move[key][1])))
+    return cells
+
+class PositionTracker:
+    """Incremental position hash with the engine's stalemate rule."""
+
+    def __init__(self, board: List[List[Optional[Piece]]],
+                 interval: int = STALEMATE_INTERVAL, repeats: int = STALEMATE_REPEATS):
+        rows, cols = len(board), len(board[0])
+        self.cols = cols
+        self.interval = interval
+        self.repeats = repeats
+        self.native = _NativePositionTracker(rows, cols, interval, repeats) if _NativePositionTracker else None
+        if self.native is None:
+            rng = random.Random(0x5EED)
+            self.zobrist = [[rng.getrandbits(64) for _ in range(7)] for _ in range(rows * cols)]
+            self.pieces = [0] * (rows * cols)
+            self.key = 0
+            self.moves = 0
+            self.checked_key = None
+            self.run = 0
+        for y in range(rows):
+            for x in range(cols):
+                self._set_cell(x, y, piece_code(board[y][x]))
+
+    def _set_cell(self, x: int, y: int, code: int):
+        if self.native is not None:
+            self.native.set_cell(x, y, code)
+            return
+        cell = y * self.cols + x
+        self.key ^= self.zobrist[cell][self.pieces[cell]] ^ self.zobrist[cell][code]
+        self.pieces[cell] = code
+
+    def move_applied(self, board: List[List[Optional[Piece]]], move: Dict[str, Any]) -> bool:
+        """Record a move already applied to `board`; True means stalemate."""
+        for x, y in move_cells(move):
+            self._set_cell(x, y, piece_code(board[y][x]))
+        if self.native is not None:
+            return self.native.move_applied()
+        self.moves += 1
+        if self.moves % self.interval:
+            return False
+        self.run = self.run + 1 if self.key == self.checked_key else 1
+        self.checked_key = self.key
+        return self.run >= self.repeats
 
 
 # ---------------- Score helpers ----------------
@@ -835,9 +897,8 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
 
     turn_start = time.time()
 
-    # Stalemate detection: track board states after every 4 moves (2 per player)
-    board_state_history = []
-    moves_since_last_check = 0
+    # Stalemate detection: position repeated at consecutive checks
+    position = PositionTracker(board)
 
     while True:
         clock.tick(FPS)
@@ -881,26 +942,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                     ok, info = validate_and_apply_move(board, move, current, rows, cols, score_cols)
                     msg = f"AI {current}: {info}"
                     if ok:
-                        moves_since_last_check += 1
+                        stalemate = position.move_applied(board, move)
                         w = check_win(board, rows, cols, score_cols)
                         if w: 
                             winner = w
                             msg = f"{w.title()} wins!"
                             game_over = True
 
-                        # Check for stalemate after every 4 moves (2 per player)
-                        if not game_over and moves_since_last_check >= 4:
-                            current_state = board_to_hash(board)
-                            board_state_history.append(current_state)
-                            moves_since_last_check = 0
-
-                            # Check if current state has appeared 3 times consecutively
-                            if len(board_state_history) >= 3:
-                                if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                    winner = None
-                                    game_over = True
-                                    msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                    print("Stalemate: Board state repeated 3 times consecutively.")
+                        # Check for stalemate every STALEMATE_INTERVAL moves
+                        if not game_over and stalemate:
+                            winner = None
+                            game_over = True
+                            msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                            print("Stalemate: Board state repeated 3 times consecutively.")
 
                         current = opponent(current)
                         selected = None
@@ -970,26 +1024,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                         ok, info = validate_and_apply_move(board, m, current, rows, cols, score_cols)
                         msg = info
                         if ok:
-                            moves_since_last_check += 1
+                            stalemate = position.move_applied(board, m)
                             w = check_win(board, rows, cols, score_cols)
                             if w:
                                 winner = w
                                 msg = f"{w.title()} wins!"
                                 game_over = True
 
-                            # Check for stalemate after every 4 moves (2 per player)
-                            if not game_over and moves_since_last_check >= 4:
-                                current_state = board_to_hash(board)
-                                board_state_history.append(current_state)
-                                moves_since_last_check = 0
-
-                                # Check if current state has appeared 3 times consecutively
-                                if len(board_state_history) >= 3:
-                                    if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                        winner = None
-                                        game_over = True
-                                        msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                        print("Stalemate: Board state repeated 3 times consecutively.")
+                            # Check for stalemate every STALEMATE_INTERVAL moves
+                            if not game_over and stalemate:
+                                winner = None
+                                game_over = True
+                                msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                                print("Stalemate: Board state repeated 3 times consecutively.")
 
                             current = opponent(current)
                             selected = None
@@ -1005,26 +1052,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                         ok, info = validate_and_apply_move(board, m, current, rows, cols, score_cols)
                         msg = info
                         if ok:
-                            moves_since_last_check += 1
+                            stalemate = position.move_applied(board, m)
                             w = check_win(board, rows, cols, score_cols)
                             if w:
                                 winner = w
                                 msg = f"{w.title()} wins!"
                                 game_over = True
 
-                            # Check for stalemate after every 4 moves (2 per player)
-                            if not game_over and moves_since_last_check >= 4:
-                                current_state = board_to_hash(board)
-                                board_state_history.append(current_state)
-                                moves_since_last_check = 0
-
-                                # Check if current state has appeared 3 times consecutively
-                                if len(board_state_history) >= 3:
-                                    if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                        winner = None
-                                        game_over = True
-                                        msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                        print("Stalemate: Board state repeated 3 times consecutively.")
+                            # Check for stalemate every STALEMATE_INTERVAL moves
+                            if not game_over and stalemate:
+                                winner = None
+                                game_over = True
+                                msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                                print("Stalemate: Board state repeated 3 times consecutively.")
 
                             current = opponent(current)
                             selected = None
@@ -1035,26 +1075,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                         ok, info = validate_and_apply_move(board, m, current, rows, cols, score_cols)
                         msg = info
                         if ok:
-                            moves_since_last_check += 1
+                            stalemate = position.move_applied(board, m)
                             w = check_win(board, rows, cols, score_cols)
                             if w:
                                 winner = w
                                 msg = f"{w.title()} wins!"
                                 game_over = True
 
-                            # Check for stalemate after every 4 moves (2 per player)
-                            if not game_over and moves_since_last_check >= 4:
-                                current_state = board_to_hash(board)
-                                board_state_history.append(current_state)
-                                moves_since_last_check = 0
-
-                                # Check if current state has appeared 3 times consecutively
-                                if len(board_state_history) >= 3:
-                                    if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                        winner = None
-                                        game_over = True
-                                        msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                        print("Stalemate: Board state repeated 3 times consecutively.")
+                            # Check for stalemate every STALEMATE_INTERVAL moves
+                            if not game_over and stalemate:
+                                winner = None
+                                game_over = True
+                                msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                                print("Stalemate: Board state repeated 3 times consecutively.")
 
                             current = opponent(current)
                             selected = None
@@ -1105,26 +1138,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                             ok, info = validate_and_apply_move(board, m, current, rows, cols, score_cols)
                             msg = info
                             if ok:
-                                moves_since_last_check += 1
+                                stalemate = position.move_applied(board, m)
                                 w = check_win(board, rows, cols, score_cols)
                                 if w:
                                     winner = w
                                     msg = f"{w.title()} wins!"
                                     game_over = True
 
-                                # Check for stalemate after every 4 moves (2 per player)
-                                if not game_over and moves_since_last_check >= 4:
-                                    current_state = board_to_hash(board)
-                                    board_state_history.append(current_state)
-                                    moves_since_last_check = 0
-
-                                    # Check if current state has appeared 3 times consecutively
-                                    if len(board_state_history) >= 3:
-                                        if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                            winner = None
-                                            game_over = True
-                                            msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                            print("Stalemate: Board state repeated 3 times consecutively.")
+                                # Check for stalemate every STALEMATE_INTERVAL moves
+                                if not game_over and stalemate:
+                                    winner = None
+                                    game_over = True
+                                    msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                                    print("Stalemate: Board state repeated 3 times consecutively.")
 
                                 current = opponent(current)
                                 selected = None
@@ -1169,26 +1195,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                                     highlights = set()
                                     action_mode = None
                                     if ok:
-                                        moves_since_last_check += 1
+                                        stalemate = position.move_applied(board, m)
                                         w = check_win(board, rows, cols, score_cols)
                                         if w:
                                             winner = w
                                             msg = f"{w.title()} wins!"
                                             game_over = True
 
-                                        # Check for stalemate after every 4 moves (2 per player)
-                                        if not game_over and moves_since_last_check >= 4:
-                                            current_state = board_to_hash(board)
-                                            board_state_history.append(current_state)
-                                            moves_since_last_check = 0
-
-                                            # Check if current state has appeared 3 times consecutively
-                                            if len(board_state_history) >= 3:
-                                                if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                                    winner = None
-                                                    game_over = True
-                                                    msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                                    print("Stalemate: Board state repeated 3 times consecutively.")
+                                        # Check for stalemate every STALEMATE_INTERVAL moves
+                                        if not game_over and stalemate:
+                                            winner = None
+                                            game_over = True
+                                            msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                                            print("Stalemate: Board state repeated 3 times consecutively.")
 
                                         current = opponent(current)
                                         selected = None
@@ -1201,26 +1220,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                             ok, info = validate_and_apply_move(board, m, current, rows, cols, score_cols)
                             msg = info
                             if ok:
-                                moves_since_last_check += 1
+                                stalemate = position.move_applied(board, m)
                                 w = check_win(board, rows, cols, score_cols)
                                 if w:
                                     winner = w
                                     msg = f"{w.title()} wins!"
                                     game_over = True
 
-                                # Check for stalemate after every 4 moves (2 per player)
-                                if not game_over and moves_since_last_check >= 4:
-                                    current_state = board_to_hash(board)
-                                    board_state_history.append(current_state)
-                                    moves_since_last_check = 0
-
-                                    # Check if current state has appeared 3 times consecutively
-                                    if len(board_state_history) >= 3:
-                                        if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                            winner = None
-                                            game_over = True
-                                            msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                            print("Stalemate: Board state repeated 3 times consecutively.")
+                                # Check for stalemate every STALEMATE_INTERVAL moves
+                                if not game_over and stalemate:
+                                    winner = None
+                                    game_over = True
+                                    msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                                    print("Stalemate: Board state repeated 3 times consecutively.")
 
                                 current = opponent(current)
                                 selected = None
@@ -1241,26 +1253,19 @@ def run_gui(mode: str, circle_strategy: str, square_strategy: str, load_file: Op
                             ok, info = validate_and_apply_move(board, m, current, rows, cols, score_cols)
                             msg = info
                             if ok:
-                                moves_since_last_check += 1
+                                stalemate = position.move_applied(board, m)
                                 w = check_win(board, rows, cols, score_cols)
                                 if w:
                                     winner = w
                                     msg = f"{w.title()} wins!"
                                     game_over = True
 
-                                # Check for stalemate after every 4 moves (2 per player)
-                                if not game_over and moves_since_last_check >= 4:
-                                    current_state = board_to_hash(board)
-                                    board_state_history.append(current_state)
-                                    moves_since_last_check = 0
-
-                                    # Check if current state has appeared 3 times consecutively
-                                    if len(board_state_history) >= 3:
-                                        if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                                            winner = None
-                                            game_over = True
-                                            msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
-                                            print("Stalemate: Board state repeated 3 times consecutively.")
+                                # Check for stalemate every STALEMATE_INTERVAL moves
+                                if not game_over and stalemate:
+                                    winner = None
+                                    game_over = True
+                                    msg = "Stalemate detected (board repeated 3 times). Game ends in a draw!"
+                                    print("Stalemate: Board state repeated 3 times consecutively.")
 
                                 current = opponent(current)
                                 selected = None
@@ -1318,9 +1323,8 @@ def run_cli(mode:str, circle_strategy:str, square_strategy:str, load_file:Option
     # Timers (seconds) - ADDED
     timers = {"circle": time_per_player, "square": time_per_player}  # ADDED
     
-    # Stalemate detection: track board states after every 4 moves (2 per player)
-    board_state_history = []
-    moves_since_last_check = 0
+    # Stalemate detection: position repeated at consecutive checks
+    position = PositionTracker(board)
 
     while True:
         print(board_to_ascii(board, rows, cols, score_cols))
@@ -1374,7 +1378,7 @@ def run_cli(mode:str, circle_strategy:str, square_strategy:str, load_file:Option
                 print(f"{current.title()} made invalid move. {winner.title()} wins!")
                 break
             else:
-                moves_since_last_check += 1
+                stalemate = position.move_applied(board, move)
         else:
             # Human: measure time spent entering the move so the timer decreases
             print("Commands:")
@@ -1412,7 +1416,7 @@ def run_cli(mode:str, circle_strategy:str, square_strategy:str, load_file:Option
             if not ok:
                 continue
             else:
-                moves_since_last_check += 1
+                stalemate = position.move_applied(board, move)
             
         # after a successful move / AI move attempt, check board win
         w = check_win(board, rows, cols, score_cols)
@@ -1421,19 +1425,12 @@ def run_cli(mode:str, circle_strategy:str, square_strategy:str, load_file:Option
             print(f"\n🎉 WINNER: {w.upper()} 🎉")
             break
         
-        # Check for stalemate after every 4 moves (2 per player)
-        if moves_since_last_check >= 4:
-            current_state = board_to_hash(board)
-            board_state_history.append(current_state)
-            moves_since_last_check = 0
-            
-            # Check if current state has appeared 3 times consecutively
-            if len(board_state_history) >= 3:
-                if (board_state_history[-1] == board_state_history[-2] == board_state_history[-3]):
-                    winner = None
-                    print("\n⚠️  STALEMATE: Board state repeated 3 times consecutively.")
-                    print("Game ends in a draw!")
-                    break
+        # Check for stalemate every STALEMATE_INTERVAL moves
+        if stalemate:
+            winner = None
+            print("\n⚠️  STALEMATE: Board state repeated 3 times consecutively.")
+            print("Game ends in a draw!")
+            break
 
         # next player's turn
         current = opponent(current)
@@ -0,0 +1,713 @@
+// Streaming reader for zipped game-log archives
+//
+// web_server.py saves every game as a pretty-printed GameLogger JSON file
+// (metadata, one encoded board per move, and the moves themselves) and the
+// logs are shipped as game_logs.zip. This reader walks the archive's
+// central directory over an mmap-ed file, inflates each member with zlib,
+// parses the JSON in place and hands out one GameRecord per game.
+//
+// Members are decoded by a pool of worker threads. Finished records wait in
+// a queue of bounded capacity, so memory stays at a few games per worker
+// however large the archive is; records come out in completion order.
+
+#ifndef GAME_LOG_READER_H
+#define GAME_LOG_READER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// zconf.h defines FAR (empty) for old 16-bit compilers. Nothing here uses it,
+// and it would turn ordinary identifiers in including files into syntax errors.
+#ifdef FAR
+#undef FAR
+#endif
+
+namespace GameLogs
+{
+    struct LoggedMove
+    {
+        std::string player;
+        std::string action;
+        int from_x = -1, from_y = -1;
+        int to_x = -1, to_y = -1;         // move and push
+        int pushed_x = -1, pushed_y = -1; // push
+        std::string orientation;          // flip to river
+        double timestamp = 0.0;
+        std::string state;                // board after the move, GameLogger encoding
+        std::vector<uint8_t> position;    // the same board as piece codes, 0 empty, 1-6
+    };
+
+    struct GameRecord
+    {
+        std::string name; // archive member
+        std::string error; // set when the member could not be read; nothing else is then
+        int rows = 0, cols = 0;
+        std::string winner; // empty for a draw
+        double circle_score = 0.0, square_score = 0.0;
+        double duration = 0.0;
+        std::vector<LoggedMove> moves;
+    };
+
+    // GameLogger characters to piece codes: circle stone / horizontal /
+    // vertical river = 1-3, square = 4-6 (piece_code() in student_agent.cpp).
+    inline int piece_from_char(char c)
+    {
+        switch (c)
+        {
+        case 'A': return 1;
+        case 'B': return 2;
+        case 'C': return 3;
+        case 'a': return 4;
+        case 'b': return 5;
+        case 'c': return 6;
+        default: return 0;
+        }
+    }
+
+    // ==================== JSON ====================
+    //
+    // Just enough JSON for GameLogger files. Strings are views into the
+    // buffer being parsed; escapes are decoded in place, which only ever
+    // shortens a string.
+
+    struct JsonValue
+    {
+        enum Type : uint8_t
+        {
+            NUL,
+            BOOL,
+            NUMBER,
+            STRING,
+            ARRAY,
+            OBJECT
+        };
+        Type type = NUL;
+        bool boolean = false;
+        double number = 0.0;
+        std::string_view string;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string_view, JsonValue>> members;
+
+        const JsonValue *get(std::string_view key) const
+        {
+            for (const auto &m : members)
+            {
+                if (m.first == key)
+                    return &m.second;
+            }
+            return nullptr;
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(char *begin, char *end) : begin_(begin), p_(begin), end_(end) {}
+
+        // False on malformed input; error() says where.
+        bool parse(JsonValue &out)
+        {
+            if (!value(out, 0))
+                return false;
+            skip_space();
+            if (p_ != end_)
+                return fail("trailing characters");
+            return true;
+        }
+
+        const std::string &error() const { return error_; }
+
+    private:
+        static constexpr int MAX_DEPTH = 64;
+
+        bool fail(const char *what)
+        {
+            if (error_.empty())
+                error_ = std::string(what) + " at byte " + std::to_string(p_ - begin_);
+            return false;
+        }
+
+        void skip_space()
+        {
+            while (p_ != end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t'))
+                p_++;
+        }
+
+        bool literal(const char *word)
+        {
+            size_t n = std::strlen(word);
+            if (static_cast<size_t>(end_ - p_) < n || std::memcmp(p_, word, n) != 0)
+                return fail("bad literal");
+            p_ += n;
+            return true;
+        }
+
+        static int hex(char c)
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        bool string(std::string_view &out)
+        {
+            p_++; // opening quote
+            char *start = p_, *write = p_;
+            while (p_ != end_ && *p_ != '"')
+            {
+                if (*p_ != '\\')
+                {
+                    *write++ = *p_++;
+                    continue;
+                }
+                if (++p_ == end_)
+                    break;
+                char c = *p_++;
+                switch (c)
+                {
+                case 'n': *write++ = '\n'; break;
+                case 't': *write++ = '\t'; break;
+                case 'r': *write++ = '\r'; break;
+                case 'b': *write++ = '\b'; break;
+                case 'f': *write++ = '\f'; break;
+                case 'u':
+                {
+                    unsigned code = 0;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        int h = p_ != end_ ? hex(*p_++) : -1;
+                        if (h < 0)
+                            return fail("bad \\u escape");
+                        code = code * 16 + h;
+                    }
+                    // UTF-8, BMP only (surrogate pairs are not produced by GameLogger);
+                    // at most 3 bytes for the 6 consumed, so the write never overtakes
+                    if (code < 0x80)
+                        *write++ = static_cast<char>(code);
+                    else if (code < 0x800)
+                    {
+                        *write++ = static_cast<char>(0xC0 | (code >> 6));
+                        *write++ = static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    else
+                    {
+                        *write++ = static_cast<char>(0xE0 | (code >> 12));
+                        *write++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        *write++ = static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: *write++ = c; break; // \" \\ \/
+                }
+            }
+            if (p_ == end_)
+                return fail("unterminated string");
+            p_++; // closing quote
+            out = std::string_view(start, write - start);
+            return true;
+        }
+
+        bool value(JsonValue &out, int depth)
+        {
+            if (depth > MAX_DEPTH)
+                return fail("nesting too deep");
+            skip_space();
+            if (p_ == end_)
+                return fail("unexpected end");
+            switch (*p_)
+            {
+            case '{':
+            {
+                out.type = JsonValue::OBJECT;
+                p_++;
+                skip_space();
+                if (p_ != end_ && *p_ == '}')
+                {
+                    p_++;
+                    return true;
+                }
+                while (true)
+                {
+                    skip_space();
+                    if (p_ == end_ || *p_ != '"')
+                        return fail("expected key");
+                    std::string_view key;
+                    if (!string(key))
+                        return false;
+                    skip_space();
+                    if (p_ == end_ || *p_ != ':')
+                        return fail("expected ':'");
+                    p_++;
+                    out.members.emplace_back(key, JsonValue());
+                    if (!value(out.members.back().second, depth + 1))
+                        return false;
+                    skip_space();
+                    if (p_ != end_ && *p_ == ',')
+                    {
+                        p_++;
+                        continue;
+                    }
+                    if (p_ != end_ && *p_ == '}')
+                    {
+                        p_++;
+                        return true;
+                    }
+                    return fail("expected ',' or '}'");
+                }
+            }
+            case '[':
+            {
+                out.type = JsonValue::ARRAY;
+                p_++;
+                skip_space();
+                if (p_ != end_ && *p_ == ']')
+                {
+                    p_++;
+                    return true;
+                }
+                while (true)
+                {
+                    out.items.emplace_back();
+                    if (!value(out.items.back(), depth + 1))
+                        return false;
+                    skip_space();
+                    if (p_ != end_ && *p_ == ',')
+                    {
+                        p_++;
+                        continue;
+                    }
+                    if (p_ != end_ && *p_ == ']')
+                    {
+                        p_++;
+                        return true;
+                    }
+                    return fail("expected ',' or ']'");
+                }
+            }
+            case '"':
+                out.type = JsonValue::STRING;
+                return string(out.string);
+            case 't':
+                out.type = JsonValue::BOOL;
+                out.boolean = true;
+                return literal("true");
+            case 'f':
+                out.type = JsonValue::BOOL;
+                return literal("false");
+            case 'n':
+                out.type = JsonValue::NUL;
+                return literal("null");
+            default:
+            {
+                // strtod stops at the first character that is not part of a
+                // number; the closing bracket or brace after it keeps it in bounds
+                char *after = nullptr;
+                out.type = JsonValue::NUMBER;
+                out.number = std::strtod(p_, &after);
+                if (after == p_ || after > end_)
+                    return fail("bad value");
+                p_ = after;
+                return true;
+            }
+            }
+        }
+
+        char *begin_;
+        char *p_;
+        char *end_;
+        std::string error_;
+    };
+
+    // ==================== GAMELOGGER RECORDS ====================
+
+    inline std::string text(const JsonValue *v)
+    {
+        return v && v->type == JsonValue::STRING ? std::string(v->string) : std::string();
+    }
+
+    inline double number(const JsonValue *v, double fallback = 0.0)
+    {
+        return v && v->type == JsonValue::NUMBER ? v->number : fallback;
+    }
+
+    inline void read_pos(const JsonValue *v, int &x, int &y)
+    {
+        if (v && v->type == JsonValue::ARRAY && v->items.size() == 2)
+        {
+            x = static_cast<int>(number(&v->items[0], -1));
+            y = static_cast<int>(number(&v->items[1], -1));
+        }
+    }
+
+    // Parses one GameLogger file held in `buffer` (modified in place).
+    // Returns false with record.error set if it is not a game log.
+    inline bool parse_game(std::string &buffer, GameRecord &record)
+    {
+        JsonValue root;
+        JsonParser parser(buffer.data(), buffer.data() + buffer.size());
+        if (!parser.parse(root))
+        {
+            record.error = "JSON: " + parser.error();
+            return false;
+        }
+        const JsonValue *meta = root.get("metadata");
+        const JsonValue *states = root.get("states");
+        const JsonValue *moves = root.get("moves");
+        if (!meta || !states || !moves || states->type != JsonValue::ARRAY || moves->type != JsonValue::ARRAY)
+        {
+            record.error = "not a GameLogger file";
+            return false;
+        }
+
+        record.rows = static_cast<int>(number(meta->get("rows")));
+        record.cols = static_cast<int>(number(meta->get("cols")));
+        record.winner = text(meta->get("winner"));
+        record.duration = number(meta->get("game_duration"));
+        if (const JsonValue *scores = meta->get("final_scores"))
+        {
+            record.circle_score = number(scores->get("circle"));
+            record.square_score = number(scores->get("square"));
+        }
+
+        size_t cells = static_cast<size_t>(record.rows) * record.cols;
+        record.moves.reserve(moves->items.size());
+        for (const JsonValue &entry : moves->items)
+        {
+            LoggedMove m;
+            m.player = text(entry.get("player"));
+            m.timestamp = number(entry.get("timestamp"));
+            if (const JsonValue *move = entry.get("move"))
+            {
+                m.action = text(move->get("action"));
+                read_pos(move->get("from"), m.from_x, m.from_y);
+                if (m.action == "move" || m.action == "push")
+                    read_pos(move->get("to"), m.to_x, m.to_y);
+                if (m.action == "push")
+                    read_pos(move->get("pushed_to"), m.pushed_x, m.pushed_y);
+                if (m.action == "flip")
+                    m.orientation = text(move->get("orientation"));
+            }
+            double index = number(entry.get("state_index"), -1);
+            if (index >= 0 && index < static_cast<double>(states->items.size()))
+            {
+                m.state = text(&states->items[static_cast<size_t>(index)]);
+                if (m.state.size() == cells)
+                {
+                    m.position.resize(cells);
+                    for (size_t i = 0; i < cells; i++)
+                        m.position[i] = static_cast<uint8_t>(piece_from_char(m.state[i]));
+                }
+            }
+            record.moves.push_back(std::move(m));
+        }
+        return true;
+    }
+
+    // ==================== ZIP ARCHIVE ====================
+
+    // Read-only view of a zip file: the central directory plus a mapping of
+    // the whole file. Stored and deflated members are supported, zip64 is not.
+    class ZipArchive
+    {
+    public:
+        struct Entry
+        {
+            std::string name;
+            uint16_t method = 0;
+            uint32_t compressed_size = 0;
+            uint32_t size = 0;
+            uint32_t local_offset = 0;
+        };
+
+        ZipArchive() = default;
+        ZipArchive(const ZipArchive &) = delete;
+        ZipArchive &operator=(const ZipArchive &) = delete;
+
+        ~ZipArchive()
+        {
+            if (data_)
+                munmap(const_cast<uint8_t *>(data_), size_);
+        }
+
+        // False with error() set if the file cannot be mapped or is not a zip.
+        bool open(const std::string &path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return fail("cannot open " + path);
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size < 22)
+            {
+                ::close(fd);
+                return fail(path + " is too small to be a zip file");
+            }
+            size_ = static_cast<size_t>(st.st_size);
+            void *map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (map == MAP_FAILED)
+                return fail("cannot map " + path);
+            data_ = static_cast<const uint8_t *>(map);
+            return read_directory();
+        }
+
+        const std::vector<Entry> &entries() const { return entries_; }
+        const std::string &error() const { return error_; }
+
+        // Uncompressed contents of `entry`; false with `error` set on failure.
+        bool read(const Entry &entry, std::string &out, std::string &error) const
+        {
+            size_t local = entry.local_offset;
+            if (local + 30 > size_ || u32(local) != 0x04034b50)
+            {
+                error = "bad local header";
+                return false;
+            }
+            size_t start = local + 30 + u16(local + 26) + u16(local + 28);
+            if (start + entry.compressed_size > size_)
+            {
+                error = "member runs past the end of the archive";
+                return false;
+            }
+            const uint8_t *src = data_ + start;
+            out.resize(entry.size);
+            if (entry.method == 0)
+            {
+                if (entry.compressed_size != entry.size)
+                {
+                    error = "stored member size mismatch";
+                    return false;
+                }
+                std::memcpy(out.data(), src, entry.size);
+                return true;
+            }
+            if (entry.method != 8)
+            {
+                error = "unsupported compression method " + std::to_string(entry.method);
+                return false;
+            }
+
+            z_stream zs{};
+            if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+            {
+                error = "inflateInit2 failed";
+                return false;
+            }
+            zs.next_in = const_cast<Bytef *>(src);
+            zs.avail_in = entry.compressed_size;
+            zs.next_out = reinterpret_cast<Bytef *>(out.data());
+            zs.avail_out = entry.size;
+            int rc = inflate(&zs, Z_FINISH);
+            inflateEnd(&zs);
+            if (rc != Z_STREAM_END || zs.total_out != entry.size)
+            {
+                error = "inflate failed";
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        bool fail(std::string what)
+        {
+            error_ = std::move(what);
+            return false;
+        }
+
+        uint16_t u16(size_t at) const { return static_cast<uint16_t>(data_[at] | data_[at + 1] << 8); }
+        uint32_t u32(size_t at) const { return static_cast<uint32_t>(u16(at)) | static_cast<uint32_t>(u16(at + 2)) << 16; }
+
+        bool read_directory()
+        {
+            // The end-of-central-directory record is in the last 64 KiB + 22
+            // bytes (it may be followed by a comment).
+            size_t lowest = size_ > 65557 ? size_ - 65557 : 0;
+            size_t eocd = size_ - 22;
+            while (u32(eocd) != 0x06054b50)
+            {
+                if (eocd == lowest)
+                    return fail("no end of central directory record");
+                eocd--;
+            }
+            uint16_t count = u16(eocd + 10);
+            size_t at = u32(eocd + 16);
+            if (count == 0xFFFF || at == 0xFFFFFFFF)
+                return fail("zip64 archives are not supported");
+
+            entries_.reserve(count);
+            for (uint16_t i = 0; i < count; i++)
+            {
+                if (at + 46 > size_ || u32(at) != 0x02014b50)
+                    return fail("bad central directory entry " + std::to_string(i));
+                Entry e;
+                e.method = u16(at + 10);
+                e.compressed_size = u32(at + 20);
+                e.size = u32(at + 24);
+                uint16_t name_len = u16(at + 28);
+                uint16_t extra_len = u16(at + 30);
+                uint16_t comment_len = u16(at + 32);
+                e.local_offset = u32(at + 42);
+                if (at + 46 + name_len > size_)
+                    return fail("bad central directory entry " + std::to_string(i));
+                e.name.assign(reinterpret_cast<const char *>(data_ + at + 46), name_len);
+                at += 46 + name_len + extra_len + comment_len;
+                if (!e.name.empty() && e.name.back() != '/')
+                    entries_.push_back(std::move(e));
+            }
+            return true;
+        }
+
+        const uint8_t *data_ = nullptr;
+        size_t size_ = 0;
+        std::vector<Entry> entries_;
+        std::string error_;
+    };
+
+    // ==================== READER ====================
+
+    // Decodes the .json members of an archive on `threads` workers (0 = one
+    // per core) and hands the records out through next(). At most
+    // `capacity` finished records are held at once (0 = twice the workers).
+    class Reader
+    {
+    public:
+        Reader(const std::string &path, int threads = 0, size_t capacity = 0)
+        {
+            if (!archive_.open(path))
+            {
+                error_ = archive_.error();
+                return;
+            }
+            for (const auto &entry : archive_.entries())
+            {
+                const std::string &name = entry.name;
+                if (name.size() >= 5 && name.compare(name.size() - 5, 5, ".json") == 0)
+                    members_.push_back(&entry);
+            }
+            if (threads <= 0)
+                threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            threads = std::max(1, std::min<int>(threads, static_cast<int>(members_.size())));
+            capacity_ = capacity ? capacity : 2 * static_cast<size_t>(threads);
+            for (int i = 0; i < threads && !members_.empty(); i++)
+                workers_.emplace_back([this]
+                                      { work(); });
+        }
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        ~Reader()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            space_.notify_all();
+            for (auto &worker : workers_)
+                worker.join();
+        }
+
+        // Empty unless the archive itself could not be opened.
+        const std::string &error() const { return error_; }
+        size_t size() const { return members_.size(); }
+
+        // Next finished record; false once every member has been handed out.
+        bool next(GameRecord &out)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this]
+                        { return !done_.empty() || delivered_ == members_.size(); });
+            if (done_.empty())
+                return false;
+            out = std::move(done_.front());
+            done_.pop_front();
+            delivered_++;
+            lock.unlock();
+            space_.notify_one();
+            return true;
+        }
+
+    private:
+        void work()
+        {
+            std::string buffer;
+            while (true)
+            {
+                size_t index = next_member_++;
+                if (index >= members_.size())
+                    return;
+                const ZipArchive::Entry &entry = *members_[index];
+
+                GameRecord record;
+                record.name = entry.name;
+                if (archive_.read(entry, buffer, record.error))
+                    parse_game(buffer, record);
+                if (!record.error.empty())
+                    record.moves.clear();
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_.wait(lock, [this]
+                            { return stopping_ || done_.size() < capacity_; });
+                if (stopping_)
+                    return;
+                done_.push_back(std::move(record));
+                lock.unlock();
+                ready_.notify_one();
+            }
+        }
+
+        ZipArchive archive_;
+        std::vector<const ZipArchive::Entry *> members_;
+        std::string error_;
+        size_t capacity_ = 0;
+        std::atomic<size_t> next_member_{0};
+
+        std::mutex mutex_;
+        std::condition_variable ready_, space_;
+        std::deque<GameRecord> done_;
+        size_t delivered_ = 0;
+        bool stopping_ = false;
+        std::vector<std::thread> workers_;
+    };
+
+    // Calls `fn` once per game, from the calling thread. Returns false with
+    // `error` set if the archive could not be opened.
+    inline bool for_each_game(const std::string &path, const std::function<void(const GameRecord &)> &fn,
+                              int threads = 0, std::string *error = nullptr)
+    {
+        Reader reader(path, threads);
+        if (!reader.error().empty())
+        {
+            if (error)
+                *error = reader.error();
+            return false;
+        }
+        GameRecord record;
+        while (reader.next(record))
+            fn(record);
+        return true;
+    }
+}
+
+#endif
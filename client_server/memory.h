@@ -0,0 +1,101 @@
+// Memory budget for the engine's tables
+//
+// One byte budget per agent. The fixed tables come off the top: the
+// pattern database, the search scratch of each searching thread and the
+// mapped endgame tables. The tables that can grow share what is left, in
+// the proportions a MemoryPolicy gives: the transposition table (only there
+// for the MTD(f) driver) and the agent's threat cache on each thread it
+// searches on. A table that is not in use passes its share on. Budgets of
+// different agents in one process are independent.
+//
+// StudentAgent::set_memory_budget() applies a plan between games and
+// memory_report() lists every table's size, occupancy and hit rate.
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CacheStats
+{
+    std::string name;
+    size_t bytes = 0;        // in use
+    size_t budget_bytes = 0; // allowed; the size itself for a fixed table
+    size_t entries = 0;
+    size_t capacity = 0; // entries it can hold; 0 when only bytes are capped
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    double occupancy() const
+    {
+        if (capacity)
+            return static_cast<double>(entries) / capacity;
+        return budget_bytes ? static_cast<double>(bytes) / budget_bytes : 0.0;
+    }
+
+    double hit_rate() const
+    {
+        return probes ? static_cast<double>(hits) / probes : 0.0;
+    }
+};
+
+// Relative shares of the budget left after the fixed tables.
+struct MemoryPolicy
+{
+    double transpositions = 3.0;
+    double threats = 1.0;
+};
+
+// Floors for a budget too small for the fixed tables and a working cache.
+constexpr size_t MIN_TRANSPOSITION_BYTES = size_t(1) << 16;
+constexpr size_t MIN_THREAT_CACHE_BYTES = size_t(1) << 20;
+
+struct MemoryPlan
+{
+    size_t fixed_bytes = 0;
+    size_t transposition_bytes = 0;     // 0 when there is no table
+    size_t threat_bytes_per_thread = 0;
+};
+
+inline MemoryPlan plan_memory(size_t budget, const MemoryPolicy &policy, size_t fixed_bytes,
+                              bool transpositions, int threads)
+{
+    MemoryPlan plan;
+    plan.fixed_bytes = fixed_bytes;
+    double left = budget > fixed_bytes ? static_cast<double>(budget - fixed_bytes) : 0.0;
+    double tt_share = transpositions ? std::max(0.0, policy.transpositions) : 0.0;
+    double threat_share = std::max(0.0, policy.threats);
+    double shares = tt_share + threat_share;
+    if (shares <= 0.0)
+    {
+        // No preference: split evenly between the tables in use
+        tt_share = transpositions ? 1.0 : 0.0;
+        threat_share = 1.0;
+        shares = tt_share + threat_share;
+    }
+    if (transpositions)
+        plan.transposition_bytes = std::max(MIN_TRANSPOSITION_BYTES, static_cast<size_t>(left * tt_share / shares));
+    plan.threat_bytes_per_thread = std::max(
+        MIN_THREAT_CACHE_BYTES, static_cast<size_t>(left * threat_share / shares) / std::max(1, threads));
+    return plan;
+}
+
+struct MemoryReport
+{
+    size_t budget = 0; // 0: no budget set, every table at its default size
+    std::vector<CacheStats> tables;
+
+    size_t total_bytes() const
+    {
+        size_t total = 0;
+        for (const auto &t : tables)
+            total += t.bytes;
+        return total;
+    }
+};
+
+#endif // MEMORY_H
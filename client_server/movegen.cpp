@@ -0,0 +1,273 @@
+#include "movegen.h"
+
+#include <tuple>
+#include <utility>
+
+#include "distance.h"
+#include "flow.h"
+
+std::vector<std::unordered_map<std::string, std::string>> generate_all_valid_moves(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &current_player,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    std::vector<std::unordered_map<std::string, std::string>> moves;
+
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &p = board[y][x];
+            if (!p.isEmpty() && p.owner == current_player)
+            {
+                // Compute valid targets (moves and pushes)
+                std::vector<Position> move_targets;
+                std::vector<std::tuple<Position, Position>> push_targets;
+
+                std::vector<std::pair<int, int>> dirs = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+                for (auto [dx, dy] : dirs)
+                {
+                    int tx = x + dx;
+                    int ty = y + dy;
+
+                    if (!in_bounds(tx, ty, rows, cols))
+                        continue;
+                    if (is_opponent_score_cell(tx, ty, current_player, rows, cols, score_cols))
+                        continue;
+
+                    const Cell &target = board[ty][tx];
+
+                    if (target.isEmpty())
+                    {
+                        move_targets.push_back(Position(tx, ty));
+                    }
+                    else if (target.side == "river")
+                    {
+                        auto flow = get_river_flow_destinations(board, tx, ty, x, y, current_player, rows, cols, score_cols);
+                        for (const auto &d : flow)
+                        {
+                            move_targets.push_back(d);
+                        }
+                    }
+                    else
+                    {
+                        if (p.side == "stone")
+                        {
+                            int px = tx + dx;
+                            int py = ty + dy;
+                            std::string pushed_player = target.owner;
+
+                            if (in_bounds(px, py, rows, cols) && board[py][px].isEmpty() &&
+                                !is_opponent_score_cell(px, py, p.owner, rows, cols, score_cols) &&
+                                !is_opponent_score_cell(px, py, pushed_player, rows, cols, score_cols))
+                            {
+                                push_targets.push_back({Position(tx, ty), Position(px, py)});
+                            }
+                        }
+                        else
+                        {
+                            std::string pushed_player = target.owner;
+                            auto flow = get_river_flow_destinations(board, tx, ty, x, y, pushed_player, rows, cols, score_cols, true);
+                            for (const auto &d : flow)
+                            {
+                                if (!is_opponent_score_cell(d.x, d.y, current_player, rows, cols, score_cols))
+                                {
+                                    push_targets.push_back({Position(tx, ty), d});
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // Add move actions
+                for (const auto &target : move_targets)
+                {
+                    std::unordered_map<std::string, std::string> move;
+                    move["action"] = "move";
+                    move["from_x"] = std::to_string(x);
+                    move["from_y"] = std::to_string(y);
+                    move["to_x"] = std::to_string(target.x);
+                    move["to_y"] = std::to_string(target.y);
+                    moves.push_back(move);
+                }
+
+                // Add push actions
+                for (const auto &[to_pos, pushed_pos] : push_targets)
+                {
+                    std::unordered_map<std::string, std::string> move;
+                    move["action"] = "push";
+                    move["from_x"] = std::to_string(x);
+                    move["from_y"] = std::to_string(y);
+                    move["to_x"] = std::to_string(to_pos.x);
+                    move["to_y"] = std::to_string(to_pos.y);
+                    move["pushed_x"] = std::to_string(pushed_pos.x);
+                    move["pushed_y"] = std::to_string(pushed_pos.y);
+                    moves.push_back(move);
+                }
+
+                // Add flip and rotate actions
+                if (p.side == "stone")
+                {
+                    std::unordered_map<std::string, std::string> flip_h, flip_v;
+                    flip_h["action"] = "flip";
+                    flip_h["from_x"] = std::to_string(x);
+                    flip_h["from_y"] = std::to_string(y);
+                    flip_h["orientation"] = "horizontal";
+                    moves.push_back(flip_h);
+
+                    flip_v["action"] = "flip";
+                    flip_v["from_x"] = std::to_string(x);
+                    flip_v["from_y"] = std::to_string(y);
+                    flip_v["orientation"] = "vertical";
+                    moves.push_back(flip_v);
+                }
+                else
+                {
+                    std::unordered_map<std::string, std::string> flip, rotate;
+                    flip["action"] = "flip";
+                    flip["from_x"] = std::to_string(x);
+                    flip["from_y"] = std::to_string(y);
+                    moves.push_back(flip);
+
+                    rotate["action"] = "rotate";
+                    rotate["from_x"] = std::to_string(x);
+                    rotate["from_y"] = std::to_string(y);
+                    moves.push_back(rotate);
+                }
+            }
+        }
+    }
+
+    return moves;
+}
+
+void make_move(
+    std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    MoveUndo &undo)
+{
+    undo.cells.clear();
+    auto save = [&](int x, int y)
+    { undo.cells.push_back({Position(x, y), board[y][x]}); };
+
+    std::string action = move.at("action");
+    int from_x = std::stoi(move.at("from_x"));
+    int from_y = std::stoi(move.at("from_y"));
+    save(from_x, from_y);
+
+    if (action == "move")
+    {
+        int to_x = std::stoi(move.at("to_x"));
+        int to_y = std::stoi(move.at("to_y"));
+        save(to_x, to_y);
+        board[to_y][to_x] = board[from_y][from_x];
+        board[from_y][from_x] = Cell();
+    }
+    else if (action == "push")
+    {
+        int to_x = std::stoi(move.at("to_x"));
+        int to_y = std::stoi(move.at("to_y"));
+        int pushed_x = std::stoi(move.at("pushed_x"));
+        int pushed_y = std::stoi(move.at("pushed_y"));
+        save(to_x, to_y);
+        save(pushed_x, pushed_y);
+
+        board[pushed_y][pushed_x] = board[to_y][to_x];
+        board[to_y][to_x] = board[from_y][from_x];
+        board[from_y][from_x] = Cell();
+
+        if (board[to_y][to_x].side == "river")
+        {
+            board[to_y][to_x].side = "stone";
+            board[to_y][to_x].orientation = "";
+            clear_bfs_cache();
+        }
+    }
+    else if (action == "flip")
+    {
+        if (board[from_y][from_x].side == "stone")
+        {
+            board[from_y][from_x].side = "river";
+            board[from_y][from_x].orientation = move.at("orientation");
+        }
+        else
+        {
+            board[from_y][from_x].side = "stone";
+            board[from_y][from_x].orientation = "";
+        }
+        clear_bfs_cache();
+    }
+    else if (action == "rotate")
+    {
+        if (board[from_y][from_x].orientation == "horizontal")
+        {
+            board[from_y][from_x].orientation = "vertical";
+        }
+        else
+        {
+            board[from_y][from_x].orientation = "horizontal";
+        }
+        clear_bfs_cache();
+    }
+}
+
+void unmake_move(std::vector<std::vector<Cell>> &board, const MoveUndo &undo)
+{
+    for (auto it = undo.cells.rbegin(); it != undo.cells.rend(); ++it)
+        board[it->first.y][it->first.x] = it->second;
+}
+
+std::vector<std::vector<Cell>> apply_move(
+    const std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    const std::string &,
+    int, int,
+    const std::vector<int> &)
+{
+    auto new_board = board;
+    MoveUndo undo;
+    make_move(new_board, move, undo);
+    return new_board;
+}
+
+
+const std::vector<std::vector<Cell>> &SiblingBoards::child(const std::unordered_map<std::string, std::string> &move)
+{
+    unmake_move(board_, undo_);
+    make_move(board_, move, undo_);
+    return board_;
+}
+
+Move to_move(const std::unordered_map<std::string, std::string> &m)
+{
+    Move result;
+    result.action = m.at("action");
+    result.from_pos = {std::stoi(m.at("from_x")), std::stoi(m.at("from_y"))};
+    if (m.count("to_x"))
+    {
+        result.to_pos = {std::stoi(m.at("to_x")), std::stoi(m.at("to_y"))};
+    }
+    if (m.count("pushed_x"))
+    {
+        result.pushed_to = {std::stoi(m.at("pushed_x")), std::stoi(m.at("pushed_y"))};
+    }
+    if (m.count("orientation"))
+    {
+        result.orientation = m.at("orientation");
+    }
+    return result;
+}
+
+const std::unordered_map<std::string, std::string> *find_move(
+    const std::vector<std::unordered_map<std::string, std::string>> &legal, const Move &move)
+{
+    for (const auto &m : legal)
+    {
+        Move r = to_move(m);
+        if (r.action == move.action && r.from_pos == move.from_pos && r.to_pos == move.to_pos &&
+            r.pushed_to == move.pushed_to && r.orientation == move.orientation)
+            return &m;
+    }
+    return nullptr;
+}
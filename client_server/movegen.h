@@ -0,0 +1,72 @@
+// Move generation and application
+//
+// Moves travel through the engine in the server's dictionary format:
+// action, from_x, from_y and, depending on the action, to_x/to_y,
+// pushed_x/pushed_y and orientation, all as strings. Move is the same move
+// in the shape returned to Python.
+
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "board.h"
+
+// Every legal move of `current_player`: moves and river flows, pushes,
+// flips and rotations, grouped by piece in board order.
+std::vector<std::unordered_map<std::string, std::string>> generate_all_valid_moves(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &current_player,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// The board after `move`; the input board is left alone. The move names
+// every cell it changes, so the player and board shape go unused.
+std::vector<std::vector<Cell>> apply_move(
+    const std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    const std::string &current_player,
+    int rows, int cols,
+    const std::vector<int> &score_cols);
+
+// The cells make_move changed, as they were before it.
+struct MoveUndo
+{
+    std::vector<std::pair<Position, Cell>> cells;
+};
+
+// apply_move on `board` itself; unmake_move with the same undo restores it.
+void make_move(
+    std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    MoveUndo &undo);
+
+void unmake_move(std::vector<std::vector<Cell>> &board, const MoveUndo &undo);
+
+// The children of one position, one at a time: each move is made on a single
+// copy of the parent after the previous one is unmade, so siblings that are
+// only looked at (search frontier nodes) don't each copy the board.
+class SiblingBoards
+{
+public:
+    explicit SiblingBoards(const std::vector<std::vector<Cell>> &parent) : board_(parent) {}
+
+    // The board after `move`, valid until the next call.
+    const std::vector<std::vector<Cell>> &child(const std::unordered_map<std::string, std::string> &move);
+
+private:
+    std::vector<std::vector<Cell>> board_;
+    MoveUndo undo_;
+};
+
+// The Move form of a move dictionary.
+Move to_move(const std::unordered_map<std::string, std::string> &m);
+
+// The entry of `legal` that `move` was converted from, or nullptr.
+const std::unordered_map<std::string, std::string> *find_move(
+    const std::vector<std::unordered_map<std::string, std::string>> &legal, const Move &move);
+
+#endif // MOVEGEN_H
@@ -0,0 +1,128 @@
+#include "parallel_search.h"
+
+#include <algorithm>
+
+static thread_local SplitPoint *CURRENT_SPLIT = nullptr;
+
+SearchThreads::SearchThreads(int threads)
+{
+    for (int i = 1; i < threads; i++)
+        helpers_.emplace_back([this]
+                              { helper(); });
+}
+
+SearchThreads::~SearchThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto &t : helpers_)
+        t.join();
+}
+
+SplitPoint *SearchThreads::current()
+{
+    return CURRENT_SPLIT;
+}
+
+SplitPoint *SearchThreads::find_work(const SplitPoint *within) const
+{
+    for (auto it = open_.rbegin(); it != open_.rend(); ++it)
+    {
+        SplitPoint *sp = *it;
+        if (sp->next.load(std::memory_order_relaxed) >= sp->count || sp->stopped())
+            continue;
+        if (!within)
+            return sp;
+        for (const SplitPoint *up = sp->parent; up; up = up->parent)
+        {
+            if (up == within)
+                return sp;
+        }
+    }
+    return nullptr;
+}
+
+void SearchThreads::work(SplitPoint &sp)
+{
+    SplitPoint *saved = CURRENT_SPLIT;
+    CURRENT_SPLIT = &sp;
+    for (size_t i = sp.next++; i < sp.count && !sp.stopped(); i = sp.next++)
+    {
+        double alpha, beta;
+        {
+            std::lock_guard<std::mutex> lock(sp.lock);
+            alpha = sp.alpha;
+            beta = sp.beta;
+        }
+        double score = sp.search_child(i, alpha, beta);
+        // A search cut off from above returns a meaningless score
+        if (sp.stopped())
+            break;
+
+        std::lock_guard<std::mutex> lock(sp.lock);
+        if (sp.maximizing)
+        {
+            sp.best = std::max(sp.best, score);
+            sp.alpha = std::max(sp.alpha, score);
+        }
+        else
+        {
+            sp.best = std::min(sp.best, score);
+            sp.beta = std::min(sp.beta, score);
+        }
+        if (sp.beta <= sp.alpha)
+            sp.cutoff = true;
+    }
+    CURRENT_SPLIT = saved;
+}
+
+void SearchThreads::run(SplitPoint &sp)
+{
+    sp.parent = CURRENT_SPLIT;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_.push_back(&sp);
+    }
+    cv_.notify_all();
+    work(sp);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    open_.erase(std::find(open_.begin(), open_.end(), &sp));
+    while (sp.workers > 0)
+    {
+        // Help with the helpers' own split points rather than sleep
+        if (SplitPoint *other = find_work(&sp))
+        {
+            other->workers++;
+            lock.unlock();
+            work(*other);
+            lock.lock();
+            other->workers--;
+            cv_.notify_all();
+            continue;
+        }
+        cv_.wait(lock);
+    }
+}
+
+void SearchThreads::helper()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        SplitPoint *sp = nullptr;
+        cv_.wait(lock, [&]
+                 { return stopping_ || (sp = find_work(nullptr)) != nullptr; });
+        if (stopping_)
+            return;
+        sp->workers++;
+        lock.unlock();
+        work(*sp);
+        lock.lock();
+        sp->workers--;
+        cv_.notify_all();
+    }
+}
@@ -0,0 +1,88 @@
+// Parallel alpha-beta: Young Brothers Wait split points
+//
+// A node searches its eldest child alone. Only if that does not cut off are
+// the younger brothers opened as a SplitPoint, which the owning thread and
+// any idle SearchThreads helper then work through together: each takes the
+// next unsearched child, searches it with the split point's current window
+// and folds the score back in. A cutoff marks the split point, and every
+// search below it, on whichever thread, stops at its next node.
+
+#ifndef PARALLEL_SEARCH_H
+#define PARALLEL_SEARCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class SearchMode
+{
+    Serial,       // plain alpha-beta on the calling thread
+    YoungBrothers // YBWC split points on a SearchThreads pool
+};
+
+// Nodes at least this many plies above the leaves may split. Frontier
+// nodes qualify: one leaf evaluation already outweighs a split.
+constexpr int YBWC_MIN_SPLIT_DEPTH = 1;
+
+struct SplitPoint
+{
+    SplitPoint *parent = nullptr; // split point the owning search runs under
+    bool maximizing = true;
+    size_t count = 0; // children; index 0 is searched before the split
+    std::function<double(size_t index, double alpha, double beta)> search_child;
+
+    std::mutex lock; // guards the window and best
+    double alpha = 0.0, beta = 0.0, best = 0.0;
+    std::atomic<size_t> next{1};
+    std::atomic<bool> cutoff{false};
+    int workers = 0; // helpers inside, guarded by the pool's mutex
+
+    // This split point or one it runs under has cut off.
+    bool stopped() const
+    {
+        for (const SplitPoint *sp = this; sp; sp = sp->parent)
+        {
+            if (sp->cutoff.load(std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+};
+
+class SearchThreads
+{
+public:
+    // `threads` includes the searching thread: threads - 1 helpers start.
+    explicit SearchThreads(int threads);
+
+    ~SearchThreads();
+
+    int threads() const { return static_cast<int>(helpers_.size()) + 1; }
+
+    // Searches the remaining children of `sp` on the calling thread and on
+    // idle helpers. Returns once every thread has left it; while helpers
+    // finish, the caller joins split points opened beneath it.
+    void run(SplitPoint &sp);
+
+    // The split point the calling thread searches under, or nullptr.
+    static SplitPoint *current();
+
+private:
+    void helper();
+    void work(SplitPoint &sp);
+    // Newest open split point with children left, beneath `within` if set.
+    // Call with mutex_ held.
+    SplitPoint *find_work(const SplitPoint *within) const;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<SplitPoint *> open_;
+    bool stopping_ = false;
+    std::vector<std::thread> helpers_;
+};
+
+#endif // PARALLEL_SEARCH_H
@@ -0,0 +1,253 @@
+// Pattern database for river-assisted goal distance
+//
+// The distance BFS only follows rivers that already exist. A stone next to
+// one of its own stones or rivers can often do much better: flip the
+// neighbour into a river (or rotate it) and flow along it. This database
+// answers, for a stone and its four neighbours, the fewest moves needed to
+// reach a score cell when at most one own neighbour is flipped or rotated
+// first, on an otherwise empty board, and how many moves that flip saves
+// over the same stone with its neighbours left as they are.
+//
+// Positions are described relative to the goal: dy is the number of rows in
+// front of the score row (negative behind it), dx the number of columns
+// outside the score columns. The whole table is built once per process.
+
+#ifndef PATTERN_DB_H
+#define PATTERN_DB_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace PatternDB
+{
+    enum State : uint8_t
+    {
+        EMPTY = 0,
+        BLOCK,       // a stone the mover cannot use
+        OWN_STONE,   // can be flipped into a river
+        RIVER_H,     // opponent's river: usable, not ours to rotate
+        RIVER_V,
+        OWN_RIVER_H, // can be rotated
+        OWN_RIVER_V,
+        NUM_STATES
+    };
+
+    // Neighbour order: towards the score row, away from it, towards the score
+    // columns, away from them.
+    constexpr int NEIGHBOURS = 4;
+    constexpr int NUM_PATTERNS = NUM_STATES * NUM_STATES * NUM_STATES * NUM_STATES;
+    constexpr int DY_MIN = -2;
+    constexpr int DY_MAX = 14;
+    constexpr int DX_MAX = 5;
+    constexpr uint8_t UNREACHABLE = 255;
+
+    inline int encode(const std::array<uint8_t, NEIGHBOURS> &n)
+    {
+        return ((n[0] * NUM_STATES + n[1]) * NUM_STATES + n[2]) * NUM_STATES + n[3];
+    }
+
+    inline std::array<uint8_t, NEIGHBOURS> decode(int pattern)
+    {
+        std::array<uint8_t, NEIGHBOURS> n;
+        for (int i = NEIGHBOURS - 1; i >= 0; i--)
+        {
+            n[i] = static_cast<uint8_t>(pattern % NUM_STATES);
+            pattern /= NUM_STATES;
+        }
+        return n;
+    }
+
+    inline size_t key(int dy, int dx, int pattern)
+    {
+        return (static_cast<size_t>(dy - DY_MIN) * (DX_MAX + 1) + dx) * NUM_PATTERNS + pattern;
+    }
+
+    // Abstract board: score row at y = 0 with the score columns at x <= 0,
+    // the board's middle towards +y. The box is wide enough that flows reach
+    // every useful landing cell.
+    constexpr int BOX_X0 = -3, BOX_X1 = DX_MAX + 3;
+    constexpr int BOX_Y0 = DY_MIN - 1, BOX_Y1 = DY_MAX + 3;
+    constexpr int BOX_W = BOX_X1 - BOX_X0 + 1;
+    constexpr int BOX_H = BOX_Y1 - BOX_Y0 + 1;
+
+    inline bool is_river(uint8_t s) { return s == RIVER_H || s == RIVER_V || s == OWN_RIVER_H || s == OWN_RIVER_V; }
+    inline bool is_horizontal(uint8_t s) { return s == RIVER_H || s == OWN_RIVER_H; }
+
+    // Plain BFS from (dx, dy) with the four neighbours set as given.
+    inline uint8_t search(int dy, int dx, const std::array<uint8_t, NEIGHBOURS> &n)
+    {
+        if (dy == 0 && dx == 0)
+            return 0;
+
+        std::array<uint8_t, BOX_W * BOX_H> grid{};
+        std::array<uint8_t, BOX_W * BOX_H> dist;
+        dist.fill(UNREACHABLE);
+        auto at = [](int x, int y)
+        { return (y - BOX_Y0) * BOX_W + (x - BOX_X0); };
+        auto inside = [](int x, int y)
+        { return x >= BOX_X0 && x <= BOX_X1 && y >= BOX_Y0 && y <= BOX_Y1; };
+
+        const int NX[NEIGHBOURS] = {0, 0, -1, 1};
+        const int NY[NEIGHBOURS] = {-1, 1, 0, 0};
+        for (int i = 0; i < NEIGHBOURS; i++)
+        {
+            if (inside(dx + NX[i], dy + NY[i]))
+                grid[at(dx + NX[i], dy + NY[i])] = n[i];
+        }
+
+        std::array<int, BOX_W * BOX_H> queue;
+        int head = 0, tail = 0;
+        dist[at(dx, dy)] = 0;
+        queue[tail++] = at(dx, dy);
+
+        std::array<uint8_t, BOX_W * BOX_H> seen_river{};
+        std::array<int, BOX_W * BOX_H> rivers;
+        while (head < tail)
+        {
+            int c = queue[head++];
+            int cx = c % BOX_W + BOX_X0, cy = c / BOX_W + BOX_Y0;
+            uint8_t d = dist[c];
+
+            auto reach = [&](int x, int y)
+            {
+                int i = at(x, y);
+                if (dist[i] != UNREACHABLE)
+                    return false;
+                dist[i] = d + 1;
+                queue[tail++] = i;
+                return y == 0 && x <= 0;
+            };
+
+            for (int k = 0; k < NEIGHBOURS; k++)
+            {
+                int nx = cx + NX[k], ny = cy + NY[k];
+                if (!inside(nx, ny))
+                    continue;
+                uint8_t s = grid[at(nx, ny)];
+                if (s == EMPTY)
+                {
+                    if (reach(nx, ny))
+                        return d + 1;
+                    continue;
+                }
+                if (!is_river(s))
+                    continue;
+
+                // Flow through the river network starting at (nx, ny).
+                seen_river.fill(0);
+                int r_head = 0, r_tail = 0;
+                rivers[r_tail++] = at(nx, ny);
+                while (r_head < r_tail)
+                {
+                    int r = rivers[r_head++];
+                    if (seen_river[r])
+                        continue;
+                    seen_river[r] = 1;
+                    int rx = r % BOX_W + BOX_X0, ry = r / BOX_W + BOX_Y0;
+                    bool horizontal = is_horizontal(grid[r]);
+                    for (int dir : {1, -1})
+                    {
+                        int sx = horizontal ? dir : 0, sy = horizontal ? 0 : dir;
+                        for (int x = rx + sx, y = ry + sy; inside(x, y); x += sx, y += sy)
+                        {
+                            uint8_t t = grid[at(x, y)];
+                            if (t == EMPTY)
+                            {
+                                if (reach(x, y))
+                                    return d + 1;
+                                continue;
+                            }
+                            if (is_river(t))
+                                rivers[r_tail++] = at(x, y);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        return UNREACHABLE;
+    }
+
+    class Database
+    {
+    public:
+        static const Database &instance()
+        {
+            static Database db;
+            return db;
+        }
+
+        // Moves for a stone at (dy, dx) with neighbour pattern `pattern`,
+        // clamped into the table's range.
+        uint8_t distance(int dy, int dx, int pattern) const
+        {
+            dy = std::clamp(dy, DY_MIN, DY_MAX);
+            dx = std::clamp(dx, 0, DX_MAX);
+            return table_[key(dy, dx, pattern)];
+        }
+
+        // Moves the best flip or rotate saves over leaving the neighbours as
+        // they are; 0 when none helps or the stone is walled in without one.
+        uint8_t flip_saving(int dy, int dx, int pattern) const
+        {
+            dy = std::clamp(dy, DY_MIN, DY_MAX);
+            dx = std::clamp(dx, 0, DX_MAX);
+            return savings_[key(dy, dx, pattern)];
+        }
+
+        size_t bytes() const { return table_.size() + savings_.size(); }
+
+    private:
+        Database() : table_(static_cast<size_t>(DY_MAX - DY_MIN + 1) * (DX_MAX + 1) * NUM_PATTERNS),
+                     savings_(table_.size(), 0)
+        {
+            // First without touching any neighbour, then allow one flip or
+            // rotate of an own neighbour at the cost of one move.
+            for (int dy = DY_MIN; dy <= DY_MAX; dy++)
+            {
+                for (int dx = 0; dx <= DX_MAX; dx++)
+                {
+                    for (int p = 0; p < NUM_PATTERNS; p++)
+                        table_[key(dy, dx, p)] = search(dy, dx, decode(p));
+                }
+            }
+            std::vector<uint8_t> plain = table_;
+            for (int dy = DY_MIN; dy <= DY_MAX; dy++)
+            {
+                for (int dx = 0; dx <= DX_MAX; dx++)
+                {
+                    for (int p = 0; p < NUM_PATTERNS; p++)
+                    {
+                        auto n = decode(p);
+                        uint8_t best = plain[key(dy, dx, p)];
+                        for (int i = 0; i < NEIGHBOURS; i++)
+                        {
+                            uint8_t original = n[i];
+                            for (uint8_t to : {OWN_RIVER_H, OWN_RIVER_V})
+                            {
+                                if (to == original || (original != OWN_STONE && original != OWN_RIVER_H && original != OWN_RIVER_V))
+                                    continue;
+                                n[i] = to;
+                                uint8_t d = plain[key(dy, dx, encode(n))];
+                                if (d != UNREACHABLE)
+                                    best = std::min<uint8_t>(best, d + 1);
+                            }
+                            n[i] = original;
+                        }
+                        table_[key(dy, dx, p)] = best;
+                        uint8_t unflipped = plain[key(dy, dx, p)];
+                        if (unflipped != UNREACHABLE)
+                            savings_[key(dy, dx, p)] = unflipped - best;
+                    }
+                }
+            }
+        }
+
+        std::vector<uint8_t> table_;
+        std::vector<uint8_t> savings_;
+    };
+}
+
+#endif
@@ -0,0 +1,74 @@
+// Move generation node counts from the standard start position.
+//
+//   perft [--rows R] [--depth D]
+//
+// Counts the positions reached after D plies (circle moving first) on the
+// R-row board (R - 1 columns, R from 10 to 32), or on the three official
+// sizes without --rows, and prints the count and time per depth. Exercises
+// move generation, river flow and move application only, with no
+// evaluation or search.
+
+#include "board.h"
+#include "movegen.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static long long perft(const std::vector<std::vector<Cell>> &board, const std::string &player,
+                       int depth, int rows, int cols, const std::vector<int> &score_cols)
+{
+    auto moves = generate_all_valid_moves(board, player, rows, cols, score_cols);
+    if (depth == 1)
+        return static_cast<long long>(moves.size());
+    long long nodes = 0;
+    for (const auto &move : moves)
+    {
+        auto next = apply_move(board, move, player, rows, cols, score_cols);
+        if (!check_win(next, rows, cols, score_cols).empty())
+        {
+            nodes++;
+            continue;
+        }
+        nodes += perft(next, get_opponent(player), depth - 1, rows, cols, score_cols);
+    }
+    return nodes;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<int> sizes = {13, 15, 17};
+    int max_depth = 3;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        int value = std::atoi(argv[i + 1]);
+        if (flag == "--rows" && supported_board(value, value - 1))
+            sizes = {value};
+        else if (flag == "--depth" && value >= 1)
+            max_depth = value;
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--rows " << MIN_BOARD_ROWS << "-" << MAX_BOARD_SIDE << "] [--depth D]\n";
+            return 1;
+        }
+    }
+
+    for (int rows : sizes)
+    {
+        int cols = rows - 1;
+        auto score_cols = score_cols_for(cols);
+        auto board = standard_start_board(rows, cols);
+        for (int depth = 1; depth <= max_depth; depth++)
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            long long nodes = perft(board, "circle", depth, rows, cols, score_cols);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << rows << "x" << cols << " depth " << depth << ": " << nodes << " nodes in "
+                      << seconds << "s\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#!/bin/bash
+set -e
+
+# Profile-guided build: instrument, train on the built-in workload, rebuild
+# with the profile. Pass LTO=ON in the environment to add link-time optimisation.
+
+PYBIND11_DIR=$(python3 -m pybind11 --cmakedir)
+LTO=${LTO:-OFF}
+
+mkdir -p build
+cd build
+
+configure() {
+  cmake .. \
+    -Dpybind11_DIR="$PYBIND11_DIR" \
+    -DCMAKE_C_COMPILER=gcc \
+    -DCMAKE_CXX_COMPILER=g++ \
+    -DLTO="$LTO" \
+    -DPGO="$1"
+}
+
+# Stale profiles from an older source would only be partly used
+rm -rf pgo-profile pgo-tablebases
+
+configure GENERATE
+make -j"$(nproc)"
+make pgo_train
+
+configure USE
+make -j"$(nproc)"
+
+# Return to project root
+cd ..
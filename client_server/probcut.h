@@ -0,0 +1,90 @@
+// ProbCut forward pruning
+//
+// At a node `depth` plies above the leaves, a search GAP plies shallower
+// predicts the deep value as a * shallow + b, with residual error sigma.
+// When the prediction lies more than `threshold` sigmas outside the node's
+// window, the deep search would almost surely fail the same way, so the
+// node returns the bound without it. As in Multi-ProbCut, every deep depth
+// has its own fit per board size and game phase: the spread of the
+// evaluation changes a lot once stones start reaching the score rows.
+//
+// The fits live in probcut_params.h, which probcut_calibrate writes from
+// shallow and deep searches of positions in the logged games. A cell with
+// fewer than MIN_SAMPLES samples, or whose shallow search does not predict
+// the deep one, never prunes. With the shipped logs the 15x14 and 17x16
+// cells hold 4 to 12 samples each, so ProbCut only prunes on 13x12.
+//
+// There is no default threshold. On six 13x12 positions at depth 3, 1.5
+// was slower than the plain search and changed nothing, 0.5 was about 1.2
+// times faster with no value changed and 0.25 about 1.7 times faster with
+// one value of six changed.
+
+#ifndef PROBCUT_H
+#define PROBCUT_H
+
+#include <algorithm>
+#include <vector>
+
+#include "board.h"
+
+namespace ProbCut
+{
+    constexpr int GAP = 2;       // plies between the deep and the shallow search
+    constexpr int MIN_DEEP = 2;  // shallowest node that may prune (shallow = evaluation)
+    constexpr int MAX_DEEP = 3;  // deeper nodes use this depth's fits
+    constexpr int PHASES = 3;
+    constexpr int MIN_SAMPLES = 30;
+
+    struct Fit
+    {
+        double a = 1.0, b = 0.0, sigma = 0.0;
+        int samples = 0;
+    };
+
+    // 0 before any stone has scored, 1 while fewer stones than one side
+    // needs to win sit on score cells, 2 after.
+    inline int phase(const std::vector<std::vector<Cell>> &board, int rows, int cols,
+                     const std::vector<int> &score_cols)
+    {
+        int scored = 0;
+        for (int y : {top_score_row(), bottom_score_row(rows)})
+        {
+            for (int x : score_cols)
+            {
+                if (in_bounds(x, y, rows, cols) && board[y][x].side == "stone")
+                    scored++;
+            }
+        }
+        if (scored == 0)
+            return 0;
+        return scored < get_win_count(cols) ? 1 : 2;
+    }
+
+    // Index of a board size in the fit tables, or -1. The fits come from
+    // the standard rows x (rows - 1) boards only.
+    inline int size_index(int rows, int cols)
+    {
+        if (cols != rows - 1)
+            return -1;
+        return rows == 13 ? 0 : rows == 15 ? 1 : rows == 17 ? 2 : -1;
+    }
+}
+
+#include "probcut_params.h"
+
+namespace ProbCut
+{
+    // The fit for a node `depth` plies deep, or nullptr if it may not prune.
+    inline const Fit *fit_for(int rows, int cols, int depth, int phase)
+    {
+        int size = size_index(rows, cols);
+        if (size < 0 || depth < MIN_DEEP)
+            return nullptr;
+        const Fit &fit = FITS[size][std::min(depth, MAX_DEEP) - MIN_DEEP][phase];
+        if (fit.samples < MIN_SAMPLES || fit.a <= 0.0)
+            return nullptr;
+        return &fit;
+    }
+}
+
+#endif // PROBCUT_H
@@ -0,0 +1,263 @@
+// ProbCut calibration from logged games.
+//
+//   probcut_calibrate [--logs game_logs.zip] [--out probcut_params.h]
+//                     [--max-deep D] [--every N] [--threads T]
+//
+// Takes every Nth position of each game in the archive and searches it with
+// a full window at each deep depth d (ProbCut::MIN_DEEP to D) and at
+// d - ProbCut::GAP: once for the side to move, as a maximizing node, and
+// once for the other side, as a minimizing one. deep = a * shallow + b is
+// then fitted by least squares per board size, deep depth and phase, and
+// the fits are written to probcut_params.h. Cells with no logged positions
+// keep their current fits.
+
+#include "board.h"
+#include "game_log_reader.h"
+#include "probcut.h"
+#include "search.h"
+#include "tracking.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct LoggedPosition
+{
+    std::vector<std::vector<Cell>> board;
+    int rows = 0;
+    std::string to_move;
+};
+
+struct Sample
+{
+    int size, deep, phase;
+    double shallow, value;
+};
+
+constexpr int DEEPS = ProbCut::MAX_DEEP - ProbCut::MIN_DEEP + 1;
+using FitTable = ProbCut::Fit[3][DEEPS][ProbCut::PHASES];
+
+static std::vector<LoggedPosition> logged_positions(const std::string &path, int every, std::string &error)
+{
+    std::vector<LoggedPosition> positions;
+    GameLogs::for_each_game(
+        path, [&](const GameLogs::GameRecord &game)
+        {
+            if (!game.error.empty() || ProbCut::size_index(game.rows, game.cols) < 0)
+                return;
+            BoardTracker tracker(game.rows, game.cols);
+            auto score_cols = score_cols_for(game.cols);
+            for (size_t i = 0; i < game.moves.size(); i += every)
+            {
+                const auto &move = game.moves[i];
+                if (move.state.size() != static_cast<size_t>(game.rows * game.cols))
+                    continue;
+                tracker.load(move.state);
+                if (!check_win(tracker.cells(), game.rows, game.cols, score_cols).empty())
+                    continue;
+                positions.push_back({tracker.cells(), game.rows, get_opponent(move.player)});
+            } },
+        0, &error);
+    return positions;
+}
+
+static void search_positions(const std::vector<LoggedPosition> &positions, int max_deep, int threads,
+                             std::vector<Sample> &samples)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    std::atomic<size_t> next{0};
+    std::mutex lock;
+    auto work = [&]
+    {
+        StudentAgent circle("circle"), square("square");
+        for (size_t i = next++; i < positions.size(); i = next++)
+        {
+            const LoggedPosition &pos = positions[i];
+            int cols = pos.rows - 1;
+            auto score_cols = score_cols_for(cols);
+            int phase = ProbCut::phase(pos.board, pos.rows, cols, score_cols);
+            std::vector<Sample> found;
+            for (int deep = ProbCut::MIN_DEEP; deep <= max_deep; deep++)
+            {
+                for (bool maximizing : {true, false})
+                {
+                    bool circle_searches = (pos.to_move == "circle") == maximizing;
+                    StudentAgent &agent = circle_searches ? circle : square;
+                    double shallow = agent.minimax(pos.board, deep - ProbCut::GAP, -INF, INF, maximizing,
+                                                   pos.rows, cols, score_cols);
+                    double value = agent.minimax(pos.board, deep, -INF, INF, maximizing, pos.rows, cols, score_cols);
+                    found.push_back({ProbCut::size_index(pos.rows, cols), deep, phase, shallow, value});
+                }
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            samples.insert(samples.end(), found.begin(), found.end());
+            if ((i + 1) % 50 == 0)
+                std::cerr << (i + 1) << " / " << positions.size() << " positions\n";
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++)
+        workers.emplace_back(work);
+    work();
+    for (auto &w : workers)
+        w.join();
+}
+
+// Least squares over the samples of one cell; a cell whose shallow values
+// do not vary keeps a = 0 and so never prunes.
+static ProbCut::Fit fit(const std::vector<const Sample *> &cell)
+{
+    ProbCut::Fit result;
+    size_t n = cell.size();
+    result.samples = static_cast<int>(n);
+    if (n < 3)
+    {
+        result.a = 0.0;
+        return result;
+    }
+    double mean_x = 0.0, mean_y = 0.0;
+    for (const Sample *s : cell)
+    {
+        mean_x += s->shallow;
+        mean_y += s->value;
+    }
+    mean_x /= n;
+    mean_y /= n;
+    double sxx = 0.0, sxy = 0.0;
+    for (const Sample *s : cell)
+    {
+        sxx += (s->shallow - mean_x) * (s->shallow - mean_x);
+        sxy += (s->shallow - mean_x) * (s->value - mean_y);
+    }
+    result.a = sxx > 0.0 ? sxy / sxx : 0.0;
+    result.b = mean_y - result.a * mean_x;
+    double residual = 0.0;
+    for (const Sample *s : cell)
+    {
+        double e = s->value - (result.a * s->shallow + result.b);
+        residual += e * e;
+    }
+    result.sigma = std::sqrt(residual / (n - 2));
+    return result;
+}
+
+static bool write_params(const std::string &path, const FitTable &fits, const std::string &source,
+                         int every, int max_deep)
+{
+    FILE *out = std::fopen(path.c_str(), "w");
+    if (!out)
+        return false;
+    std::fprintf(out, "// Generated by probcut_calibrate from %s (one position in %d, deep\n"
+                      "// depths %d-%d); rerun it rather than editing by hand.\n\n",
+                 source.c_str(), every, ProbCut::MIN_DEEP, max_deep);
+    std::fprintf(out, "#ifndef PROBCUT_PARAMS_H\n#define PROBCUT_PARAMS_H\n\nnamespace ProbCut\n{\n");
+    std::fprintf(out, "    // [board size 13/15/17][deep depth - MIN_DEEP][phase] = {a, b, sigma, samples}\n");
+    std::fprintf(out, "    constexpr Fit FITS[3][MAX_DEEP - MIN_DEEP + 1][PHASES] = {\n");
+    for (int size = 0; size < 3; size++)
+    {
+        std::fprintf(out, "        {\n");
+        for (int d = 0; d < DEEPS; d++)
+        {
+            std::fprintf(out, "            {");
+            for (int phase = 0; phase < ProbCut::PHASES; phase++)
+            {
+                const ProbCut::Fit &f = fits[size][d][phase];
+                std::fprintf(out, "%s{%.17g, %.17g, %.17g, %d}", phase ? ", " : "", f.a, f.b, f.sigma, f.samples);
+            }
+            std::fprintf(out, "},\n");
+        }
+        std::fprintf(out, "        },\n");
+    }
+    std::fprintf(out, "    };\n}\n\n#endif // PROBCUT_PARAMS_H\n");
+    return std::fclose(out) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    std::string logs = "game_logs.zip", out = "probcut_params.h";
+    int max_deep = ProbCut::MIN_DEEP, every = 4, threads = 0;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--logs")
+            logs = value;
+        else if (flag == "--out")
+            out = value;
+        else if (flag == "--max-deep" && std::atoi(value.c_str()) >= ProbCut::MIN_DEEP &&
+                 std::atoi(value.c_str()) <= ProbCut::MAX_DEEP)
+            max_deep = std::atoi(value.c_str());
+        else if (flag == "--every" && std::atoi(value.c_str()) >= 1)
+            every = std::atoi(value.c_str());
+        else if (flag == "--threads" && std::atoi(value.c_str()) >= 0)
+            threads = std::atoi(value.c_str());
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--logs game_logs.zip] [--out probcut_params.h]"
+                      << " [--max-deep " << ProbCut::MIN_DEEP << "-" << ProbCut::MAX_DEEP
+                      << "] [--every N] [--threads T]\n";
+            return 1;
+        }
+    }
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::string error;
+    auto positions = logged_positions(logs, every, error);
+    if (!error.empty())
+    {
+        std::cerr << logs << ": " << error << "\n";
+        return 1;
+    }
+    std::cerr << positions.size() << " positions from " << logs << "\n";
+
+    std::vector<Sample> samples;
+    search_positions(positions, max_deep, threads, samples);
+
+    FitTable fits;
+    for (int size = 0; size < 3; size++)
+        for (int d = 0; d < DEEPS; d++)
+            for (int phase = 0; phase < ProbCut::PHASES; phase++)
+                fits[size][d][phase] = ProbCut::FITS[size][d][phase];
+
+    const char *sizes[] = {"13x12", "15x14", "17x16"};
+    std::cout << "size   deep phase samples  a          b          sigma\n";
+    for (int size = 0; size < 3; size++)
+    {
+        for (int deep = ProbCut::MIN_DEEP; deep <= max_deep; deep++)
+        {
+            for (int phase = 0; phase < ProbCut::PHASES; phase++)
+            {
+                std::vector<const Sample *> cell;
+                for (const auto &s : samples)
+                {
+                    if (s.size == size && s.deep == deep && s.phase == phase)
+                        cell.push_back(&s);
+                }
+                if (cell.empty())
+                    continue;
+                ProbCut::Fit &f = fits[size][deep - ProbCut::MIN_DEEP][phase];
+                f = fit(cell);
+                bool prunes = f.samples >= ProbCut::MIN_SAMPLES && f.a > 0.0;
+                std::printf("%-6s %-4d %-5d %-8d %-10.4g %-10.4g %-10.4g%s\n", sizes[size], deep, phase,
+                            f.samples, f.a, f.b, f.sigma, prunes ? "" : "  (no pruning)");
+            }
+        }
+    }
+
+    std::string source = logs.substr(logs.find_last_of('/') + 1);
+    if (!write_params(out, fits, source, every, max_deep))
+    {
+        std::cerr << "cannot write " << out << "\n";
+        return 1;
+    }
+    std::cerr << "wrote " << out << "\n";
+    return 0;
+}
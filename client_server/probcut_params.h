@@ -0,0 +1,26 @@
+// Generated by probcut_calibrate from game_logs.zip (one position in 12, deep
+// depths 2-3); rerun it rather than editing by hand.
+
+#ifndef PROBCUT_PARAMS_H
+#define PROBCUT_PARAMS_H
+
+namespace ProbCut
+{
+    // [board size 13/15/17][deep depth - MIN_DEEP][phase] = {a, b, sigma, samples}
+    constexpr Fit FITS[3][MAX_DEEP - MIN_DEEP + 1][PHASES] = {
+        {
+            {{1.2699969217778253, -4993397253384.7637, 41866216192929.836, 96}, {1.1012136386237033, 1863115438500.4219, 111532364307555.52, 94}, {1.1990681550095479, 67240031954771.344, 249016515740649.62, 46}},
+            {{1.0757736647065677, 4045946066204.0625, 44786697296535.133, 96}, {0.97644790393429926, 1314754236582.1406, 72702384565162.484, 94}, {1.3320450258364773, 163929008105212.78, 414886374153254.94, 46}},
+        },
+        {
+            {{0.70753458196862495, -255247484752.67603, 536009484893.47241, 4}, {1.0638261582798301, 40477824798683.188, 127305983141404.28, 4}, {1, 0, 0, 0}},
+            {{0.94971417428395088, 265256683539.64453, 674223846326.68298, 4}, {1.118362929594602, 75288828517481.531, 122417749814279.45, 4}, {1, 0, 0, 0}},
+        },
+        {
+            {{2.1957323347736097, 11406058175835.875, 33063058215164.805, 10}, {0.94273610471865454, -10760877738543.312, 34840921322659.215, 12}, {1, 0, 0, 0}},
+            {{0.60300484554185763, 7773221927983.2188, 57409499327340.898, 10}, {0.97386512398121483, -27101143539114.438, 98577144219806.234, 12}, {1, 0, 0, 0}},
+        },
+    };
+}
+
+#endif // PROBCUT_PARAMS_H
@@ -0,0 +1,1642 @@
+#include "search.h"
+
+#include <cstdlib>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "distance.h"
+#include "pattern_db.h"
+#include "verify.h"
+
+StudentAgent::StudentAgent(const std::string &player_name)
+    : player(player_name),
+      opponent(get_opponent(player_name)),
+      MAX_DEPTH(2),
+      MAX_ITERATIVE_DEPTH(6),
+      moves(0),
+      repetition_limit(2),
+      rng(std::random_device{}())
+{
+    if (const char *dir = std::getenv("RS_TABLEBASE_DIR"))
+    {
+        tablebase.load_dir(dir);
+    }
+    PatternDB::Database::instance(); // build now rather than on the first move's clock
+}
+
+void StudentAgent::set_search_mode(SearchMode mode, int threads)
+{
+    search_threads.reset();
+    if (mode == SearchMode::Serial)
+    {
+        apply_memory_plan();
+        return;
+    }
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    search_threads = std::make_unique<SearchThreads>(threads);
+    apply_memory_plan();
+}
+
+void StudentAgent::set_root_driver(RootDriver driver)
+{
+    root_driver = driver;
+    if (driver == RootDriver::Mtdf)
+    {
+        if (!transpositions)
+            transpositions = std::make_unique<TranspositionTable>();
+    }
+    else
+    {
+        transpositions.reset();
+    }
+    apply_memory_plan();
+}
+
+void StudentAgent::set_memory_budget(size_t bytes, const MemoryPolicy &policy)
+{
+    memory_budget = bytes;
+    memory_policy = policy;
+    apply_memory_plan();
+}
+
+void StudentAgent::apply_memory_plan()
+{
+    int threads = search_threads ? search_threads->threads() : 1;
+    size_t fixed = PatternDB::Database::instance().bytes() + threads * search_scratch_bytes() +
+                   tablebase.mapped_bytes();
+    if (!memory_budget)
+    {
+        memory_plan = MemoryPlan();
+        memory_plan.fixed_bytes = fixed;
+        threat_account.reset();
+        if (transpositions &&
+            transpositions->stats().capacity != size_t(1) << TranspositionTable::DEFAULT_BITS)
+            transpositions = std::make_unique<TranspositionTable>();
+        return;
+    }
+    memory_plan = plan_memory(memory_budget, memory_policy, fixed, transpositions != nullptr, threads);
+    if (threat_account)
+        threat_account->set_budget(memory_plan.threat_bytes_per_thread);
+    else
+        threat_account = std::make_unique<ThreatCacheAccount>(memory_plan.threat_bytes_per_thread);
+    if (transpositions)
+    {
+        int bits = TranspositionTable::bits_for(memory_plan.transposition_bytes);
+        if (transpositions->stats().capacity != size_t(1) << bits)
+            transpositions = std::make_unique<TranspositionTable>(bits);
+    }
+}
+
+MemoryReport StudentAgent::memory_report() const
+{
+    MemoryReport report;
+    report.budget = memory_budget;
+
+    CacheStats patterns;
+    patterns.name = "pattern database";
+    patterns.bytes = patterns.budget_bytes = PatternDB::Database::instance().bytes();
+    patterns.entries = patterns.capacity = patterns.bytes; // one byte a distance
+    report.tables.push_back(patterns);
+
+    CacheStats scratch;
+    scratch.name = "search scratch";
+    scratch.entries = search_threads ? search_threads->threads() : 1;
+    scratch.bytes = scratch.budget_bytes = scratch.entries * search_scratch_bytes();
+    report.tables.push_back(scratch);
+
+    if (!tablebase.empty())
+    {
+        CacheStats mapped;
+        mapped.name = "tablebases";
+        mapped.entries = tablebase.size();
+        mapped.bytes = mapped.budget_bytes = tablebase.mapped_bytes();
+        report.tables.push_back(mapped);
+    }
+
+    if (transpositions)
+        report.tables.push_back(transpositions->stats());
+    report.tables.push_back(threat_account ? threat_account->stats() : threat_cache_stats());
+    return report;
+}
+
+void StudentAgent::record_move_stats(const std::string &mode, TimeManager &clock, int depth, const std::string &decision)
+{
+    MoveStats &stats = clock.stats();
+    stats.move_number = static_cast<int>(move_history.size()) + 1;
+    stats.mode = mode;
+    stats.elapsed = clock.elapsed();
+    stats.depth = depth;
+    stats.decision = decision;
+    move_history.push_back(stats);
+}
+
+std::vector<Position> StudentAgent::get_my_goal_cells(int rows, int cols, const std::vector<int> &score_cols)
+{
+    int goal_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
+    std::vector<Position> goals;
+    for (int x : score_cols)
+    {
+        goals.push_back(Position(x, goal_row));
+    }
+    return goals;
+}
+
+std::vector<Position> StudentAgent::get_opponent_goal_cells(int rows, int cols, const std::vector<int> &score_cols)
+{
+    int goal_row = (player == "circle") ? bottom_score_row(rows) : top_score_row();
+    std::vector<Position> goals;
+    for (int x : score_cols)
+    {
+        goals.push_back(Position(x, goal_row));
+    }
+    return goals;
+}
+
+std::vector<StudentAgent::RiverOpportunity> StudentAgent::find_river_creation_opportunities(
+    const std::vector<std::vector<Cell>> &board,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    std::vector<RiverOpportunity> opportunities;
+    auto my_goals = get_my_goal_cells(rows, cols, score_cols);
+
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &cell = board[y][x];
+            if (!cell.isEmpty() && cell.owner == player && cell.side == "stone")
+            {
+                auto [dist_with_flip, best_orient] = bfs_distance_with_flip(
+                    board, x, y, my_goals, player, rows, cols, score_cols);
+
+                auto current_result = bfs_distance_to_goals_cached(
+                    board, x, y, my_goals, player, rows, cols, score_cols);
+                double current_dist = current_result.distance;
+
+                if (best_orient != "none" && dist_with_flip < current_dist - 1)
+                {
+                    RiverOpportunity opp;
+                    opp.action = "flip";
+                    opp.from_x = x;
+                    opp.from_y = y;
+                    opp.orientation = best_orient;
+                    opp.value = std::pow(2, 30.0 - std::min(dist_with_flip, 30.0)) * 1000.0;
+                    opp.defensive = false;
+                    opportunities.push_back(opp);
+                }
+            }
+        }
+    }
+
+    std::sort(opportunities.begin(), opportunities.end(),
+              [](const RiverOpportunity &a, const RiverOpportunity &b)
+              {
+                  return a.value > b.value;
+              });
+
+    return opportunities;
+}
+
+std::vector<StudentAgent::RiverOpportunity> StudentAgent::find_defensive_river_placements(
+    const std::vector<std::vector<Cell>> &board,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    std::vector<RiverOpportunity> defensive_moves;
+    auto opp_goals = get_opponent_goal_cells(rows, cols, score_cols);
+    auto my_goals = get_my_goal_cells(rows, cols, score_cols);
+    auto threats = analyse_threats(board, opponent, rows, cols, score_cols);
+    auto mine = analyse_threats(board, player, rows, cols, score_cols);
+
+    // For each threat, find blocking positions
+    for (const auto &threat : threats->stones)
+    {
+        if (threat.dist >= 6)
+            break; // nearest first
+        for (size_t i = 1; i < threat.path.size() - 1; i++)
+        {
+            Position p = threat.path[i];
+            const Cell &cell = board[p.y][p.x];
+
+            if (!cell.isEmpty() && cell.owner == player && cell.side == "stone")
+            {
+                for (const char *orient : {"horizontal", "vertical"})
+                {
+                    auto board_copy = board;
+                    board_copy[p.y][p.x].side = "river";
+                    board_copy[p.y][p.x].orientation = orient;
+                    auto new_result = astar_distance_to_goals(
+                        board_copy, threat.x, threat.y, opp_goals, opponent, rows, cols, score_cols);
+
+                    bool blocks_us = false;
+                    for (const auto &my_stone : mine->stones)
+                    {
+                        auto my_after = astar_distance_to_goals(
+                            board_copy, my_stone.x, my_stone.y, my_goals, player, rows, cols, score_cols);
+                        if (my_after.distance > my_stone.dist + 2)
+                        {
+                            blocks_us = true;
+                            break;
+                        }
+                    }
+
+                    if (new_result.distance > threat.dist + 1 && !blocks_us)
+                    {
+                        RiverOpportunity def;
+                        def.action = "flip";
+                        def.from_x = p.x;
+                        def.from_y = p.y;
+                        def.orientation = orient;
+                        def.value = std::pow(2, 35 - std::min(35.0, threat.dist)) * 1000.0;
+                        def.defensive = true;
+                        defensive_moves.push_back(def);
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(defensive_moves.begin(), defensive_moves.end(),
+              [](const RiverOpportunity &a, const RiverOpportunity &b)
+              {
+                  return a.value > b.value;
+              });
+
+    return defensive_moves;
+}
+
+int StudentAgent::probe_goal_zone(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &attacker,
+    const std::string &to_move,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    using namespace Tablebase;
+    const int width = static_cast<int>(score_cols.size());
+    const int zone_cols = width + 2;
+    const int score_row = (attacker == "circle") ? top_score_row() : bottom_score_row(rows);
+    const int outward = (attacker == "circle") ? -1 : 1;
+    const int left = score_cols.front() - 1;
+    const int top = std::min(score_row - 1, score_row + 1);
+    if (zone_cols * ZONE_ROWS > MAX_CELLS || left < 0 || left + zone_cols > cols)
+        return -1;
+
+    for (int y = top - 1; y <= top + ZONE_ROWS; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            bool in_rows = y >= top && y < top + ZONE_ROWS;
+            bool in_cols = x >= left && x < left + zone_cols;
+            if (!in_bounds(x, y, rows, cols) || (in_rows && in_cols))
+                continue;
+            const Cell &cell = board[y][x];
+            bool ring = x >= left - 1 && x <= left + zone_cols;
+            if ((ring && !cell.isEmpty()) || (in_rows && cell.side == "river"))
+                return -1;
+        }
+    }
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = left; x < left + zone_cols; x++)
+        {
+            if ((y < top || y >= top + ZONE_ROWS) && board[y][x].side == "river")
+                return -1;
+        }
+    }
+
+    ZoneSpec spec{width, 0, 0, 0};
+    uint8_t grid[MAX_CELLS];
+    for (int zr = 0; zr < ZONE_ROWS; zr++)
+    {
+        int y = score_row + outward * (SCORE_ROW - zr);
+        for (int zc = 0; zc < zone_cols; zc++)
+        {
+            const Cell &cell = board[y][left + zc];
+            uint8_t &p = grid[zr * zone_cols + zc];
+            if (cell.isEmpty())
+            {
+                p = EMPTY;
+                continue;
+            }
+            int side = (cell.owner == attacker) ? ATTACKER : DEFENDER;
+            if (cell.side == "stone")
+            {
+                if (side == ATTACKER && spec.is_score_cell(zr * zone_cols + zc))
+                {
+                    p = FROZEN;
+                    spec.mask |= 1 << (zc - 1);
+                    continue;
+                }
+                p = stone_of(side);
+            }
+            else
+            {
+                p = river_of(side, cell.orientation == "horizontal");
+            }
+            (side == ATTACKER ? spec.na : spec.nd)++;
+        }
+    }
+    if (spec.na < spec.free_score_cells())
+        return -1;
+    return tablebase.probe(spec, grid, to_move == attacker ? ATTACKER : DEFENDER);
+}
+
+double StudentAgent::probe_tablebases(
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &to_move,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    const double WIN_SCORE = 1e15;
+    const double PLY_COST = 1e11;
+
+    int mine = probe_goal_zone(board, player, to_move, rows, cols, score_cols);
+    int theirs = probe_goal_zone(board, opponent, to_move, rows, cols, score_cols);
+    bool my_win = mine >= 1;
+    bool their_win = theirs >= 1;
+    if (my_win && their_win)
+    {
+        if (mine != theirs)
+            their_win = !(my_win = mine < theirs);
+        else
+            their_win = !(my_win = to_move == player);
+    }
+    if (my_win)
+        return WIN_SCORE - (mine - 1) * PLY_COST;
+    if (their_win)
+        return -WIN_SCORE + (theirs - 1) * PLY_COST;
+    return 0.0;
+}
+
+void StudentAgent::order_moves(
+    std::vector<std::unordered_map<std::string, std::string>> &moves,
+    const std::vector<std::vector<Cell>> &board,
+    const std::string &mover,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    bool push_outcomes)
+{
+    auto threats = analyse_threats(board, get_opponent(mover), rows, cols, score_cols);
+    // Goal fields for the push outcomes, built on the first push
+    std::optional<GoalFields> fields;
+    std::vector<std::pair<int, size_t>> keys;
+    keys.reserve(moves.size());
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        const auto &m = moves[i];
+        int key = 0;
+        const std::string &action = m.at("action");
+        if (action == "move" || action == "push")
+        {
+            int fx = std::stoi(m.at("from_x")), fy = std::stoi(m.at("from_y"));
+            int tx = std::stoi(m.at("to_x")), ty = std::stoi(m.at("to_y"));
+            if (board[fy][fx].side == "stone")
+            {
+                key = pattern_distance(board, tx, ty, mover, rows, cols, score_cols) -
+                      pattern_distance(board, fx, fy, mover, rows, cols, score_cols);
+                if (threats->is_cut(tx, ty))
+                    key -= 2;
+            }
+            if (push_outcomes && action == "push" && board[ty][tx].side == "stone")
+            {
+                if (!fields)
+                    fields.emplace(board, rows, cols, score_cols);
+                PushOutcome push = evaluate_push(board, m, *fields, rows, cols, score_cols);
+                bool theirs = board[ty][tx].owner != mover;
+                key += theirs ? push.pushed_gain : -push.pushed_gain;
+                if (push.scores)
+                    key -= 4;
+            }
+        }
+        keys.push_back({key, i});
+    }
+    std::stable_sort(keys.begin(), keys.end(),
+                     [](const auto &a, const auto &b)
+                     { return a.first < b.first; });
+
+    std::vector<std::unordered_map<std::string, std::string>> ordered;
+    ordered.reserve(moves.size());
+    for (const auto &[key, i] : keys)
+        ordered.push_back(std::move(moves[i]));
+    moves = std::move(ordered);
+}
+
+double StudentAgent::minimax(
+    const std::vector<std::vector<Cell>> &board,
+    int depth,
+    double alpha,
+    double beta,
+    bool is_maximizing,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    Extension extension)
+{
+    // Helpers of a split search enter here on their own threads
+    ThreatCacheScope threat_scope(threat_account.get());
+
+    // Per thread: split searches count their own nodes
+    static thread_local long long search_nodes = 0;
+    if ((deadline_armed || pondering) && (++search_nodes & 255) == 0 &&
+        ((pondering && stop_flag->load(std::memory_order_relaxed)) ||
+         (deadline_armed && std::chrono::steady_clock::now() > search_deadline)))
+        search_aborted = true;
+    if (search_aborted)
+        return 0.0;
+    if (SplitPoint *sp = SearchThreads::current(); sp && sp->stopped())
+        return 0.0;
+
+    // Transposition table (MTD(f) driver only): a stored bound may settle
+    // the node or narrow its window, and its best move is searched first.
+    // The extension state is part of the key: the same position and depth
+    // reached with other units or plies collected searches a different tree.
+    // Piece 0 is never on the board, so its keys are free for this; units
+    // stay far below MAX_BOARD_CELLS / (EXTENSION_MAX_PLIES + 1).
+    uint64_t tt_key = 0;
+    int tt_best = -1;
+    if (transpositions)
+    {
+        tt_key = board_hash(board, rows, cols) ^ (is_maximizing ? zobrist_key(1, 0) : 0);
+        if (extension.units || extension.plies)
+            tt_key ^= zobrist_key(2 + extension.plies + (EXTENSION_MAX_PLIES + 1) * extension.units, 0);
+        TranspositionTable::Entry entry;
+        if (transpositions->probe(tt_key, entry))
+        {
+            if (entry.depth == depth)
+            {
+                if (entry.lower >= beta)
+                    return entry.lower;
+                if (entry.upper <= alpha || entry.lower == entry.upper)
+                    return entry.upper;
+                alpha = std::max(alpha, entry.lower);
+                beta = std::min(beta, entry.upper);
+            }
+            // From any depth: shallower iterations still order moves well
+            tt_best = entry.best;
+        }
+    }
+    double tt_alpha = alpha, tt_beta = beta;
+    auto remember = [&](double value, int best_index)
+    {
+        SplitPoint *sp = SearchThreads::current();
+        if (transpositions && !search_aborted && !(sp && sp->stopped()))
+            transpositions->store(tt_key, depth, tt_alpha, tt_beta, value, best_index);
+        return value;
+    };
+
+    std::string winner = check_win(board, rows, cols, score_cols);
+    if (winner.empty() && !tablebase.empty())
+    {
+        double tb_score = probe_tablebases(board, is_maximizing ? player : opponent, rows, cols, score_cols);
+        if (tb_score != 0.0)
+            return remember(tb_score, -1);
+    }
+    if (depth == 0 || !winner.empty())
+    {
+        return remember(evaluate_board(board, player, rows, cols, score_cols), -1);
+    }
+
+    // ProbCut: the shallow search's prediction, if far enough outside the
+    // window, stands in for this node's search
+    if (probcut_threshold > 0.0 && (std::isfinite(alpha) || std::isfinite(beta)))
+    {
+        if (const ProbCut::Fit *fit = ProbCut::fit_for(rows, cols, depth, ProbCut::phase(board, rows, cols, score_cols)))
+        {
+            double margin = probcut_threshold * fit->sigma;
+            double high = (beta + margin - fit->b) / fit->a;
+            double low = (alpha - margin - fit->b) / fit->a;
+            double shallow = minimax(board, depth - ProbCut::GAP, low, high, is_maximizing, rows, cols, score_cols,
+                                     extension);
+            if (shallow >= high)
+                return beta;
+            if (shallow <= low)
+                return alpha;
+        }
+    }
+
+    std::string current_player = is_maximizing ? player : opponent;
+    auto moves = generate_all_valid_moves(board, current_player, rows, cols, score_cols);
+
+    if (moves.empty())
+    {
+        return remember(evaluate_board(board, player, rows, cols, score_cols), -1);
+    }
+    order_moves(moves, board, current_player, rows, cols, score_cols, depth >= PUSH_ORDERING_DEPTH);
+    int rotated = 0;
+    if (tt_best > 0 && tt_best < static_cast<int>(moves.size()))
+    {
+        std::rotate(moves.begin(), moves.begin() + tt_best, moves.begin() + tt_best + 1);
+        rotated = tt_best;
+    }
+    if (search_threads && depth >= YBWC_MIN_SPLIT_DEPTH && moves.size() > 1)
+        return remember(split_search(board, moves, depth, alpha, beta, is_maximizing, rows, cols, score_cols,
+                                     extension),
+                        -1);
+
+    // Children of a frontier node are only evaluated, so they share one copy
+    // of this board; deeper children need their own.
+    std::optional<SiblingBoards> siblings;
+    if (depth == 1)
+        siblings.emplace(board);
+    auto child_score = [&](const std::unordered_map<std::string, std::string> &move, double a, double b)
+    {
+        Extension child;
+        int next = child_depth(depth, extension, board, move, current_player, moves.size(), rows, cols,
+                               score_cols, child);
+        if (siblings && next == 0)
+        {
+            const auto &child_board = siblings->child(move);
+            if constexpr (VERIFY_STATE)
+            {
+                if (verify_due())
+                    verify_child(board, move, current_player, child_board, rows, cols, score_cols);
+            }
+            return minimax(child_board, 0, a, b, !is_maximizing, rows, cols, score_cols, child);
+        }
+        auto child_board = apply_move(board, move, current_player, rows, cols, score_cols);
+        if constexpr (VERIFY_STATE)
+        {
+            if (verify_due())
+                verify_child(board, move, current_player, child_board, rows, cols, score_cols);
+        }
+        return minimax(child_board, next, a, b, !is_maximizing, rows, cols, score_cols, child);
+    };
+
+    // The TT remembers the best move by its index in order_moves' order
+    int best_index = -1;
+    auto ordered_index = [&](int i)
+    { return (i > rotated) ? i : (i == 0 ? rotated : i - 1); };
+    if (is_maximizing)
+    {
+        double max_eval = -std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            double eval_score = child_score(moves[i], alpha, beta);
+            if (eval_score > max_eval)
+                best_index = static_cast<int>(i);
+            max_eval = std::max(max_eval, eval_score);
+            alpha = std::max(alpha, eval_score);
+            if (beta <= alpha)
+                break;
+        }
+        return remember(max_eval, best_index < 0 ? -1 : ordered_index(best_index));
+    }
+    else
+    {
+        double min_eval = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            double eval_score = child_score(moves[i], alpha, beta);
+            if (eval_score < min_eval)
+                best_index = static_cast<int>(i);
+            min_eval = std::min(min_eval, eval_score);
+            beta = std::min(beta, eval_score);
+            if (beta <= alpha)
+                break;
+        }
+        return remember(min_eval, best_index < 0 ? -1 : ordered_index(best_index));
+    }
+}
+
+double StudentAgent::split_search(
+    const std::vector<std::vector<Cell>> &board,
+    const std::vector<std::unordered_map<std::string, std::string>> &moves,
+    int depth,
+    double alpha,
+    double beta,
+    bool is_maximizing,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    const Extension &extension)
+{
+    const std::string &mover = is_maximizing ? player : opponent;
+    auto search_child = [&](size_t i, double a, double b)
+    {
+        Extension child;
+        int next = child_depth(depth, extension, board, moves[i], mover, moves.size(), rows, cols, score_cols, child);
+        auto child_board = apply_move(board, moves[i], mover, rows, cols, score_cols);
+        if constexpr (VERIFY_STATE)
+        {
+            if (verify_due())
+                verify_child(board, moves[i], mover, child_board, rows, cols, score_cols);
+        }
+        return minimax(child_board, next, a, b, !is_maximizing, rows, cols, score_cols, child);
+    };
+
+    double best = search_child(0, alpha, beta);
+    if (is_maximizing)
+        alpha = std::max(alpha, best);
+    else
+        beta = std::min(beta, best);
+    if (beta <= alpha || search_aborted)
+        return best;
+
+    SplitPoint sp;
+    sp.maximizing = is_maximizing;
+    sp.count = moves.size();
+    sp.search_child = search_child;
+    sp.alpha = alpha;
+    sp.beta = beta;
+    sp.best = best;
+    search_threads->run(sp);
+    return sp.best;
+}
+
+int extension_units(const std::vector<std::vector<Cell>> &board,
+                    const std::unordered_map<std::string, std::string> &move,
+                    const std::string &mover,
+                    int rows, int cols,
+                    const std::vector<int> &score_cols)
+{
+    const std::string &action = move.at("action");
+    if (action != "move" && action != "push")
+        return 0;
+    int fx = std::stoi(move.at("from_x")), fy = std::stoi(move.at("from_y"));
+    int tx = std::stoi(move.at("to_x")), ty = std::stoi(move.at("to_y"));
+    auto next_to_goal = [&](int x, int y, const std::string &owner)
+    {
+        for (auto [dx, dy] : {std::pair{1, 0}, {-1, 0}, {0, 1}, {0, -1}})
+        {
+            if (is_my_score_cell(x + dx, y + dy, owner, rows, cols, score_cols))
+                return true;
+        }
+        return false;
+    };
+
+    int units = 0;
+    if (board[fy][fx].side == "stone")
+    {
+        if (is_my_score_cell(tx, ty, mover, rows, cols, score_cols))
+        {
+            if (!is_my_score_cell(fx, fy, mover, rows, cols, score_cols))
+                units += EXTEND_SCORE_ENTRY;
+        }
+        else if (next_to_goal(tx, ty, mover))
+        {
+            units += EXTEND_GOAL_ADJACENT;
+        }
+    }
+    // Only an own stone can be pushed onto or off its score cells: movegen
+    // never lets the pusher onto, nor a pushed piece into, the cells the
+    // opponent scores on, which are where an opponent stone would have to be
+    if (action == "push" && board[ty][tx].side == "stone" && board[ty][tx].owner == mover)
+    {
+        int px = std::stoi(move.at("pushed_x")), py = std::stoi(move.at("pushed_y"));
+        bool was_home = is_my_score_cell(tx, ty, mover, rows, cols, score_cols);
+        bool is_home = is_my_score_cell(px, py, mover, rows, cols, score_cols);
+        if (was_home && !is_home)
+            units += EXTEND_SCORE_EJECT;
+        else if (!was_home && is_home)
+            units += EXTEND_SCORE_ENTRY;
+    }
+    return units;
+}
+
+int StudentAgent::child_depth(
+    int depth,
+    const Extension &extension,
+    const std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    const std::string &mover,
+    size_t siblings,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    Extension &child) const
+{
+    child = extension;
+    if (!extensions_enabled || child.plies >= EXTENSION_MAX_PLIES)
+        return depth - 1;
+    child.units += extension_units(board, move, mover, rows, cols, score_cols);
+    if (siblings == 1)
+        child.units += EXTEND_SINGLE_REPLY;
+    if (child.units < PLY_UNITS)
+        return depth - 1;
+    child.units -= PLY_UNITS;
+    child.plies++;
+    return depth;
+}
+
+int StudentAgent::repeat_count(const std::unordered_map<std::string, std::string> &m) const
+{
+    int count = 0;
+    for (const auto &past : last_moves)
+    {
+        if (past.at("action") == m.at("action") && past.at("from_x") == m.at("from_x") &&
+            past.at("from_y") == m.at("from_y") && past.count("to_x") == m.count("to_x") &&
+            (!m.count("to_x") || (past.at("to_x") == m.at("to_x") && past.at("to_y") == m.at("to_y"))) &&
+            past.count("orientation") == m.count("orientation") &&
+            (!m.count("orientation") || past.at("orientation") == m.at("orientation")))
+            count++;
+    }
+    return count;
+}
+
+std::unordered_map<std::string, std::string> StudentAgent::choose_instant(
+    const std::vector<std::vector<Cell>> &board,
+    const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    int score_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
+    size_t best = 0;
+    int best_key = std::numeric_limits<int>::min();
+    for (size_t i = 0; i < valid_moves.size(); i++)
+    {
+        const auto &m = valid_moves[i];
+        int key = -rows; // flips and rotates only when nothing advances
+        if (m.count("to_x"))
+        {
+            int fx = std::stoi(m.at("from_x")), fy = std::stoi(m.at("from_y"));
+            int tx = std::stoi(m.at("to_x")), ty = std::stoi(m.at("to_y"));
+            if (board[fy][fx].side == "stone")
+            {
+                key = std::abs(fy - score_row) - std::abs(ty - score_row);
+                if (is_my_score_cell(tx, ty, player, rows, cols, score_cols))
+                    key += 2 * rows;
+            }
+        }
+        if (repeat_count(m) > repetition_limit)
+            key -= 4 * rows;
+        if (key > best_key)
+        {
+            best_key = key;
+            best = i;
+        }
+    }
+    return valid_moves[best];
+}
+
+std::unordered_map<std::string, std::string> StudentAgent::choose_greedy(
+    const std::vector<std::vector<Cell>> &board,
+    const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+    int rows, int cols,
+    const std::vector<int> &score_cols)
+{
+    static constexpr size_t TACTICAL_CANDIDATES = 6;
+    GoalFields fields(board, rows, cols, score_cols);
+    const auto &mine = fields.of(player);
+    const int FAR = rows * cols;
+    auto field = [&](const std::vector<int> &f, int x, int y)
+    { return std::min(f[y * cols + x], FAR); };
+
+    std::vector<std::pair<int, size_t>> ranked;
+    ranked.reserve(valid_moves.size());
+    for (size_t i = 0; i < valid_moves.size(); i++)
+    {
+        const auto &m = valid_moves[i];
+        int score = -1;
+        if (m.count("to_x"))
+        {
+            int fx = std::stoi(m.at("from_x")), fy = std::stoi(m.at("from_y"));
+            int tx = std::stoi(m.at("to_x")), ty = std::stoi(m.at("to_y"));
+            bool enters = board[fy][fx].side == "stone" &&
+                          is_my_score_cell(tx, ty, player, rows, cols, score_cols) &&
+                          !is_my_score_cell(fx, fy, player, rows, cols, score_cols);
+            if (m.count("pushed_x"))
+            {
+                PushOutcome push = evaluate_push(board, m, fields, rows, cols, score_cols);
+                bool theirs = board[ty][tx].owner == opponent;
+                score = 10 * push.pusher_gain + 5 * (theirs ? -push.pushed_gain : push.pushed_gain);
+                if (enters || push.scores)
+                    score += 1000;
+            }
+            else if (board[fy][fx].side == "stone")
+            {
+                score = 10 * (field(mine, fx, fy) - field(mine, tx, ty));
+                if (enters)
+                    score += 1000;
+            }
+        }
+        if (repeat_count(m) > repetition_limit)
+            score -= 2000;
+        ranked.push_back({score, i});
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto &a, const auto &b)
+                     { return a.first > b.first; });
+
+    int win_count = get_win_count(cols);
+    int opp_score_row = (player == "circle") ? bottom_score_row(rows) : top_score_row();
+    size_t limit = std::min(TACTICAL_CANDIDATES, ranked.size());
+    for (size_t k = 0; k < limit; k++)
+    {
+        const auto &m = valid_moves[ranked[k].second];
+        auto next = apply_move(board, m, player, rows, cols, score_cols);
+        std::string winner = check_win(next, rows, cols, score_cols);
+        if (winner == player)
+            return m;
+
+        int opp_scoring = 0;
+        for (int x : score_cols)
+        {
+            const Cell &cell = next[opp_score_row][x];
+            if (cell.owner == opponent && cell.side == "stone")
+                opp_scoring++;
+        }
+        if (opp_scoring + 1 < win_count)
+            return m;
+
+        bool loses = false;
+        for (const auto &reply : generate_all_valid_moves(next, opponent, rows, cols, score_cols))
+        {
+            if (check_win(apply_move(next, reply, opponent, rows, cols, score_cols), rows, cols, score_cols) == opponent)
+            {
+                loses = true;
+                break;
+            }
+        }
+        if (!loses)
+            return m;
+    }
+    return valid_moves[ranked.front().second];
+}
+
+double StudentAgent::score_root_move(
+    const std::vector<std::vector<Cell>> &board,
+    const std::unordered_map<std::string, std::string> &move,
+    int depth,
+    double alpha,
+    double beta,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    const std::vector<RiverOpportunity> &river_opportunities,
+    const std::vector<RiverOpportunity> &defensive_rivers)
+{
+    ThreatCacheScope threat_scope(threat_account.get());
+    auto new_board = apply_move(board, move, player, rows, cols, score_cols);
+    Extension child;
+    int next = child_depth(depth, Extension(), board, move, player, 0, rows, cols, score_cols, child);
+    double score = minimax(new_board, next, alpha, beta, false, rows, cols, score_cols, child);
+    return add_root_bonuses(score, board, new_board, move, rows, cols, score_cols,
+                            river_opportunities, defensive_rivers);
+}
+
+double StudentAgent::add_root_bonuses(
+    double score,
+    const std::vector<std::vector<Cell>> &board,
+    const std::vector<std::vector<Cell>> &new_board,
+    const std::unordered_map<std::string, std::string> &move,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    const std::vector<RiverOpportunity> &river_opportunities,
+    const std::vector<RiverOpportunity> &defensive_rivers)
+{
+    auto my_goals = get_my_goal_cells(rows, cols, score_cols);
+
+    // Count current scoring stones for urgency multiplier
+    int my_scoring_count = 0;
+    for (int x : score_cols)
+    {
+        int my_score_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
+        const Cell &cell = new_board[my_score_row][x];
+        if (!cell.isEmpty() && cell.owner == player && cell.side == "stone")
+        {
+            my_scoring_count++;
+        }
+    }
+    // Urgency multiplier: 3 stones = push HARD for 4th!
+    double urgency = 2.0 + my_scoring_count;
+
+    std::string action = move.at("action");
+    int from_x = std::stoi(move.at("from_x"));
+    int from_y = std::stoi(move.at("from_y"));
+
+    // RIVER PUSH - very valuable for advancing multiple spaces
+    if (action == "push" && move.count("pushed_x"))
+    {
+        int to_x = std::stoi(move.at("to_x"));
+        int to_y = std::stoi(move.at("to_y"));
+        int pushed_x = std::stoi(move.at("pushed_x"));
+        int pushed_y = std::stoi(move.at("pushed_y"));
+
+        auto dist_before = astar_distance_to_goals(board, from_x, from_y, my_goals, player, rows, cols, score_cols);
+        auto dist_after = astar_distance_to_goals(new_board, to_x, to_y, my_goals, player, rows, cols, score_cols);
+        double improvement = dist_before.distance - dist_after.distance;
+
+        int push_dist = std::abs(to_x - pushed_x) + std::abs(to_y - pushed_y);
+        if (push_dist > 1)
+        { // River push
+            score += push_dist * 1000.0;
+
+            // Extra bonus if pushed piece gets close to goal
+            if (is_my_score_cell(pushed_x, pushed_y, player, rows, cols, score_cols))
+            {
+                score += 1e14; // Pushed directly into goal!
+            }
+            else
+            {
+                const Cell &piece = board[from_y][from_x];
+                if (!piece.isEmpty() && piece.side == "stone")
+                {
+                    auto dist_after = astar_distance_to_goals(new_board, pushed_x, pushed_y, my_goals, player, rows, cols, score_cols);
+                    if (dist_after.distance < 3)
+                    {
+                        score += 80000000.0;
+                    }
+                }
+            }
+        }
+        else
+        {
+            auto my_goals = get_my_goal_cells(rows, cols, score_cols);
+            score += (dist_before.distance == 0 || (std::find(my_goals.begin(), my_goals.end(), Position(to_x, to_y)) != my_goals.end() && std::find(my_goals.begin(), my_goals.end(), Position(pushed_x, pushed_y)) == my_goals.end())) ? 1000 : std::pow(2, 35.0 - std::min(dist_after.distance, 35.0)) * 1000.0;
+        }
+    }
+    // RIVER MOVEMENT - bonus for using rivers to advance
+    else if (action == "move" && move.count("to_x"))
+    {
+        int to_x = std::stoi(move.at("to_x"));
+        int to_y = std::stoi(move.at("to_y"));
+        int move_dist = std::abs(from_x - to_x) + std::abs(from_y - to_y);
+
+        const Cell &piece = board[from_y][from_x];
+        if (!piece.isEmpty() && piece.side == "stone")
+        {
+            // Calculate BFS distance improvement
+            auto dist_before = astar_distance_to_goals(board, from_x, from_y, my_goals, player, rows, cols, score_cols);
+            auto dist_after = astar_distance_to_goals(new_board, to_x, to_y, my_goals, player, rows, cols, score_cols);
+            double improvement = dist_before.distance - dist_after.distance;
+
+            if (move_dist > 1)
+            { // Used river to move
+                // score += move_dist * 200.0;  // Reward river usage
+                // score += std::pow(improvement, 3) * 100000.0;  // Reward progress toward goal
+                score += dist_before.distance == 0 ? 100 : std::pow(2, 35.0 - std::min(dist_after.distance, 35.0)) * 1000.0;
+                if (dist_after.distance == 0 && dist_before.distance > 0)
+            {
+                score += 1e14;
+            }
+            else if (dist_after.distance == 1 && dist_before.distance > 1)
+            {
+                score += 1e12;
+            }
+            else if (dist_after.distance == 2 && dist_before.distance > 2)
+            {
+                score += 1e11;
+            }
+            else if (dist_after.distance == 3 && dist_before.distance > 3)
+            {
+                score += 1e10;
+            }
+            else if (dist_after.distance == 4 && dist_before.distance > 4)
+            {
+                score += 1e9;
+            }
+            else if (dist_after.distance == 5 && dist_before.distance > 5)
+            {
+                score += 1e8;
+            }
+            }
+            else
+            { // Regular 1-step move
+                score += dist_before.distance == 0 ? 100 : std::pow(2, 35.0 - std::min(dist_after.distance, 35.0)) * 500.0;
+                // if (dist_after.distance <= 2) {
+                //     score += 50000.0;
+                // }
+                if (dist_after.distance == 0 && dist_before.distance > 0)
+            {
+                score += 1e14;
+            }
+            else if (dist_after.distance == 1 && dist_before.distance > 1)
+            {
+                score += 1e11;
+            }
+            else if (dist_after.distance == 2 && dist_before.distance > 2)
+            {
+                score += 1e10;
+            }
+            else if (dist_after.distance == 3 && dist_before.distance > 3)
+            {
+                score += 1e9;
+            }
+            else if (dist_after.distance == 4 && dist_before.distance > 4)
+            {
+                score += 1e7;
+            }
+            else if (dist_after.distance == 5 && dist_before.distance > 5)
+            {
+                score += 1e6;
+            }
+            }
+            // Extra bonus if move gets us into scoring position
+            // if (dist_after.distance == 0 && dist_before.distance > 0)
+            // {
+            //     score += 1e14;
+            // }
+            // else if (dist_after.distance == 1 && dist_before.distance > 1)
+            // {
+            //     score += 1e12;
+            // }
+            // else if (dist_after.distance == 2 && dist_before.distance > 2)
+            // {
+            //     score += 1e11;
+            // }
+            // else if (dist_after.distance == 3 && dist_before.distance > 3)
+            // {
+            //     score += 1e10;
+            // }
+            // else if (dist_after.distance == 4 && dist_before.distance > 4)
+            // {
+            //     score += 1e8;
+            // }
+            // else if (dist_after.distance == 5 && dist_before.distance > 5)
+            // {
+            //     score += 1e6;
+            // }
+            if (dist_after.distance == 6 && dist_before.distance > 6) {
+                score += 1e3;
+            }
+            else if (dist_after.distance == 7 && dist_before.distance > 7) {
+                score += 1e2;
+            }
+            else if (dist_after.distance == 8 && dist_before.distance > 8) {
+                score += 1e1;
+            }
+        }
+    }
+    // FLIP TO RIVER - strategic value
+    else if (action == "flip" && move.count("orientation"))
+    {
+        std::string orientation = move.at("orientation");
+
+        // Check if this flip is in our strategic opportunities
+        for (size_t i = 0; i < std::min(size_t(3), river_opportunities.size()); i++)
+        {
+            const auto &opp = river_opportunities[i];
+            if (opp.from_x == from_x && opp.from_y == from_y && opp.orientation == orientation)
+            {
+                score += opp.value;
+                break;
+            }
+        }
+
+        // Check if this flip is defensive
+        for (size_t i = 0; i < std::min(size_t(4), defensive_rivers.size()); i++)
+        {
+            const auto &def = defensive_rivers[i];
+            if (def.from_x == from_x && def.from_y == from_y && def.orientation == orientation)
+            {
+                score += def.value;
+                break;
+            }
+        }
+
+        // General bonus for creating rivers in forward positions
+        const Cell &piece = board[from_y][from_x];
+        if (!piece.isEmpty())
+        {
+            int my_score_row = my_goals[0].y;
+            if (std::abs(from_y - my_score_row) <= 4)
+            { // Near goal area
+                score += 3000.0;
+            }
+        }
+    }
+    // ROTATE RIVER - adjust flow direction
+    else if (action == "rotate")
+    {
+        score += 1000.0;
+    }
+    return score;
+}
+
+StudentAgent::RootResult StudentAgent::search_root(
+    const std::vector<std::vector<Cell>> &board,
+    const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+    int depth,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    const std::vector<RiverOpportunity> &river_opportunities,
+    const std::vector<RiverOpportunity> &defensive_rivers)
+{
+    ThreatCacheScope threat_scope(threat_account.get());
+    RootResult result;
+    double alpha = -std::numeric_limits<double>::infinity();
+    double beta = std::numeric_limits<double>::infinity();
+
+    for (const auto &move : valid_moves)
+    {
+        double score = score_root_move(board, move, depth, alpha, beta, rows, cols, score_cols,
+                                       river_opportunities, defensive_rivers);
+        if (search_aborted)
+            break;
+
+        // Track best moves
+        if (score > result.best_score)
+        {
+            result.second_score = result.best_score;
+            result.best_score = score;
+            result.best = {move};
+        }
+        else if (std::abs(score - result.best_score) < 100.0)
+        { // Similar scores
+            result.best.push_back(move);
+        }
+        else
+        {
+            result.second_score = std::max(result.second_score, score);
+        }
+
+        alpha = std::max(alpha, score);
+    }
+    return result;
+}
+
+StudentAgent::RootResult StudentAgent::search_root_mtdf(
+    const std::vector<std::vector<Cell>> &board,
+    const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+    int depth,
+    double guess,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    const std::vector<RiverOpportunity> &river_opportunities,
+    const std::vector<RiverOpportunity> &defensive_rivers)
+{
+    ThreatCacheScope threat_scope(threat_account.get());
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<std::vector<Cell>>> children;
+    std::vector<double> bonus;
+    std::vector<int> child_depths;
+    std::vector<Extension> extensions(valid_moves.size());
+    children.reserve(valid_moves.size());
+    for (const auto &move : valid_moves)
+    {
+        child_depths.push_back(child_depth(depth, Extension(), board, move, player, 0, rows, cols, score_cols,
+                                           extensions[child_depths.size()]));
+        children.push_back(apply_move(board, move, player, rows, cols, score_cols));
+        bonus.push_back(add_root_bonuses(0.0, board, children.back(), move, rows, cols, score_cols,
+                                         river_opportunities, defensive_rivers));
+    }
+
+    double lower = -INF, upper = INF;
+    double g = std::isfinite(guess) ? guess : 0.0;
+    size_t best = 0;
+    for (int pass = 0; lower < upper; pass++)
+    {
+        if (pass == MTDF_MAX_PASSES)
+        {
+            // Bonus rounding kept the bounds from meeting
+            return search_root(board, valid_moves, depth, rows, cols, score_cols,
+                               river_opportunities, defensive_rivers);
+        }
+
+        // Is the root worth at least gamma? Each child gets the zero window
+        // that asks the same of its score before its bonus.
+        double gamma = (g == lower) ? std::nextafter(g, INF) : g;
+        bool high = false;
+        double pass_score = -INF;
+        size_t pass_best = 0;
+        for (size_t i = 0; i < valid_moves.size(); i++)
+        {
+            double child_beta = gamma - bonus[i];
+            double score = minimax(children[i], child_depths[i], std::nextafter(child_beta, -INF), child_beta,
+                                   false, rows, cols, score_cols, extensions[i]);
+            if (search_aborted)
+                return RootResult();
+            // The bonus the window was set from, not a fresh sum
+            score += bonus[i];
+            if (score > pass_score)
+            {
+                pass_score = score;
+                pass_best = i;
+            }
+            if (score >= gamma)
+            {
+                high = true;
+                break;
+            }
+        }
+
+        g = pass_score;
+        if (high)
+        {
+            lower = g;
+            best = pass_best;
+        }
+        else
+        {
+            upper = g;
+        }
+    }
+
+    // Zero-window passes leave the other moves' scores unknown, so no
+    // second score: the time manager never sees a dominant move.
+    RootResult result;
+    result.best = {valid_moves[best]};
+    result.best_score = lower;
+    result.second_score = lower;
+    return result;
+}
+
+bool StudentAgent::ponder(
+    const PyBoard &py_board,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    double current_player_time,
+    double opponent_time)
+{
+    return ponder_board(from_py_board(py_board, rows, cols), rows, cols, score_cols,
+                        current_player_time, opponent_time);
+}
+
+bool StudentAgent::ponder_board(
+    const std::vector<std::vector<Cell>> &board,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    double current_player_time,
+    double opponent_time)
+{
+    ponder_result.valid = false;
+    ponder_stop = false;
+    if (!check_win(board, rows, cols, score_cols).empty())
+        return false;
+
+    // The predictor skips the book (we cannot know how far into it the
+    // opponent is) and stops after its first iteration.
+    StudentAgent predictor(opponent);
+    predictor.moves = std::numeric_limits<int>::max();
+    predictor.pondering = true;
+    predictor.stop_flag = &ponder_stop;
+    predictor.set_move_time_cap(FIRST_ITERATION_CAP);
+    Move predicted = predictor.choose_board(board, rows, cols, score_cols, opponent_time, current_player_time);
+    if (ponder_stop.load() || predicted.action.empty())
+        return false;
+    auto replies = generate_all_valid_moves(board, opponent, rows, cols, score_cols);
+    auto match = find_move(replies, predicted);
+    if (!match)
+        return false;
+    auto next = apply_move(board, *match, opponent, rows, cols, score_cols);
+    if (!check_win(next, rows, cols, score_cols).empty())
+        return false;
+
+    // Search as if it were our move, then roll back everything choose()
+    // records so a miss leaves no trace.
+    auto saved_last_moves = last_moves;
+    int saved_moves = moves;
+    size_t saved_history = move_history.size();
+    pondering = true;
+    Move reply = choose_board(next, rows, cols, score_cols, current_player_time, opponent_time);
+    pondering = false;
+
+    if (!ponder_stop.load() && move_history.size() > saved_history)
+    {
+        ponder_result.hash = board_hash(next, rows, cols);
+        ponder_result.move = reply;
+        ponder_result.last_moves = last_moves;
+        ponder_result.moves = moves;
+        ponder_result.stats = move_history.back();
+        ponder_result.valid = true;
+    }
+    last_moves = std::move(saved_last_moves);
+    moves = saved_moves;
+    move_history.resize(saved_history);
+    return ponder_result.valid;
+}
+
+// The scripted opening, the same on every board size: push the outer stones
+// of the start formation (standard_start_board()) one row forward, turning
+// the inner one beside the first into a river, and lay a river along the
+// front row from the board's edge. Empty where an outer stone stands in a
+// score column: its push would end on the opponent's score row, which the
+// rules forbid.
+static std::vector<std::unordered_map<std::string, std::string>> opening_book_for(
+    const std::string &player, int rows, int cols, const std::vector<int> &score_cols)
+{
+    int per_row = cols / 2;
+    int first = (cols - per_row) / 2, last = first + per_row - 1;
+    bool square = player == "square";
+    int back = square ? 4 : rows - 5, front = square ? 3 : rows - 4, beyond = square ? 2 : rows - 3;
+    if (is_opponent_score_cell(first, beyond, player, rows, cols, score_cols) ||
+        is_opponent_score_cell(last, beyond, player, rows, cols, score_cols))
+        return {};
+    auto s = [](int v)
+    { return std::to_string(v); };
+    return {
+        {{"action", "push"}, {"from_x", s(first)}, {"from_y", s(back)}, {"to_x", s(first)}, {"to_y", s(front)}, {"pushed_x", s(first)}, {"pushed_y", s(beyond)}},
+        {{"action", "flip"}, {"from_x", s(first + 1)}, {"from_y", s(front)}, {"orientation", "horizontal"}},
+        {{"action", "move"}, {"from_x", s(first)}, {"from_y", s(front)}, {"to_x", "0"}, {"to_y", s(front)}},
+        {{"action", "push"}, {"from_x", s(last)}, {"from_y", s(back)}, {"to_x", s(last)}, {"to_y", s(front)}, {"pushed_x", s(last)}, {"pushed_y", s(beyond)}},
+        {{"action", "flip"}, {"from_x", "0"}, {"from_y", s(front)}, {"orientation", "vertical"}},
+    };
+}
+
+Move StudentAgent::choose(
+    const std::vector<std::vector<std::unordered_map<std::string, std::string>>> &py_board,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    double current_player_time,
+    double opponent_time)
+{
+    return choose_board(from_py_board(py_board, rows, cols), rows, cols, score_cols,
+                        current_player_time, opponent_time);
+}
+
+Move StudentAgent::choose_board(
+    const std::vector<std::vector<Cell>> &board,
+    int rows, int cols,
+    const std::vector<int> &score_cols,
+    double current_player_time,
+    double opponent_time)
+{
+    clear_bfs_cache();
+    ThreatCacheScope threat_scope(threat_account.get());
+
+    if (ponder_result.valid)
+    {
+        PonderResult hit = std::move(ponder_result);
+        ponder_result.valid = false;
+        if (!pondering && board_hash(board, rows, cols) == hit.hash)
+        {
+            last_moves = std::move(hit.last_moves);
+            moves = hit.moves;
+            hit.stats.move_number = static_cast<int>(move_history.size()) + 1;
+            hit.stats.mode = "ponder";
+            move_history.push_back(hit.stats);
+            return hit.move;
+        }
+    }
+
+    TimeManager clock(current_player_time, opponent_time,
+                      detect_game_phase(board, player, rows, cols, score_cols), get_win_count(cols),
+                      move_time_cap);
+    SpeedMode mode = select_speed_mode(current_player_time);
+    if (mode != SpeedMode::Full)
+    {
+        auto valid_moves = generate_all_valid_moves(board, player, rows, cols, score_cols);
+        if (valid_moves.empty())
+        {
+            return Move();
+        }
+        auto chosen_move = (mode == SpeedMode::Instant)
+                               ? choose_instant(board, valid_moves, rows, cols, score_cols)
+                               : choose_greedy(board, valid_moves, rows, cols, score_cols);
+        last_moves.push_back(chosen_move);
+        if (last_moves.size() > 6)
+        {
+            last_moves.erase(last_moves.begin());
+        }
+        bool instant = mode == SpeedMode::Instant;
+        record_move_stats(instant ? "instant" : "greedy", clock, instant ? 0 : 1, "low_clock");
+        return to_move(chosen_move);
+    }
+
+    // Opening book
+    auto opening_book = opening_book_for(player, rows, cols, score_cols);
+    // Use opening book for first few moves
+    if (moves < static_cast<int>(opening_book.size()))
+    {
+        auto candidate = opening_book[moves];
+        auto test_board = apply_move(board, candidate, player, rows, cols, score_cols);
+
+        // Simple validation - if move changes board, it's valid
+        bool valid = false;
+        for (int y = 0; y < rows && !valid; y++)
+        {
+            for (int x = 0; x < cols && !valid; x++)
+            {
+                if (!(board[y][x].owner == test_board[y][x].owner &&
+                      board[y][x].side == test_board[y][x].side &&
+                      board[y][x].orientation == test_board[y][x].orientation))
+                {
+                    valid = true;
+                }
+            }
+        }
+
+        if (valid)
+        {
+            moves++;
+
+            // Track in last_moves
+            last_moves.push_back(candidate);
+            if (last_moves.size() > 3)
+            {
+                last_moves.erase(last_moves.begin());
+            }
+            record_move_stats("book", clock, 0, "book");
+
+            Move result;
+            result.action = candidate.at("action");
+            result.from_pos = {std::stoi(candidate.at("from_x")), std::stoi(candidate.at("from_y"))};
+            if (candidate.count("to_x"))
+            {
+                result.to_pos = {std::stoi(candidate.at("to_x")), std::stoi(candidate.at("to_y"))};
+            }
+            if (candidate.count("pushed_x"))
+            {
+                result.pushed_to = {std::stoi(candidate.at("pushed_x")), std::stoi(candidate.at("pushed_y"))};
+            }
+            if (candidate.count("orientation"))
+            {
+                result.orientation = candidate.at("orientation");
+            }
+            return result;
+        }
+    }
+
+    // Generate and evaluate moves
+    auto valid_moves = generate_all_valid_moves(board, player, rows, cols, score_cols);
+    if (valid_moves.empty())
+    {
+        return Move();
+    }
+
+    auto river_opportunities = find_river_creation_opportunities(board, rows, cols, score_cols);
+    auto defensive_rivers = find_defensive_river_placements(board, rows, cols, score_cols);
+
+    auto my_goals = get_my_goal_cells(rows, cols, score_cols);
+
+    // Iterative deepening from MAX_DEPTH. The first iteration always
+    // completes; deeper ones run against the time manager's hard limit
+    // and are discarded if it cuts them off.
+    std::vector<std::unordered_map<std::string, std::string>> best_moves;
+    std::string decision = "max_depth";
+    int completed_depth = 0;
+    double guess = evaluate_board(board, player, rows, cols, score_cols);
+    for (int depth = MAX_DEPTH; depth <= MAX_ITERATIVE_DEPTH; depth++)
+    {
+        auto iteration_start = std::chrono::steady_clock::now();
+        search_aborted = false;
+        deadline_armed = depth > MAX_DEPTH;
+        search_deadline = clock.deadline();
+
+        RootResult result = (root_driver == RootDriver::Mtdf)
+                                ? search_root_mtdf(board, valid_moves, depth, guess, rows, cols, score_cols,
+                                                   river_opportunities, defensive_rivers)
+                                : search_root(board, valid_moves, depth, rows, cols, score_cols,
+                                              river_opportunities, defensive_rivers);
+        deadline_armed = false;
+        if (search_aborted)
+        {
+            decision = "aborted";
+            break;
+        }
+
+        best_moves = result.best;
+        completed_depth = depth;
+        if (result.best.empty())
+            break;
+        guess = result.best_score;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - iteration_start).count();
+        decision = clock.after_iteration(result.best.front(), result.best_score, result.second_score,
+                                         seconds, valid_moves.size());
+        if (!decision.empty())
+            break;
+    }
+    record_move_stats("full", clock, completed_depth, decision);
+
+    // Choose from best moves
+    std::unordered_map<std::string, std::string> chosen_move;
+    if (!best_moves.empty())
+    {
+        // Prefer river-utilizing moves if scores are similar
+        std::vector<std::unordered_map<std::string, std::string>> river_moves;
+        for (const auto &m : best_moves)
+        {
+            if ((m.at("action") == "push" || m.at("action") == "move") &&
+                m.count("to_x") && m.count("from_x"))
+            {
+                int fx = std::stoi(m.at("from_x"));
+                int fy = std::stoi(m.at("from_y"));
+                int tx = std::stoi(m.at("to_x"));
+                int ty = std::stoi(m.at("to_y"));
+                if (std::abs(fx - tx) + std::abs(fy - ty) > 1)
+                {
+                    river_moves.push_back(m);
+                }
+            }
+        }
+
+        if (!river_moves.empty())
+        {
+            std::uniform_int_distribution<> dist(0, river_moves.size() - 1);
+            chosen_move = river_moves[dist(rng)];
+        }
+        else
+        {
+            std::uniform_int_distribution<> dist(0, best_moves.size() - 1);
+            chosen_move = best_moves[dist(rng)];
+        }
+    }
+    else
+    {
+        std::uniform_int_distribution<> dist(0, valid_moves.size() - 1);
+        chosen_move = valid_moves[dist(rng)];
+    }
+
+    // ========== REPETITION AVOIDANCE ==========
+    // Add chosen move to last_moves
+    last_moves.push_back(chosen_move);
+    if (last_moves.size() > 6)
+    {
+        last_moves.erase(last_moves.begin());
+    }
+
+    // Count how many times this move appears in last_moves
+    int move_count = 0;
+    for (const auto &past_move : last_moves)
+    {
+        // Compare moves (same action and positions)
+        bool same = (past_move.at("action") == chosen_move.at("action") &&
+                     past_move.at("from_x") == chosen_move.at("from_x") &&
+                     past_move.at("from_y") == chosen_move.at("from_y"));
+
+        if (same && chosen_move.count("to_x"))
+        {
+            same = same && (past_move.count("to_x") &&
+                            past_move.at("to_x") == chosen_move.at("to_x") &&
+                            past_move.at("to_y") == chosen_move.at("to_y"));
+        }
+
+        if (same && chosen_move.count("orientation"))
+        {
+            same = same && (past_move.count("orientation") &&
+                            past_move.at("orientation") == chosen_move.at("orientation"));
+        }
+
+        if (same)
+            move_count++;
+    }
+    
+    // auto my_goals = get_my_goal_cells(rows, cols, score_cols);
+    auto opp_goals = get_opponent_goal_cells(rows, cols, score_cols);
+    int my_score_row = my_goals[0].y;
+    int opp_score_row = opp_goals[0].y;
+
+    int my_scoring_stones = 0;
+    int opp_scoring_stones = 0;
+
+    for (int x : score_cols)
+    {
+        const Cell &cell_my = board[my_score_row][x];
+        if (!cell_my.isEmpty() && cell_my.owner == player && cell_my.side == "stone")
+        {
+            my_scoring_stones++;
+        }
+        const Cell &cell_opp = board[opp_score_row][x];
+        if (!cell_opp.isEmpty() && cell_opp.owner == opponent && cell_opp.side == "stone")
+        {
+            opp_scoring_stones++;
+        }
+    }
+
+    
+
+    // If move repeated too many times, choose different move
+    if (move_count > repetition_limit && !((my_scoring_stones == 0 && opp_scoring_stones >= 2) || (my_scoring_stones <=1 && opp_scoring_stones >= 3)))
+    {
+        // Find alternative moves that haven't been repeated
+        std::vector<std::unordered_map<std::string, std::string>> alt_moves;
+
+        for (const auto &m : valid_moves)
+        {
+            // Count repetitions for this move
+            int m_count = 0;
+            for (const auto &past_move : last_moves)
+            {
+                bool same = (past_move.at("action") == m.at("action") &&
+                             past_move.at("from_x") == m.at("from_x") &&
+                             past_move.at("from_y") == m.at("from_y"));
+
+                if (same && m.count("to_x"))
+                {
+                    same = same && (past_move.count("to_x") &&
+                                    past_move.at("to_x") == m.at("to_x") &&
+                                    past_move.at("to_y") == m.at("to_y"));
+                }
+
+                if (same && m.count("orientation"))
+                {
+                    same = same && (past_move.count("orientation") &&
+                                    past_move.at("orientation") == m.at("orientation"));
+                }
+
+                if (same)
+                    m_count++;
+            }
+
+            // Add to alternatives if not repeated too much
+            if (m_count <= repetition_limit)
+            {
+                alt_moves.push_back(m);
+            }
+        }
+
+        // Choose from alternatives if available
+        if (!alt_moves.empty())
+        {
+            std::uniform_int_distribution<> dist(0, alt_moves.size() - 1);
+            chosen_move = alt_moves[dist(rng)];
+
+            // Update last_moves with new choice
+            last_moves.pop_back(); // Remove the repeated move
+            last_moves.push_back(chosen_move);
+        }
+        // If all moves are repeated, stick with chosen_move (can't avoid repetition)
+    }
+
+    return to_move(chosen_move);
+}
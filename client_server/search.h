@@ -0,0 +1,633 @@
+// Move search
+//
+// The time manager that budgets each move, and StudentAgent: opening book,
+// low-clock policies, iterative-deepening alpha-beta over the phase
+// evaluators with tablebase probes, and pondering on the opponent's time.
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+#include "eval.h"
+#include "memory.h"
+#include "movegen.h"
+#include "parallel_search.h"
+#include "probcut.h"
+#include "tablebase.h"
+
+// ==================== TIME MANAGEMENT ====================
+
+// Picked from the remaining clock at the start of every choose call.
+enum class SpeedMode
+{
+    Full,    // opening book, opportunity scans and the minimax root loop
+    Greedy,  // one ply over distance fields with an immediate-win check
+    Instant  // row progress only, linear in the number of moves
+};
+
+constexpr double LOW_CLOCK_SECONDS = 10.0;
+constexpr double PANIC_CLOCK_SECONDS = 2.0;
+// A move time cap this small ends the search after its first iteration,
+// which always runs to completion.
+constexpr double FIRST_ITERATION_CAP = 1e-3;
+// Remaining depth from which order_moves() keys pushes by their outcome.
+constexpr int PUSH_ORDERING_DEPTH = 2;
+
+inline SpeedMode select_speed_mode(double current_player_time)
+{
+    if (current_player_time < PANIC_CLOCK_SECONDS)
+        return SpeedMode::Instant;
+    if (current_player_time < LOW_CLOCK_SECONDS)
+        return SpeedMode::Greedy;
+    return SpeedMode::Full;
+}
+
+// One entry per choose call, readable from Python via move_stats().
+struct MoveStats
+{
+    int move_number = 0;
+    std::string mode; // "book", "full", "greedy" or "instant"
+    double clock = 0.0;
+    double opponent_clock = 0.0;
+    double expected_moves = 0.0;
+    double soft_budget = 0.0;
+    double hard_budget = 0.0;
+    double elapsed = 0.0;
+    int depth = 0;        // deepest completed iteration
+    int best_changes = 0; // iterations whose best move differed from the previous one
+    int extensions = 0;
+    std::string decision; // why the search stopped
+};
+
+// Budgets one move from the clocks and the game phase, then decides after
+// every completed iteration whether another one is worth starting.
+class TimeManager
+{
+public:
+    static constexpr double MIN_EXPECTED_MOVES = 8.0;
+    static constexpr double HARD_FACTOR = 3.0;       // hard limit in soft budgets
+    static constexpr double MAX_CLOCK_FRACTION = 0.2; // never more of the clock
+    static constexpr double EXTENSION_FACTOR = 1.5;
+    static constexpr double BRANCHING_ESTIMATE = 15.0; // next iteration vs this one
+    static constexpr double SCORE_DROP = 1e10;        // one threat tier
+    static constexpr double DOMINANT_MARGIN = 1e13;   // a scoring move over the rest
+
+    // `cap` bounds the hard limit from outside, e.g. AgentPool's fair share.
+    TimeManager(double clock, double opponent_clock, const PhaseInfo &info, int win_count,
+                double cap = std::numeric_limits<double>::infinity())
+        : start_(std::chrono::steady_clock::now())
+    {
+        stats_.clock = clock;
+        stats_.opponent_clock = opponent_clock;
+
+        // Every stone still missing from the score row costs a few moves,
+        // plus the closest stone's run; earlier phases leave more to play.
+        double expected = 2.0 * (win_count - info.my_scoring) + info.my_min_rows;
+        if (info.phase == GamePhase::Opening)
+            expected += 20.0;
+        else if (info.phase == GamePhase::Midgame)
+            expected += 10.0;
+        stats_.expected_moves = std::max(expected, MIN_EXPECTED_MOVES);
+
+        // Behind on the clock: spend less so the opponent cannot outlast us.
+        double ratio = std::clamp(clock / std::max(opponent_clock, 1.0), 0.5, 2.0);
+        stats_.soft_budget = clock / stats_.expected_moves * std::sqrt(ratio);
+        stats_.hard_budget = std::min({stats_.soft_budget * HARD_FACTOR, clock * MAX_CLOCK_FRACTION, cap});
+        stats_.soft_budget = std::min(stats_.soft_budget, stats_.hard_budget);
+    }
+
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    std::chrono::steady_clock::time_point deadline() const
+    {
+        return start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(stats_.hard_budget));
+    }
+
+    // Empty string: search another iteration. Otherwise the reason to stop.
+    std::string after_iteration(const std::unordered_map<std::string, std::string> &best,
+                                double best_score, double second_score,
+                                double iteration_seconds, size_t legal_moves)
+    {
+        bool first = !has_previous_;
+        bool changed = !first && best != previous_best_;
+        bool dropped = !first && best_score < previous_score_ - SCORE_DROP;
+        has_previous_ = true;
+        previous_best_ = best;
+        previous_score_ = best_score;
+
+        if (changed)
+            stats_.best_changes++;
+        if (changed || dropped)
+        {
+            stats_.soft_budget = std::min(stats_.soft_budget * EXTENSION_FACTOR, stats_.hard_budget);
+            stats_.extensions++;
+        }
+
+        if (legal_moves == 1)
+            return "single_move";
+        if (best_score - second_score > DOMINANT_MARGIN)
+            return "dominant";
+        double spent = elapsed();
+        if (spent >= stats_.soft_budget)
+            return "soft_budget";
+        if (spent + iteration_seconds * BRANCHING_ESTIMATE > stats_.hard_budget)
+            return "next_iteration_too_long";
+        return "";
+    }
+
+    MoveStats &stats() { return stats_; }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    MoveStats stats_;
+    bool has_previous_ = false;
+    std::unordered_map<std::string, std::string> previous_best_;
+    double previous_score_ = 0.0;
+};
+
+// ==================== TRANSPOSITION TABLE ====================
+
+// Which loop scores the root moves of each iteration.
+enum class RootDriver
+{
+    AlphaBeta, // every root move in turn, narrowing the window as it goes
+    Mtdf       // zero-window passes converging on the best score
+};
+
+// Zero-window passes an MTD(f) iteration may take before it falls back to
+// the alpha-beta root loop.
+constexpr int MTDF_MAX_PASSES = 64;
+
+// Minimax bounds by position and side to move, with the depth they hold
+// for and the best move's index in order_moves' order. Direct-mapped and
+// always replacing; one lock, held only to copy an entry in or out.
+class TranspositionTable
+{
+public:
+    struct Entry
+    {
+        uint64_t key = 0;
+        int depth = -1;
+        double lower = -std::numeric_limits<double>::infinity();
+        double upper = std::numeric_limits<double>::infinity();
+        int best = -1;
+    };
+
+    static constexpr int DEFAULT_BITS = 18;
+    static constexpr int MIN_BITS = 10;
+    static constexpr int MAX_BITS = 30;
+
+    explicit TranspositionTable(int bits = DEFAULT_BITS)
+        : entries_(size_t(1) << bits), mask_((size_t(1) << bits) - 1)
+    {
+    }
+
+    // The largest table that fits in `bytes`.
+    static int bits_for(size_t bytes)
+    {
+        int bits = MIN_BITS;
+        while (bits < MAX_BITS && (sizeof(Entry) << (bits + 1)) <= bytes)
+            bits++;
+        return bits;
+    }
+
+    bool probe(uint64_t key, Entry &out) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        probes_++;
+        const Entry &e = entries_[key & mask_];
+        if (e.depth < 0 || e.key != key)
+            return false;
+        hits_++;
+        out = e;
+        return true;
+    }
+
+    // Folds in `value`, the result of a search with window (alpha, beta).
+    void store(uint64_t key, int depth, double alpha, double beta, double value, int best)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry &e = entries_[key & mask_];
+        if (e.key != key || e.depth != depth)
+        {
+            if (e.depth < 0)
+                used_++;
+            e = Entry();
+            e.key = key;
+            e.depth = depth;
+        }
+        if (value > alpha)
+            e.lower = std::max(e.lower, value);
+        if (value < beta)
+            e.upper = std::min(e.upper, value);
+        if (best >= 0)
+            e.best = best;
+    }
+
+    CacheStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CacheStats s;
+        s.name = "transpositions";
+        s.bytes = s.budget_bytes = entries_.size() * sizeof(Entry);
+        s.entries = used_;
+        s.capacity = entries_.size();
+        s.probes = probes_;
+        s.hits = hits_;
+        return s;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    size_t mask_;
+    size_t used_ = 0;
+    mutable uint64_t probes_ = 0, hits_ = 0;
+};
+
+// ==================== SEARCH EXTENSIONS ====================
+
+// Fractional-ply extensions, counted in quarter plies. Each move on a path
+// adds the units its threat earns; whenever they reach a ply, the child is
+// searched a ply deeper. At most EXTENSION_MAX_PLIES per path, so a chain of
+// threats cannot blow the search up.
+constexpr int PLY_UNITS = 4;
+constexpr int EXTEND_SCORE_ENTRY = 4;   // a stone onto one of its score cells
+constexpr int EXTEND_SCORE_EJECT = 4;   // a push of an own stone off its score cell
+constexpr int EXTEND_SINGLE_REPLY = 4;  // the only legal move
+constexpr int EXTEND_GOAL_ADJACENT = 2; // a stone next to one of its score cells
+constexpr int EXTENSION_MAX_PLIES = 2;
+
+// What the path to a node has collected so far.
+struct Extension
+{
+    int units = 0; // towards the next ply
+    int plies = 0; // granted
+};
+
+// Units `move` earns for `mover`, judged on the board before it. Distance 1
+// is approximated by adjacency: a stone that would reach the score row by
+// river flow is not noticed, which keeps this free of flow computations.
+int extension_units(const std::vector<std::vector<Cell>> &board,
+                    const std::unordered_map<std::string, std::string> &move,
+                    const std::string &mover,
+                    int rows, int cols,
+                    const std::vector<int> &score_cols);
+
+// ==================== STUDENT AGENT CLASS ====================
+
+class StudentAgent
+{
+private:
+    std::string player;
+    std::string opponent;
+    int MAX_DEPTH;
+    int MAX_ITERATIVE_DEPTH;
+    int moves;
+    std::vector<std::unordered_map<std::string, std::string>> last_moves;
+    int repetition_limit;
+    std::mt19937 rng;
+    Tablebase::Store tablebase;
+    std::vector<MoveStats> move_history;
+    double move_time_cap = std::numeric_limits<double>::infinity();
+
+    // Cut-off for iterations deeper than MAX_DEPTH, checked in minimax.
+    bool deadline_armed = false;
+    std::atomic<bool> search_aborted{false};
+    std::chrono::steady_clock::time_point search_deadline;
+
+    // Set for SearchMode::YoungBrothers; minimax splits on it.
+    std::unique_ptr<SearchThreads> search_threads;
+
+    RootDriver root_driver = RootDriver::AlphaBeta;
+    // Set for RootDriver::Mtdf, whose re-searches it makes cheap; minimax
+    // probes it whenever it is there.
+    std::unique_ptr<TranspositionTable> transpositions;
+
+    // Sigmas beyond the window at which ProbCut prunes; 0 turns it off.
+    double probcut_threshold = 0.0;
+
+    // Threat extensions in minimax (see SEARCH EXTENSIONS).
+    bool extensions_enabled = false;
+
+    // Bytes the tables may take (see memory.h); 0 leaves them at their
+    // default sizes.
+    size_t memory_budget = 0;
+    MemoryPolicy memory_policy;
+    MemoryPlan memory_plan;
+    // This agent's threat caches when it has a budget; without one it
+    // shares each thread's cache with the other agents on that thread.
+    std::unique_ptr<ThreatCacheAccount> threat_account;
+    void apply_memory_plan();
+
+    // Pondering: a search of our reply to the predicted opponent move, run
+    // on the opponent's time. stop_ponder() may be called from another thread.
+    struct PonderResult
+    {
+        bool valid = false;
+        uint64_t hash = 0; // position the reply was searched for
+        Move move;
+        std::vector<std::unordered_map<std::string, std::string>> last_moves;
+        int moves = 0;
+        MoveStats stats;
+    };
+    PonderResult ponder_result;
+    bool pondering = false;
+    std::atomic<bool> ponder_stop{false};
+    // The flag minimax polls while pondering; the predictor agent points it
+    // at its owner's ponder_stop so one stop_ponder() halts both searches.
+    std::atomic<bool> *stop_flag = &ponder_stop;
+
+public:
+    StudentAgent(const std::string &player_name);
+
+    int load_tablebases(const std::string &dir)
+    {
+        int loaded = tablebase.load_dir(dir);
+        apply_memory_plan();
+        return loaded;
+    }
+
+    const std::vector<MoveStats> &move_stats() const
+    {
+        return move_history;
+    }
+
+    // Upper bound on the search time of later moves; non-positive removes it.
+    void set_move_time_cap(double seconds)
+    {
+        move_time_cap = seconds > 0 ? seconds : std::numeric_limits<double>::infinity();
+    }
+
+    // Serial, or YBWC on `threads` threads (0: one per core). Cutoff scores
+    // of a parallel search may differ from the serial ones between runs;
+    // exact scores do not.
+    void set_search_mode(SearchMode mode, int threads = 0);
+
+    // MTD(f) also allocates a transposition table, kept across moves.
+    void set_root_driver(RootDriver driver);
+
+    // Sizes the transposition table and the threat caches so that they and
+    // the fixed tables fit in `bytes`, shared as `policy` says. Resizing
+    // empties the transposition table, so call it between games. With a
+    // budget the agent keeps threat caches of its own instead of sharing
+    // the per-thread ones. 0 goes back to the default sizes.
+    void set_memory_budget(size_t bytes, const MemoryPolicy &policy = MemoryPolicy());
+
+    // Every table with its size, occupancy and hit rate.
+    MemoryReport memory_report() const;
+
+    // ProbCut with the calibrated fits in probcut_params.h. A lower
+    // threshold prunes more and errs more often; probcut.h has measurements.
+    void set_probcut(bool enabled, double threshold)
+    {
+        probcut_threshold = enabled ? std::max(0.0, threshold) : 0.0;
+    }
+
+    // Extend score-row entries, ejections, single replies and stones moving
+    // next to their score cells.
+    void set_extensions(bool enabled)
+    {
+        extensions_enabled = enabled;
+    }
+
+    void record_move_stats(const std::string &mode, TimeManager &clock, int depth, const std::string &decision);
+
+    std::vector<Position> get_my_goal_cells(int rows, int cols, const std::vector<int> &score_cols);
+
+    std::vector<Position> get_opponent_goal_cells(int rows, int cols, const std::vector<int> &score_cols);
+
+    struct RiverOpportunity
+    {
+        std::string action;
+        int from_x, from_y;
+        std::string orientation;
+        double value;
+        bool defensive;
+
+        RiverOpportunity() : action(""), from_x(0), from_y(0), orientation(""), value(0.0), defensive(false) {}
+    };
+
+    std::vector<RiverOpportunity> find_river_creation_opportunities(
+        const std::vector<std::vector<Cell>> &board,
+        int rows, int cols,
+        const std::vector<int> &score_cols);
+
+    std::vector<RiverOpportunity> find_defensive_river_placements(
+        const std::vector<std::vector<Cell>> &board,
+        int rows, int cols,
+        const std::vector<int> &score_cols);
+
+    // Copies the goal zone of `attacker` into a tablebase grid and probes it.
+    // Returns -1 when no loaded table covers it or when pieces or rivers
+    // outside the zone could interfere (an occupied ring around the zone, or
+    // a river on the zone's rows or columns).
+    int probe_goal_zone(
+        const std::vector<std::vector<Cell>> &board,
+        const std::string &attacker,
+        const std::string &to_move,
+        int rows, int cols,
+        const std::vector<int> &score_cols);
+
+    // Score of a position decided by a goal-zone table, or 0 if neither
+    // zone is. When both sides can force a fill the shorter one counts,
+    // the side to move winning ties.
+    double probe_tablebases(
+        const std::vector<std::vector<Cell>> &board,
+        const std::string &to_move,
+        int rows, int cols,
+        const std::vector<int> &score_cols);
+
+    // Search stone moves that shorten the pattern-database distance or land
+    // on one of the opponent's cut cells first so alpha-beta cuts the rest
+    // off sooner. Flips, rotates and river moves keep their generated order
+    // behind the improving moves. With push_outcomes, pushes of stones are
+    // also keyed by what evaluate_push() says happens to the pushed stone;
+    // that costs two BFS fields per node, so minimax only asks for it where
+    // the subtree is deep enough to repay it.
+    void order_moves(
+        std::vector<std::unordered_map<std::string, std::string>> &moves,
+        const std::vector<std::vector<Cell>> &board,
+        const std::string &mover,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        bool push_outcomes = false);
+
+    double minimax(
+        const std::vector<std::vector<Cell>> &board,
+        int depth,
+        double alpha,
+        double beta,
+        bool is_maximizing,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        Extension extension = {});
+
+    // Depth to search the child reached by `move` at, one of `siblings`
+    // moves at a node `depth` plies deep; `child` gets the path's extension
+    // state below it.
+    int child_depth(
+        int depth,
+        const Extension &extension,
+        const std::vector<std::vector<Cell>> &board,
+        const std::unordered_map<std::string, std::string> &move,
+        const std::string &mover,
+        size_t siblings,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        Extension &child) const;
+
+    // The children of a node from the eldest on: the eldest alone, the rest
+    // at a split point shared with the search threads.
+    double split_search(
+        const std::vector<std::vector<Cell>> &board,
+        const std::vector<std::unordered_map<std::string, std::string>> &moves,
+        int depth,
+        double alpha,
+        double beta,
+        bool is_maximizing,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        const Extension &extension);
+
+    // Times `m` occurs in last_moves, compared on action, squares and orientation.
+    int repeat_count(const std::unordered_map<std::string, std::string> &m) const;
+
+    // Last-seconds policy: the stone move with the most row progress towards
+    // the score row, landing on a score cell first. One pass over the moves.
+    std::unordered_map<std::string, std::string> choose_instant(
+        const std::vector<std::vector<Cell>> &board,
+        const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+        int rows, int cols,
+        const std::vector<int> &score_cols);
+
+    // Low-clock policy: rank moves by the change in goal distance read off
+    // the two sides' distance fields, then take the best candidate that
+    // does not hand the opponent an immediate win.
+    std::unordered_map<std::string, std::string> choose_greedy(
+        const std::vector<std::vector<Cell>> &board,
+        const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+        int rows, int cols,
+        const std::vector<int> &score_cols);
+
+    // Minimax score of one root move searched to `depth`, plus the root
+    // bonuses for river pushes, river moves and strategic flips.
+    double score_root_move(
+        const std::vector<std::vector<Cell>> &board,
+        const std::unordered_map<std::string, std::string> &move,
+        int depth,
+        double alpha,
+        double beta,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        const std::vector<RiverOpportunity> &river_opportunities,
+        const std::vector<RiverOpportunity> &defensive_rivers);
+
+    // One iteration's root result: the best move and those within 100 of
+    // it, its score and the best score of the rest.
+    struct RootResult
+    {
+        std::vector<std::unordered_map<std::string, std::string>> best;
+        double best_score = -std::numeric_limits<double>::infinity();
+        double second_score = -std::numeric_limits<double>::infinity();
+    };
+
+    // Alpha-beta over the root moves in order, each scored by score_root_move.
+    RootResult search_root(
+        const std::vector<std::vector<Cell>> &board,
+        const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+        int depth,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        const std::vector<RiverOpportunity> &river_opportunities,
+        const std::vector<RiverOpportunity> &defensive_rivers);
+
+    // MTD(f) from `guess` (the previous iteration's score): zero-window
+    // passes over the root moves, each moving one bound on the best score,
+    // until the bounds meet. Returns the one best move with no ties and
+    // second_score == best_score.
+    RootResult search_root_mtdf(
+        const std::vector<std::vector<Cell>> &board,
+        const std::vector<std::unordered_map<std::string, std::string>> &valid_moves,
+        int depth,
+        double guess,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        const std::vector<RiverOpportunity> &river_opportunities,
+        const std::vector<RiverOpportunity> &defensive_rivers);
+
+    // `score` plus the root bonuses of `move`, which turned `board` into
+    // `new_board`.
+    double add_root_bonuses(
+        double score,
+        const std::vector<std::vector<Cell>> &board,
+        const std::vector<std::vector<Cell>> &new_board,
+        const std::unordered_map<std::string, std::string> &move,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        const std::vector<RiverOpportunity> &river_opportunities,
+        const std::vector<RiverOpportunity> &defensive_rivers);
+
+    // Called during the opponent's turn with the position they face. Predicts
+    // their reply with a first-iteration search from their side and searches
+    // our answer to it; choose() returns that answer at once if the predicted
+    // position arrives. Returns whether a reply is stored.
+    bool ponder(
+        const PyBoard &py_board,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        double current_player_time,
+        double opponent_time);
+
+    bool ponder_board(
+        const std::vector<std::vector<Cell>> &board,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        double current_player_time,
+        double opponent_time);
+
+    // Fixes the tie-breaking random choices, for reproducible games.
+    void set_seed(uint32_t seed)
+    {
+        rng.seed(seed);
+    }
+
+    // Safe to call from another thread while ponder() runs.
+    void stop_ponder()
+    {
+        ponder_stop = true;
+    }
+
+    Move choose(
+        const std::vector<std::vector<std::unordered_map<std::string, std::string>>> &py_board,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        double current_player_time,
+        double opponent_time);
+
+    Move choose_board(
+        const std::vector<std::vector<Cell>> &board,
+        int rows, int cols,
+        const std::vector<int> &score_cols,
+        double current_player_time,
+        double opponent_time);
+};
+
+#endif // SEARCH_H
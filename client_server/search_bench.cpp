@@ -0,0 +1,298 @@
+// Search speed on a fixed set of positions.
+//
+//   search_bench [--rows R] [--depth D] [--positions N] [--threads T1,T2,...]
+//                [--probcut T] [--extend] [--memory MB]
+//   search_bench --drivers [--rows R] [--depth D] [--positions N] [--extend]
+//                [--memory MB]
+//
+// Plays N seeded random games a few moves past the opening on the R-row
+// board. By default runs a full-window minimax of depth D on each position,
+// once serially and once per thread count in YBWC mode, and prints the time
+// and speed-up per mode, checking the values against the serial ones (a
+// full-window value does not depend on the search order). --probcut adds a
+// serial run with ProbCut at threshold T and --extend one with threat
+// extensions; their values may differ. With --drivers,
+// runs choose()'s iterative deepening from depth 2 to D with the alpha-beta
+// root loop and with MTD(f) instead, and checks the final best scores against
+// a full-window search of every root move. The alpha-beta root compares the
+// children against scores that include the root bonuses, so it can overrate
+// a move; MTD(f) should match exactly. --extend adds an MTD(f) run with
+// threat extensions, checked against a full-window search that extends the
+// same moves. --memory gives every agent a budget of MB megabytes and
+// prints the tables of the last serial or MTD(f) run.
+
+#include "board.h"
+#include "movegen.h"
+#include "search.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchPosition
+{
+    std::vector<std::vector<Cell>> board;
+    std::string to_move;
+};
+
+static std::vector<BenchPosition> make_positions(int count, int rows, int cols, const std::vector<int> &score_cols)
+{
+    std::mt19937 rng(1);
+    std::vector<BenchPosition> positions;
+    while (static_cast<int>(positions.size()) < count)
+    {
+        auto board = standard_start_board(rows, cols);
+        std::string side = "circle";
+        int plies = 12 + static_cast<int>(rng() % 12);
+        bool over = false;
+        for (int p = 0; p < plies && !over; p++)
+        {
+            auto moves = generate_all_valid_moves(board, side, rows, cols, score_cols);
+            if (moves.empty())
+                break;
+            board = apply_move(board, moves[rng() % moves.size()], side, rows, cols, score_cols);
+            side = get_opponent(side);
+            over = !check_win(board, rows, cols, score_cols).empty();
+        }
+        if (!over)
+            positions.push_back({board, side});
+    }
+    return positions;
+}
+
+static size_t memory_budget = 0;
+static MemoryReport last_memory;
+
+static void print_memory(const MemoryReport &report)
+{
+    const double MB = 1 << 20;
+    std::cout << "memory: " << std::fixed << std::setprecision(1) << report.total_bytes() / MB << " of "
+              << report.budget / MB << " MB\n";
+    for (const auto &t : report.tables)
+    {
+        std::cout << "  " << t.name << ": " << t.bytes / MB << " MB, " << t.entries << " entries, "
+                  << 100 * t.occupancy() << "% full";
+        if (t.probes)
+            std::cout << ", " << 100 * t.hit_rate() << "% of " << t.probes << " probes hit";
+        std::cout << "\n";
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Seconds for all positions; their values go to `values`.
+static double run(const std::vector<BenchPosition> &positions, SearchMode mode, int threads, int depth,
+                  int rows, int cols, const std::vector<int> &score_cols, std::vector<double> &values,
+                  double probcut = 0.0, bool extend = false)
+{
+    StudentAgent circle("circle"), square("square");
+    circle.set_memory_budget(memory_budget);
+    square.set_memory_budget(memory_budget);
+    circle.set_extensions(extend);
+    square.set_extensions(extend);
+    circle.set_search_mode(mode, threads);
+    square.set_search_mode(mode, threads);
+    circle.set_probcut(probcut > 0.0, probcut);
+    square.set_probcut(probcut > 0.0, probcut);
+    values.clear();
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto &pos : positions)
+    {
+        StudentAgent &agent = pos.to_move == "circle" ? circle : square;
+        values.push_back(agent.minimax(pos.board, depth, -std::numeric_limits<double>::infinity(),
+                                       std::numeric_limits<double>::infinity(), true, rows, cols, score_cols));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    last_memory = circle.memory_report();
+    return seconds;
+}
+
+// Seconds for all positions with `driver` at the root of every iteration;
+// the last iteration's best scores go to `values`.
+static double run_driver(const std::vector<BenchPosition> &positions, RootDriver driver, int depth,
+                         int rows, int cols, const std::vector<int> &score_cols, std::vector<double> &values,
+                         bool extend = false)
+{
+    StudentAgent circle("circle"), square("square");
+    circle.set_root_driver(driver);
+    square.set_root_driver(driver);
+    circle.set_extensions(extend);
+    square.set_extensions(extend);
+    circle.set_memory_budget(memory_budget);
+    square.set_memory_budget(memory_budget);
+    values.clear();
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto &pos : positions)
+    {
+        StudentAgent &agent = pos.to_move == "circle" ? circle : square;
+        auto moves = generate_all_valid_moves(pos.board, pos.to_move, rows, cols, score_cols);
+        auto rivers = agent.find_river_creation_opportunities(pos.board, rows, cols, score_cols);
+        auto defence = agent.find_defensive_river_placements(pos.board, rows, cols, score_cols);
+        double guess = evaluate_board(pos.board, pos.to_move, rows, cols, score_cols);
+        for (int d = 2; d <= depth; d++)
+        {
+            auto result = (driver == RootDriver::Mtdf)
+                              ? agent.search_root_mtdf(pos.board, moves, d, guess, rows, cols, score_cols, rivers, defence)
+                              : agent.search_root(pos.board, moves, d, rows, cols, score_cols, rivers, defence);
+            guess = result.best_score;
+        }
+        values.push_back(guess);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    last_memory = circle.memory_report();
+    return seconds;
+}
+
+// Best root score at `depth`, every root move searched with a full window.
+static std::vector<double> exact_root_values(const std::vector<BenchPosition> &positions, int depth,
+                                             int rows, int cols, const std::vector<int> &score_cols,
+                                             bool extend = false)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> values;
+    for (const auto &pos : positions)
+    {
+        StudentAgent agent(pos.to_move);
+        agent.set_extensions(extend);
+        auto rivers = agent.find_river_creation_opportunities(pos.board, rows, cols, score_cols);
+        auto defence = agent.find_defensive_river_placements(pos.board, rows, cols, score_cols);
+        double best = -INF;
+        for (const auto &move : generate_all_valid_moves(pos.board, pos.to_move, rows, cols, score_cols))
+            best = std::max(best, agent.score_root_move(pos.board, move, depth, -INF, INF, rows, cols,
+                                                        score_cols, rivers, defence));
+        values.push_back(best);
+    }
+    return values;
+}
+
+int main(int argc, char **argv)
+{
+    int rows = 13, depth = 3, count = 8;
+    bool drivers = false, extend = false;
+    double probcut = 0.0;
+    std::vector<int> thread_counts;
+    for (int i = 1; i < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        if (flag == "--drivers" || flag == "--extend")
+        {
+            (flag == "--drivers" ? drivers : extend) = true;
+            i--;
+            continue;
+        }
+        if (i + 1 >= argc)
+            flag = "";
+        std::string value = flag.empty() ? "" : argv[i + 1];
+        if (flag == "--rows" && supported_board(std::atoi(value.c_str()), std::atoi(value.c_str()) - 1))
+            rows = std::atoi(value.c_str());
+        else if (flag == "--depth" && std::atoi(value.c_str()) >= 1)
+            depth = std::atoi(value.c_str());
+        else if (flag == "--positions" && std::atoi(value.c_str()) >= 1)
+            count = std::atoi(value.c_str());
+        else if (flag == "--probcut" && std::atof(value.c_str()) > 0.0)
+            probcut = std::atof(value.c_str());
+        else if (flag == "--memory" && std::atoi(value.c_str()) >= 1)
+            memory_budget = static_cast<size_t>(std::atoi(value.c_str())) << 20;
+        else if (flag == "--threads")
+        {
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ','))
+                thread_counts.push_back(std::max(1, std::atoi(item.c_str())));
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [--drivers] [--rows " << MIN_BOARD_ROWS << "-" << MAX_BOARD_SIDE << "] [--depth D] [--positions N] [--threads T1,T2,...]"
+                      << " [--probcut T] [--extend] [--memory MB]\n";
+            return 1;
+        }
+    }
+    if (thread_counts.empty())
+    {
+        int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int t = 1; t < cores; t *= 2)
+            thread_counts.push_back(t);
+        thread_counts.push_back(cores);
+    }
+
+    int cols = rows - 1;
+    auto score_cols = score_cols_for(cols);
+    auto positions = make_positions(count, rows, cols, score_cols);
+
+    if (drivers)
+    {
+        auto exact = exact_root_values(positions, depth, rows, cols, score_cols);
+        auto report = [&](const char *name, double seconds, const std::vector<double> &values,
+                          const std::vector<double> &full_window)
+        {
+            int mismatches = 0;
+            for (size_t i = 0; i < values.size(); i++)
+                mismatches += values[i] != full_window[i];
+            std::cout << name << " root: " << seconds << "s, " << mismatches << " of " << values.size()
+                      << " best scores off the full-window ones\n";
+        };
+        std::vector<double> values;
+        std::cout << rows << "x" << cols << " depths 2-" << depth << ", " << positions.size() << " positions\n";
+        double alphabeta = run_driver(positions, RootDriver::AlphaBeta, depth, rows, cols, score_cols, values);
+        report("alpha-beta", alphabeta, values, exact);
+        double mtdf = run_driver(positions, RootDriver::Mtdf, depth, rows, cols, score_cols, values);
+        report("mtd(f)", mtdf, values, exact);
+        std::cout << "mtd(f) speed-up " << alphabeta / mtdf << "\n";
+        if (extend)
+        {
+            double seconds = run_driver(positions, RootDriver::Mtdf, depth, rows, cols, score_cols, values, true);
+            report("mtd(f) + extensions", seconds, values,
+                   exact_root_values(positions, depth, rows, cols, score_cols, true));
+        }
+        if (memory_budget)
+            print_memory(last_memory);
+        return 0;
+    }
+
+    // Untimed pass first: threat maps are cached per thread across agents,
+    // and the timed serial run should not be the one filling the cache
+    std::vector<double> serial_values, values;
+    run(positions, SearchMode::Serial, 1, depth, rows, cols, score_cols, serial_values);
+    double serial = run(positions, SearchMode::Serial, 1, depth, rows, cols, score_cols, serial_values);
+    std::cout << rows << "x" << cols << " depth " << depth << ", " << positions.size() << " positions\n";
+    std::cout << "serial: " << serial << "s\n";
+    if (memory_budget)
+        print_memory(last_memory);
+    auto report_changes = [&](const std::string &name, double seconds)
+    {
+        int changed = 0;
+        for (size_t i = 0; i < values.size(); i++)
+            changed += values[i] != serial_values[i];
+        std::cout << name << ": " << seconds << "s, speed-up " << serial / seconds << ", "
+                  << changed << " of " << values.size() << " values changed\n";
+    };
+    if (probcut > 0.0)
+    {
+        double seconds = run(positions, SearchMode::Serial, 1, depth, rows, cols, score_cols, values, probcut);
+        report_changes("probcut " + std::to_string(probcut), seconds);
+    }
+    if (extend)
+    {
+        double seconds = run(positions, SearchMode::Serial, 1, depth, rows, cols, score_cols, values, 0.0, true);
+        report_changes("extensions", seconds);
+    }
+    for (int threads : thread_counts)
+    {
+        double seconds = run(positions, SearchMode::YoungBrothers, threads, depth, rows, cols, score_cols, values);
+        int mismatches = 0;
+        for (size_t i = 0; i < values.size(); i++)
+            mismatches += values[i] != serial_values[i];
+        std::cout << "ybwc " << threads << " threads: " << seconds << "s, speed-up " << serial / seconds;
+        if (mismatches)
+            std::cout << ", " << mismatches << " values differ from serial";
+        std::cout << "\n";
+    }
+    return 0;
+}
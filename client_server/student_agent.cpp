@@ -1,2034 +1,24 @@
+// Python bindings for the engine library (rs_engine in CMakeLists.txt).
+// Only this file depends on pybind11; the engine itself is plain C++.
+
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <unordered_set>
-#include <queue>
-#include <deque>
-#include <algorithm>
-#include <cmath>
-#include <limits>
-#include <random>
-#include <memory>
-#include <tuple>
-#include <iostream>
-#include <sstream>
-
-namespace py = pybind11;
-// ==================== UTILITY STRUCTURES ====================
-
-struct Position
-{
-    int x, y;
-    Position() : x(0), y(0) {}
-    Position(int x_, int y_) : x(x_), y(y_) {}
-
-    bool operator==(const Position &other) const
-    {
-        return x == other.x && y == other.y;
-    }
-
-    bool operator!=(const Position &other) const
-    {
-        return !(*this == other);
-    }
-};
-
-// Hash function for Position
-namespace std
-{
-    template <>
-    struct hash<Position>
-    {
-        size_t operator()(const Position &p) const
-        {
-            return hash<int>()(p.x) ^ (hash<int>()(p.y) << 1);
-        }
-    };
-}
-
-struct Cell
-{
-    std::string owner;       // "circle" or "square" or ""
-    std::string side;        // "stone" or "river" or ""
-    std::string orientation; // "horizontal" or "vertical" or ""
-
-    Cell() : owner(""), side(""), orientation("") {}
-
-    bool isEmpty() const
-    {
-        return owner.empty();
-    }
-};
-
-struct Move
-{
-    std::string action;         // "move", "push", "flip", "rotate"
-    std::vector<int> from_pos;  // [x, y]
-    std::vector<int> to_pos;    // [x, y]
-    std::vector<int> pushed_to; // [x, y] for push actions
-    std::string orientation;    // for flip actions
-
-    Move() : action(""), from_pos(2, 0), to_pos(2, 0), pushed_to(2, 0), orientation("") {}
-};
-
-// ==================== UTILITY FUNCTIONS ====================
-
-inline bool in_bounds(int x, int y, int rows, int cols)
-{
-    return x >= 0 && x < cols && y >= 0 && y < rows;
-}
-
-inline std::vector<int> score_cols_for(int cols)
-{
-    int w = 4;
-    int start = std::max(0, (cols - w) / 2);
-    std::vector<int> result;
-    for (int i = start; i < start + w; i++)
-    {
-        result.push_back(i);
-    }
-    return result;
-}
-
-inline int top_score_row()
-{
-    return 2;
-}
-
-inline int bottom_score_row(int rows)
-{
-    return rows - 3;
-}
-
-inline std::string get_opponent(const std::string &player)
-{
-    return (player == "circle") ? "square" : "circle";
-}
-
-inline bool is_opponent_score_cell(int x, int y, const std::string &player,
-                                   int rows, int cols, const std::vector<int> &score_cols)
-{
-    int target_row = (player == "circle") ? bottom_score_row(rows) : top_score_row();
-    if (y != target_row)
-        return false;
-    return std::find(score_cols.begin(), score_cols.end(), x) != score_cols.end();
-}
-
-inline bool is_my_score_cell(int x, int y, const std::string &player,
-                             int rows, int cols, const std::vector<int> &score_cols)
-{
-    int target_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
-    if (y != target_row)
-        return false;
-    return std::find(score_cols.begin(), score_cols.end(), x) != score_cols.end();
-}
-
-static std::string make_bfs_key(int sx, int sy, const std::vector<Position> &goals, bool use_rivers, const std::string &player)
-{
-    std::ostringstream oss;
-    oss << sx << "," << sy << ":" << (use_rivers ? "R1" : "R0") << ":" << player << ":";
-    for (const auto &g : goals)
-    {
-        oss << g.x << "," << g.y << ";";
-    }
-    return oss.str();
-}
-
-int get_win_count(int board_size)
-{
-    if (board_size == 15)
-        return 5;
-    if (board_size == 17)
-        return 6;
-    return 4;
-}
-
-std::string check_win(const std::vector<std::vector<Cell>> &board,
-                      int rows, int cols, const std::vector<int> &score_cols)
-{
-    const int WIN_COUNT = get_win_count(board.size());
-    int top = top_score_row();
-    int bot = bottom_score_row(rows);
-    int ccount = 0, scount = 0;
-
-    for (int x : score_cols)
-    {
-        if (in_bounds(x, top, rows, cols))
-        {
-            const Cell &p = board[top][x];
-            if (!p.isEmpty() && p.owner == "circle" && p.side == "stone")
-                ccount++;
-        }
-        if (in_bounds(x, bot, rows, cols))
-        {
-            const Cell &q = board[bot][x];
-            if (!q.isEmpty() && q.owner == "square" && q.side == "stone")
-                scount++;
-        }
-    }
-
-    if (ccount >= WIN_COUNT)
-        return "circle";
-    if (scount >= WIN_COUNT)
-        return "square";
-    return "";
-}
-
-// ==================== RIVER FLOW COMPUTATION ====================
-
-std::vector<Position> get_river_flow_destinations(
-    const std::vector<std::vector<Cell>> &board,
-    int rx, int ry, int sx, int sy, const std::string &player,
-    int rows, int cols, const std::vector<int> &score_cols,
-    bool river_push = false)
-{
-    std::vector<Position> destinations;
-    std::unordered_set<Position> visited;
-    std::deque<Position> queue;
-    queue.push_back(Position(rx, ry));
-
-    while (!queue.empty())
-    {
-        Position pos = queue.front();
-        queue.pop_front();
-
-        if (visited.count(pos) || !in_bounds(pos.x, pos.y, rows, cols))
-            continue;
-        visited.insert(pos);
-
-        const Cell *cell = &board[pos.y][pos.x];
-        if (river_push && pos.x == rx && pos.y == ry)
-        {
-            cell = &board[sy][sx];
-        }
-
-        if (cell->isEmpty())
-        {
-            if (!is_opponent_score_cell(pos.x, pos.y, player, rows, cols, score_cols))
-            {
-                destinations.push_back(pos);
-            }
-            continue;
-        }
-
-        if (cell->side != "river")
-            continue;
-
-        std::vector<std::pair<int, int>> dirs;
-        if (cell->orientation == "horizontal")
-        {
-            dirs = {{1, 0}, {-1, 0}};
-        }
-        else
-        {
-            dirs = {{0, 1}, {0, -1}};
-        }
-
-        for (auto [dx, dy] : dirs)
-        {
-            int nx = pos.x + dx;
-            int ny = pos.y + dy;
-
-            while (in_bounds(nx, ny, rows, cols))
-            {
-                if (is_opponent_score_cell(nx, ny, player, rows, cols, score_cols))
-                {
-                    break;
-                }
-
-                const Cell &next_cell = board[ny][nx];
-
-                if (next_cell.isEmpty())
-                {
-                    destinations.push_back(Position(nx, ny));
-                    nx += dx;
-                    ny += dy;
-                    continue;
-                }
-
-                if (nx == sx && ny == sy)
-                {
-                    nx += dx;
-                    ny += dy;
-                    continue;
-                }
-
-                if (next_cell.side == "river")
-                {
-                    queue.push_back(Position(nx, ny));
-                    break;
-                }
-                break;
-            }
-        }
-    }
-
-    // Remove duplicates
-    std::vector<Position> out;
-    std::unordered_set<Position> seen;
-    for (const auto &d : destinations)
-    {
-        if (!seen.count(d))
-        {
-            seen.insert(d);
-            out.push_back(d);
-        }
-    }
-    return out;
-}
-
-// ==================== BFS PATHFINDING ====================
-
-struct PathResult
-{
-    double distance;
-    std::vector<Position> path;
-
-    PathResult() : distance(std::numeric_limits<double>::infinity()) {}
-    PathResult(double d, const std::vector<Position> &p) : distance(d), path(p) {}
-};
-
-static std::unordered_map<std::string, PathResult> GLOBAL_BFS_CACHE;
-
-PathResult bfs_distance_to_goals(
-    const std::vector<std::vector<Cell>> &board,
-    int start_x, int start_y,
-    const std::vector<Position> &goal_cells,
-    const std::string &player,
-    int rows, int cols,
-    const std::vector<int> &score_cols,
-    bool use_rivers = true)
-{
-    Position start(start_x, start_y);
-
-    // Check if already at goal
-    for (const auto &goal : goal_cells)
-    {
-        if (start == goal)
-        {
-            return PathResult(0.0, {start});
-        }
-    }
-
-    struct QueueNode
-    {
-        Position pos;
-        int dist;
-        std::vector<Position> path;
-    };
-
-    std::deque<QueueNode> queue;
-    std::unordered_set<Position> visited;
-
-    queue.push_back({start, 0, {start}});
-    visited.insert(start);
-
-    while (!queue.empty())
-    {
-        QueueNode node = queue.front();
-        queue.pop_front();
-
-        std::vector<std::pair<int, int>> dirs = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-
-        for (auto [dx, dy] : dirs)
-        {
-            int nx = node.pos.x + dx;
-            int ny = node.pos.y + dy;
-            Position next_pos(nx, ny);
-
-            if (!in_bounds(nx, ny, rows, cols))
-                continue;
-            if (visited.count(next_pos))
-                continue;
-            if (is_opponent_score_cell(nx, ny, player, rows, cols, score_cols))
-                continue;
-
-            const Cell &cell = board[ny][nx];
-            std::vector<Position> new_path = node.path;
-            new_path.push_back(next_pos);
-
-            // Empty cell - can move here
-            if (cell.isEmpty())
-            {
-                for (const auto &goal : goal_cells)
-                {
-                    if (next_pos == goal)
-                    {
-                        return PathResult(node.dist + 1, new_path);
-                    }
-                }
-                visited.insert(next_pos);
-                queue.push_back({next_pos, node.dist + 1, new_path});
-            }
-            // River cell - can flow through if use_rivers
-            else if (use_rivers && cell.side == "river")
-            {
-                auto flow_dests = get_river_flow_destinations(
-                    board, nx, ny, node.pos.x, node.pos.y, player, rows, cols, score_cols);
-
-                for (const auto &flow_pos : flow_dests)
-                {
-                    if (!visited.count(flow_pos))
-                    {
-                        std::vector<Position> flow_path = new_path;
-                        flow_path.push_back(flow_pos);
-
-                        for (const auto &goal : goal_cells)
-                        {
-                            if (flow_pos == goal)
-                            {
-                                return PathResult(node.dist + 1, flow_path);
-                            }
-                        }
-                        visited.insert(flow_pos);
-                        queue.push_back({flow_pos, node.dist + 1, flow_path});
-                    }
-                }
-            }
-        }
-    }
-
-    return PathResult(); // No path found
-}
-
-PathResult bfs_distance_to_goals_cached(
-    const std::vector<std::vector<Cell>> &board,
-    int start_x, int start_y,
-    const std::vector<Position> &goal_cells,
-    const std::string &player,
-    int rows, int cols,
-    const std::vector<int> &score_cols,
-    bool use_rivers = true)
-{
-    GLOBAL_BFS_CACHE.clear();
-    std::string key = make_bfs_key(start_x, start_y, goal_cells, use_rivers, player);
-    auto it = GLOBAL_BFS_CACHE.find(key);
-    if (it != GLOBAL_BFS_CACHE.end())
-    {
-        return it->second;
-    }
-    PathResult res = bfs_distance_to_goals(board, start_x, start_y, goal_cells, player, rows, cols, score_cols, use_rivers);
-    GLOBAL_BFS_CACHE.emplace(key, res);
-    return res;
-}
-
-std::pair<double, std::string> bfs_distance_with_flip(
-    const std::vector<std::vector<Cell>> &board,
-    int start_x, int start_y,
-    const std::vector<Position> &goal_cells,
-    const std::string &player,
-    int rows, int cols,
-    const std::vector<int> &score_cols)
-{
-    const Cell &piece = board[start_y][start_x];
-    if (piece.isEmpty() || piece.owner != player)
-    {
-        return {std::numeric_limits<double>::infinity(), "none"};
-    }
-
-    auto current_result = bfs_distance_to_goals_cached(board, start_x, start_y, goal_cells, player, rows, cols, score_cols);
-    double current_dist = current_result.distance;
-
-    if (piece.side == "stone")
-    {
-        double best_dist = current_dist;
-        std::string best_orient = "none";
-
-        // Try horizontal river
-        auto board_copy = board;
-        board_copy[start_y][start_x].side = "river";
-        board_copy[start_y][start_x].orientation = "horizontal";
-        GLOBAL_BFS_CACHE.clear();
-        auto h_result = bfs_distance_to_goals_cached(board_copy, start_x, start_y, goal_cells, player, rows, cols, score_cols);
-        if (h_result.distance < best_dist)
-        {
-            best_dist = h_result.distance;
-            best_orient = "horizontal";
-        }
-
-        // Try vertical river
-        board_copy[start_y][start_x].orientation = "vertical";
-        GLOBAL_BFS_CACHE.clear();
-        auto v_result = bfs_distance_to_goals_cached(board_copy, start_x, start_y, goal_cells, player, rows, cols, score_cols);
-        if (v_result.distance < best_dist)
-        {
-            best_dist = v_result.distance;
-            best_orient = "vertical";
-        }
-
-        return {best_dist, best_orient};
-    }
-
-    return {current_dist, "none"};
-}
-
-// ==================== STUDENT AGENT CLASS ====================
-
-class StudentAgent
-{
-private:
-    std::string player;
-    std::string opponent;
-    int MAX_DEPTH;
-    int moves;
-    std::vector<std::unordered_map<std::string, std::string>> last_moves;
-    int repetition_limit;
-    std::mt19937 rng;
-
-public:
-    StudentAgent(const std::string &player_name)
-        : player(player_name),
-          opponent(get_opponent(player_name)),
-          MAX_DEPTH(2),
-          moves(0),
-          repetition_limit(2),
-          rng(std::random_device{}())
-    {
-    }
-
-    std::vector<Position> get_my_goal_cells(int rows, int cols, const std::vector<int> &score_cols)
-    {
-        int goal_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
-        std::vector<Position> goals;
-        for (int x : score_cols)
-        {
-            goals.push_back(Position(x, goal_row));
-        }
-        return goals;
-    }
-
-    std::vector<Position> get_opponent_goal_cells(int rows, int cols, const std::vector<int> &score_cols)
-    {
-        int goal_row = (player == "circle") ? bottom_score_row(rows) : top_score_row();
-        std::vector<Position> goals;
-        for (int x : score_cols)
-        {
-            goals.push_back(Position(x, goal_row));
-        }
-        return goals;
-    }
-
-    struct RiverOpportunity
-    {
-        std::string action;
-        int from_x, from_y;
-        std::string orientation;
-        double value;
-        bool defensive;
-
-        RiverOpportunity() : action(""), from_x(0), from_y(0), orientation(""), value(0.0), defensive(false) {}
-    };
-
-    std::vector<RiverOpportunity> find_river_creation_opportunities(
-        const std::vector<std::vector<Cell>> &board,
-        int rows, int cols,
-        const std::vector<int> &score_cols)
-    {
-        std::vector<RiverOpportunity> opportunities;
-        auto my_goals = get_my_goal_cells(rows, cols, score_cols);
-
-        for (int y = 0; y < rows; y++)
-        {
-            for (int x = 0; x < cols; x++)
-            {
-                const Cell &cell = board[y][x];
-                if (!cell.isEmpty() && cell.owner == player && cell.side == "stone")
-                {
-                    auto [dist_with_flip, best_orient] = bfs_distance_with_flip(
-                        board, x, y, my_goals, player, rows, cols, score_cols);
-
-                    auto current_result = bfs_distance_to_goals_cached(
-                        board, x, y, my_goals, player, rows, cols, score_cols);
-                    double current_dist = current_result.distance;
-
-                    if (best_orient != "none" && dist_with_flip < current_dist - 1)
-                    {
-                        RiverOpportunity opp;
-                        opp.action = "flip";
-                        opp.from_x = x;
-                        opp.from_y = y;
-                        opp.orientation = best_orient;
-                        opp.value = std::pow(2, 30.0 - std::min(dist_with_flip, 30.0)) * 1000.0;
-                        opp.defensive = false;
-                        opportunities.push_back(opp);
-                    }
-                }
-            }
-        }
-
-        std::sort(opportunities.begin(), opportunities.end(),
-                  [](const RiverOpportunity &a, const RiverOpportunity &b)
-                  {
-                      return a.value > b.value;
-                  });
-
-        return opportunities;
-    }
-
-    std::vector<RiverOpportunity> find_defensive_river_placements(
-        const std::vector<std::vector<Cell>> &board,
-        int rows, int cols,
-        const std::vector<int> &score_cols)
-    {
-        std::vector<RiverOpportunity> defensive_moves;
-        auto opp_goals = get_opponent_goal_cells(rows, cols, score_cols);
-        auto my_goals = get_my_goal_cells(rows, cols, score_cols);
-
-        // Find opponent threats
-        struct Threat
-        {
-            int x, y;
-            double dist;
-            std::vector<Position> path;
-        };
-        std::vector<Threat> opp_threats;
-
-        for (int y = 0; y < rows; y++)
-        {
-            for (int x = 0; x < cols; x++)
-            {
-                const Cell &cell = board[y][x];
-                if (!cell.isEmpty() && cell.owner == opponent && cell.side == "stone")
-                {
-                    auto result = bfs_distance_to_goals_cached(board, x, y, opp_goals, opponent, rows, cols, score_cols);
-                    if (result.distance < 6)
-                    {
-                        opp_threats.push_back({x, y, result.distance, result.path});
-                    }
-                }
-            }
-        }
-
-        // For each threat, find blocking positions
-        for (const auto &threat : opp_threats)
-        {
-            for (size_t i = 1; i < threat.path.size() - 1; i++)
-            {
-                Position p = threat.path[i];
-                const Cell &cell = board[p.y][p.x];
-
-                if (!cell.isEmpty() && cell.owner == player && cell.side == "stone")
-                {
-                    for (const std::string &orient : {"horizontal", "vertical"})
-                    {
-                        auto board_copy = board;
-                        board_copy[p.y][p.x].side = "river";
-                        board_copy[p.y][p.x].orientation = orient;
-                        GLOBAL_BFS_CACHE.clear();
-                        auto new_result = bfs_distance_to_goals_cached(
-                            board_copy, threat.x, threat.y, opp_goals, opponent, rows, cols, score_cols);
-
-                        bool blocks_us = false;
-                        for (int my_y = 0; my_y < rows && !blocks_us; my_y++)
-                        {
-                            for (int my_x = 0; my_x < cols && !blocks_us; my_x++)
-                            {
-                                const Cell &my_cell = board[my_y][my_x];
-                                if (!my_cell.isEmpty() && my_cell.owner == player && my_cell.side == "stone")
-                                {
-                                    auto my_before = bfs_distance_to_goals_cached(
-                                        board, my_x, my_y, my_goals, player, rows, cols, score_cols);
-                                    auto my_after = bfs_distance_to_goals_cached(
-                                        board_copy, my_x, my_y, my_goals, player, rows, cols, score_cols);
-                                    if (my_after.distance > my_before.distance + 2)
-                                    {
-                                        blocks_us = true;
-                                    }
-                                }
-                            }
-                        }
-
-                        if (new_result.distance > threat.dist + 1 && !blocks_us)
-                        {
-                            RiverOpportunity def;
-                            def.action = "flip";
-                            def.from_x = p.x;
-                            def.from_y = p.y;
-                            def.orientation = orient;
-                            def.value = std::pow(2, 35 - std::min(35.0, threat.dist)) * 1000.0;
-                            def.defensive = true;
-                            defensive_moves.push_back(def);
-                        }
-                    }
-                }
-            }
-        }
-
-        std::sort(defensive_moves.begin(), defensive_moves.end(),
-                  [](const RiverOpportunity &a, const RiverOpportunity &b)
-                  {
-                      return a.value > b.value;
-                  });
-
-        return defensive_moves;
-    }
-
-    std::vector<std::unordered_map<std::string, std::string>> generate_all_valid_moves(
-        const std::vector<std::vector<Cell>> &board,
-        const std::string &current_player,
-        int rows, int cols,
-        const std::vector<int> &score_cols)
-    {
-        std::vector<std::unordered_map<std::string, std::string>> moves;
-
-        for (int y = 0; y < rows; y++)
-        {
-            for (int x = 0; x < cols; x++)
-            {
-                const Cell &p = board[y][x];
-                if (!p.isEmpty() && p.owner == current_player)
-                {
-                    // Compute valid targets (moves and pushes)
-                    std::vector<Position> move_targets;
-                    std::vector<std::tuple<Position, Position>> push_targets;
-
-                    std::vector<std::pair<int, int>> dirs = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-                    for (auto [dx, dy] : dirs)
-                    {
-                        int tx = x + dx;
-                        int ty = y + dy;
-
-                        if (!in_bounds(tx, ty, rows, cols))
-                            continue;
-                        if (is_opponent_score_cell(tx, ty, current_player, rows, cols, score_cols))
-                            continue;
-
-                        const Cell &target = board[ty][tx];
-
-                        if (target.isEmpty())
-                        {
-                            move_targets.push_back(Position(tx, ty));
-                        }
-                        else if (target.side == "river")
-                        {
-                            auto flow = get_river_flow_destinations(board, tx, ty, x, y, current_player, rows, cols, score_cols);
-                            for (const auto &d : flow)
-                            {
-                                move_targets.push_back(d);
-                            }
-                        }
-                        else
-                        {
-                            if (p.side == "stone")
-                            {
-                                int px = tx + dx;
-                                int py = ty + dy;
-                                std::string pushed_player = target.owner;
-
-                                if (in_bounds(px, py, rows, cols) && board[py][px].isEmpty() &&
-                                    !is_opponent_score_cell(px, py, p.owner, rows, cols, score_cols) &&
-                                    !is_opponent_score_cell(px, py, pushed_player, rows, cols, score_cols))
-                                {
-                                    push_targets.push_back({Position(tx, ty), Position(px, py)});
-                                }
-                            }
-                            else
-                            {
-                                std::string pushed_player = target.owner;
-                                auto flow = get_river_flow_destinations(board, tx, ty, x, y, pushed_player, rows, cols, score_cols, true);
-                                for (const auto &d : flow)
-                                {
-                                    if (!is_opponent_score_cell(d.x, d.y, current_player, rows, cols, score_cols))
-                                    {
-                                        push_targets.push_back({Position(tx, ty), d});
-                                    }
-                                }
-                            }
-                        }
-                    }
-
-                    // Add move actions
-                    for (const auto &target : move_targets)
-                    {
-                        std::unordered_map<std::string, std::string> move;
-                        move["action"] = "move";
-                        move["from_x"] = std::to_string(x);
-                        move["from_y"] = std::to_string(y);
-                        move["to_x"] = std::to_string(target.x);
-                        move["to_y"] = std::to_string(target.y);
-                        moves.push_back(move);
-                    }
-
-                    // Add push actions
-                    for (const auto &[to_pos, pushed_pos] : push_targets)
-                    {
-                        std::unordered_map<std::string, std::string> move;
-                        move["action"] = "push";
-                        move["from_x"] = std::to_string(x);
-                        move["from_y"] = std::to_string(y);
-                        move["to_x"] = std::to_string(to_pos.x);
-                        move["to_y"] = std::to_string(to_pos.y);
-                        move["pushed_x"] = std::to_string(pushed_pos.x);
-                        move["pushed_y"] = std::to_string(pushed_pos.y);
-                        moves.push_back(move);
-                    }
-
-                    // Add flip and rotate actions
-                    if (p.side == "stone")
-                    {
-                        std::unordered_map<std::string, std::string> flip_h, flip_v;
-                        flip_h["action"] = "flip";
-                        flip_h["from_x"] = std::to_string(x);
-                        flip_h["from_y"] = std::to_string(y);
-                        flip_h["orientation"] = "horizontal";
-                        moves.push_back(flip_h);
-
-                        flip_v["action"] = "flip";
-                        flip_v["from_x"] = std::to_string(x);
-                        flip_v["from_y"] = std::to_string(y);
-                        flip_v["orientation"] = "vertical";
-                        moves.push_back(flip_v);
-                    }
-                    else
-                    {
-                        std::unordered_map<std::string, std::string> flip, rotate;
-                        flip["action"] = "flip";
-                        flip["from_x"] = std::to_string(x);
-                        flip["from_y"] = std::to_string(y);
-                        moves.push_back(flip);
 
-                        rotate["action"] = "rotate";
-                        rotate["from_x"] = std::to_string(x);
-                        rotate["from_y"] = std::to_string(y);
-                        moves.push_back(rotate);
-                    }
-                }
-            }
-        }
-
-        return moves;
-    }
-
-    double evaluate_board(
-        const std::vector<std::vector<Cell>> &board,
-        int rows, int cols,
-        const std::vector<int> &score_cols)
-    {
-        double score = 0.0;
-        const double WIN_SCORE = 1e15;
-        const double LOSE_SCORE = -1e15;
-        const double INF = std::numeric_limits<double>::infinity();
-
-        auto my_goals = get_my_goal_cells(rows, cols, score_cols);
-        auto opp_goals = get_opponent_goal_cells(rows, cols, score_cols);
-        int my_score_row = my_goals[0].y;
-        int opp_score_row = opp_goals[0].y;
-
-        // ========== FEATURE 1: SCORING STONES ==========
-        int my_scoring_stones = 0;
-        int opp_scoring_stones = 0;
-
-        for (int x : score_cols)
-        {
-            const Cell &cell_my = board[my_score_row][x];
-            if (!cell_my.isEmpty() && cell_my.owner == player && cell_my.side == "stone")
-            {
-                my_scoring_stones++;
-            }
-            const Cell &cell_opp = board[opp_score_row][x];
-            if (!cell_opp.isEmpty() && cell_opp.owner == opponent && cell_opp.side == "stone")
-            {
-                opp_scoring_stones++;
-            }
-        }
-
-        // Winning conditions
-        if (my_scoring_stones >= get_win_count(rows))
-            return WIN_SCORE;
-        if (opp_scoring_stones >= get_win_count(rows))
-            return LOSE_SCORE;
-
-        // Apply learned weights for scoring stones
-        score += my_scoring_stones * 1e14;
-        score -= opp_scoring_stones * 1e14;
-
-        // ========== COLLECT STONE POSITIONS AND CALCULATE FEATURES ==========
-        struct StoneInfo
-        {
-            int x, y;
-            double dist;
-            std::vector<Position> path;
-        };
-        std::vector<StoneInfo> my_stone_distances;
-        std::vector<StoneInfo> opp_stone_distances;
-
-        // Distance bucket counters
-        int my_stones_within_2 = 0;
-        int my_stones_within_4 = 0;
-        int my_stones_within_6 = 0;
-        int opp_stones_within_2 = 0;
-        int opp_stones_within_4 = 0;
-        int opp_stones_within_6 = 0;
-
-        // Row-based distance counters
-        int my_stones_within_1_rows = 0;
-
-        // River features
-        int my_river_count = 0;
-        int opp_river_count = 0;
-        int my_rivers_near_goal = 0;
-        int rivers_near_us = 0;
-        int opp_rivers_near_goal = 0;
-        int my_rivers_horizontal = 0;
-        int my_rivers_vertical = 0;
-
-        // Mobility features
-        int my_mobility = 0;
-        int opp_mobility = 0;
-
-        // Formation features
-        int my_horizontal_connections = 0;
-        int my_vertical_connections = 0;
-
-        // Blocking features
-        int opp_stones_blocked = 0;
-        int my_blocking_pieces = 0;
-
-        // Stone positions for clustering
-        std::vector<std::pair<int, int>> my_stones;
-        std::vector<std::pair<int, int>> opp_stones;
-
-        // Proximity scores
-        double my_proximity_score = 0.0;
-        double opp_proximity_score = 0.0;
-
-        // Min distances
-        double my_min_distance = 999.0;
-        double opp_min_distance = 999.0;
-
-        // Average distances
-        std::vector<double> my_distances;
-        std::vector<double> opp_distances;
-
-        // Tempo/advancement
-        int my_advancement = 0;
-        int opp_advancement = 0;
-
-        // ========== MAIN BOARD SCAN ==========
-        for (int y = 0; y < rows; y++)
-        {
-            for (int x = 0; x < cols; x++)
-            {
-                const Cell &cell = board[y][x];
-
-                // === MY STONES ===
-                if (cell.side == "stone" && cell.owner == player)
-                {
-                    my_stones.push_back({x, y});
-
-                    // Row-based distance
-                    int row_dist = std::abs(y - my_score_row);
-                    if (row_dist <= 1)
-                        my_stones_within_1_rows++;
-
-                    // Advancement (tempo)
-                    my_advancement += rows - row_dist;
-
-                    // BFS distance to goals
-                    auto result = bfs_distance_to_goals_cached(
-                        board, x, y, my_goals, player, rows, cols, score_cols, true);
-
-                    if (result.distance < INF)
-                    {
-                        my_stone_distances.push_back({x, y, result.distance, result.path});
-                        my_distances.push_back(result.distance);
-
-                        // Min distance
-                        if (result.distance < my_min_distance)
-                        {
-                            my_min_distance = result.distance;
-                        }
-
-                        // Distance buckets
-                        if (result.distance <= 2)
-                            my_stones_within_2++;
-                        if (result.distance <= 4)
-                            my_stones_within_4++;
-                        if (result.distance <= 6)
-                            my_stones_within_6++;
-                        my_proximity_score += std::pow(2, 35.0 - std::min(result.distance, 35.0)) * 1000.0;
-
-                        // if (result.distance <= 2)
-                        // {
-                        //     my_proximity_score += 2e6 + my_scoring_stones * 5e5;
-                        // }
-                        // else if (result.distance <= 4)
-                        // {
-                        //     my_proximity_score += 1e5 + my_scoring_stones * 5e4;
-                        // }
-
-                        // if (result.path.size() > static_cast<size_t>(result.distance + 1))
-                        // {
-                        //     my_proximity_score += 200000.0;
-                        // }
-                    }
-
-                    // Mobility
-                    std::vector<std::pair<int, int>> dirs = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-                    for (auto [dx, dy] : dirs)
-                    {
-                        int nx = x + dx, ny = y + dy;
-                        if (in_bounds(nx, ny, rows, cols) && board[ny][nx].isEmpty())
-                        {
-                            my_mobility++;
-                        }
-                    }
-                }
-                // === OPPONENT STONES ===
-                else if (cell.side == "stone" && cell.owner == opponent)
-                {
-                    opp_stones.push_back({x, y});
-
-                    // Advancement (tempo)
-                    int row_dist = std::abs(y - opp_score_row);
-                    opp_advancement += rows - row_dist;
-
-                    // BFS distance
-                    auto result = bfs_distance_to_goals_cached(
-                        board, x, y, opp_goals, opponent, rows, cols, score_cols, true);
-
-                    if (result.distance < INF)
-                    {
-                        opp_stone_distances.push_back({x, y, result.distance, result.path});
-                        opp_distances.push_back(result.distance);
-
-                        // Min distance
-                        if (result.distance < opp_min_distance)
-                        {
-                            opp_min_distance = result.distance;
-                        }
-
-                        // Distance buckets
-                        if (result.distance <= 2)
-                            opp_stones_within_2++;
-                        if (result.distance <= 4)
-                            opp_stones_within_4++;
-                        if (result.distance <= 6)
-                            opp_stones_within_6++;
-                        opp_proximity_score += std::pow(2, 35.0 - std::min(result.distance, 35.0)) * 1000.0;
-                        if (result.distance <= 1)
-                        {
-                            opp_proximity_score += 1e14;
-                        }
-                        else if (result.distance <= 2)
-                        {
-                            opp_proximity_score += 1e12;
-                        }
-                        else if(    result.distance <= 3)
-                        {
-                            opp_proximity_score += 1e11;
-                        }
-                        else if (result.distance <= 4)
-                        {
-                            opp_proximity_score += 1e10;
-                        }
-                    }
-
-                    // Check if blocked by my pieces
-                    std::vector<std::pair<int, int>> dirs = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-                    bool is_blocked = false;
-                    for (auto [dx, dy] : dirs)
-                    {
-                        int nx = x + dx, ny = y + dy;
-                        if (in_bounds(nx, ny, rows, cols))
-                        {
-                            const Cell &neighbor = board[ny][nx];
-                            if (!neighbor.isEmpty() && neighbor.owner == player)
-                            {
-                                is_blocked = true;
-                            }
-                            if (neighbor.isEmpty())
-                            {
-                                opp_mobility++;
-                            }
-                        }
-                    }
-                    if (is_blocked)
-                    {
-                        opp_stones_blocked++;
-                    }
-                }
-                // === RIVERS ===
-                else if (cell.side == "river")
-                {
-                    if (cell.owner == player)
-                    {
-                        my_river_count++;
-
-                        if (std::abs(y - my_score_row) <= 1)
-                        {
-                            my_rivers_near_goal++;
-                            my_proximity_score += 1e10;
-                        }
-
-                        if (cell.orientation == "horizontal")
-                        {
-                            my_rivers_horizontal++;
-                        }
-                        else if (cell.orientation == "vertical")
-                        {
-                            my_rivers_vertical++;
-                        }
-
-                        for (const auto &stone : my_stone_distances)
-                        {
-                            if (std::abs(x - stone.x) + std::abs(y - stone.y) <= 1)
-                            {
-                                rivers_near_us++;
-                                my_proximity_score += 5e8;
-                            }
-                        }
-
-                        for (const auto &opp_stone : opp_stone_distances)
-                        {
-                            bool in_path = false;
-                            for (const auto &p : opp_stone.path)
-                            {
-                                if (p.x == x && p.y == y)
-                                {
-                                    in_path = true;
-                                    break;
-                                }
-                            }
-                            if (in_path)
-                            {
-                                rivers_near_us++;
-                            }
-                        }
-                    }
-                    else if (cell.owner == opponent)
-                    {
-                        opp_river_count++;
-
-                        if (std::abs(y - opp_score_row) <= 2)
-                        {
-                            opp_rivers_near_goal++;
-                        }
-                        for (const auto &stone : my_stone_distances)
-                        {
-                            if (std::abs(x - stone.x) + std::abs(y - stone.y) <= 1)
-                            {
-                                rivers_near_us++;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        // Path diversity (clear paths to goal)
-        int my_clear_paths_to_goal = 0;
-        for (int x=0; x<cols; x++)
-        {
-            if (my_score_row == top_score_row())
-            {
-                bool has_obstacle = false;
-                for (int y = my_score_row + 1; y < opp_score_row; y++)
-                {
-                    if (!board[y][x].isEmpty() && board[y][x].side == "river" && board[y][x].orientation == "vertical")
-                    {
-                        my_clear_paths_to_goal++;
-                        break;
-                    }
-                    if (!board[y][x].isEmpty() && board[y][x].owner == opponent)
-                    {
-                        has_obstacle = true;
-                        break;
-                    }
-                }
-                // if (!has_obstacle) {
-                //     my_clear_paths_to_goal++;
-                // }
-
-                has_obstacle = false;
-                for (int y = my_score_row - 1; y >= 0; y--)
-                {
-                    if (!board[y][x].isEmpty() && board[y][x].side == "river" && board[y][x].orientation == "vertical")
-                    {
-                        my_clear_paths_to_goal++;
-                        break;
-                    }
-                    if (!board[y][x].isEmpty() && board[y][x].owner == opponent)
-                    {
-                        has_obstacle = true;
-                        break;
-                    }
-                }
-                // if (!has_obstacle) {
-                //     my_clear_paths_to_goal++;
-                // }
-            }
-            else if (my_score_row == bottom_score_row(rows))
-            {
-                bool has_obstacle = false;
-                for (int y = my_score_row - 1; y > opp_score_row; y--)
-                {
-                    if (!board[y][x].isEmpty() && board[y][x].side == "river" && board[y][x].orientation == "vertical")
-                    {
-                        my_clear_paths_to_goal++;
-                        break;
-                    }
-                    if (!board[y][x].isEmpty() && board[y][x].owner == opponent)
-                    {
-                        has_obstacle = true;
-                        break;
-                    }
-                }
-                // if (!has_obstacle) {
-                //     my_clear_paths_to_goal++;
-                // }
-
-                has_obstacle = false;
-                for (int y = my_score_row + 1; y < rows; y++)
-                {
-                    if (!board[y][x].isEmpty() && board[y][x].side == "river" && board[y][x].orientation == "vertical")
-                    {
-                        my_clear_paths_to_goal++;
-                        break;
-                    }
-                    if (!board[y][x].isEmpty() && board[y][x].owner == opponent)
-                    {
-                        has_obstacle = true;
-                        break;
-                    }
-                }
-                // if (!has_obstacle) {
-                //     my_clear_paths_to_goal++;
-                // }
-            }
-        }
-        for (int x = *std::min_element(score_cols.begin(), score_cols.end()) - 1; x >= 0; x--)
-        {
-            bool has_obstacle = false;
-            if (!board[my_score_row][x].isEmpty() && board[my_score_row][x].side == "river" && board[my_score_row][x].orientation == "horizontal")
-            {
-                my_clear_paths_to_goal++;
-                break;
-            }
-            if (!board[my_score_row][x].isEmpty() && board[my_score_row][x].owner == opponent)
-            {
-                has_obstacle = true;
-                break;
-            }
-
-            has_obstacle = false;
-            if (!board[my_score_row+1][x].isEmpty() && board[my_score_row+1][x].side == "river" && board[my_score_row+1][x].orientation == "horizontal")
-            {
-                my_clear_paths_to_goal++;
-                break;
-            }
-            if (!board[my_score_row+1][x].isEmpty() && board[my_score_row+1][x].owner == opponent)
-            {
-                has_obstacle = true;
-                break;
-            }
-
-            has_obstacle = false;
-            if (!board[my_score_row-1][x].isEmpty() && board[my_score_row-1][x].side == "river" && board[my_score_row-1][x].orientation == "horizontal")
-            {
-                my_clear_paths_to_goal++;
-                break;
-            }
-            if (!board[my_score_row-1][x].isEmpty() && board[my_score_row-1][x].owner == opponent)
-            {
-                has_obstacle = true;
-                break;
-            }
-        }
-        for( int x = *std::max_element(score_cols.begin(), score_cols.end()) + 1; x < cols; x++)
-        {
-            bool has_obstacle = false;
-            if (!board[my_score_row][x].isEmpty() && board[my_score_row][x].side == "river" && board[my_score_row][x].orientation == "horizontal")
-            {
-                my_clear_paths_to_goal++;
-                break;
-            }
-            if (!board[my_score_row][x].isEmpty() && board[my_score_row][x].owner == opponent)
-            {
-                has_obstacle = true;
-                break;
-            }
-
-            has_obstacle = false;
-            if (!board[my_score_row+1][x].isEmpty() && board[my_score_row+1][x].side == "river" && board[my_score_row+1][x].orientation == "horizontal")
-            {
-                my_clear_paths_to_goal++;
-                break;
-            }
-            if (!board[my_score_row+1][x].isEmpty() && board[my_score_row+1][x].owner == opponent)
-            {
-                has_obstacle = true;
-                break;
-            }
-
-            has_obstacle = false;
-            if (!board[my_score_row-1][x].isEmpty() && board[my_score_row-1][x].side == "river" && board[my_score_row-1][x].orientation == "horizontal")
-            {
-                my_clear_paths_to_goal++;
-                break;
-            }
-            if (!board[my_score_row-1][x].isEmpty() && board[my_score_row-1][x].owner == opponent)
-            {
-                has_obstacle = true;
-                break;
-            }
-        }
-
-        // Blocking pieces (tactical)
-        // int direction = (player == "circle") ? 1 : -1;
-        // for (int x : score_cols)
-        // {
-        //     int y = opp_score_row;
-        //     while (y != my_score_row && y >= 0 && y < rows)
-        //     {
-        //         if (!board[y][x].isEmpty() && board[y][x].owner == player)
-        //         {
-        //             my_blocking_pieces++;
-        //             break;
-        //         }
-        //         y += direction;
-        //     }
-        // }
-
-        // ========== APPLY LEARNED WEIGHTS ==========
-
-        // Distance Features
-        // score += my_stones_within_2  * 1e6;
-        // score += my_stones_within_4  * 1e6;
-        // score += my_stones_within_6  * 1e6;
-
-        // score -= opp_stones_within_2 * 1e3;
-        // score -= opp_stones_within_4 * 1e3;
-        // score -= opp_stones_within_6 * 1e3;
-
-        // Proximity scores
-        score += my_proximity_score;
-        score -= opp_proximity_score;
-
-        // Min distances
-        score -= my_min_distance * 1e5;
-        score += opp_min_distance * 1e7;
-
-        // Row-based distances
-        score += my_stones_within_1_rows * 1e6;
-
-        // River features
-        score += my_river_count  * 1e4;
-        score += my_rivers_near_goal * 1e6;
-        score += rivers_near_us * 1e6;
-        score += my_rivers_horizontal * 1e5;
-        score += my_rivers_vertical * 1e6;
-
-        score -= opp_river_count * 1e4;
-        score -= opp_rivers_near_goal * 1e3;
-
-        // Blocking features
-        score += opp_stones_blocked * 1e8;
-        // score += my_blocking_pieces * 1e6;
-
-        // Tempo features
-        score += my_advancement * 1e5;
-        score -= opp_advancement * 1e5;
-        // score += (my_advancement - opp_advancement) * LearnedWeights::ADVANCEMENT_DIFF * 1e2;
-
-        // Path diversity
-        score += my_clear_paths_to_goal * 1e12;
-
-        return score;
-    }
-    std::vector<std::vector<Cell>> apply_move(
-        const std::vector<std::vector<Cell>> &board,
-        const std::unordered_map<std::string, std::string> &move,
-        const std::string &current_player,
-        int rows, int cols,
-        const std::vector<int> &score_cols)
-    {
-        auto new_board = board;
-        std::string action = move.at("action");
-        int from_x = std::stoi(move.at("from_x"));
-        int from_y = std::stoi(move.at("from_y"));
-
-        if (action == "move")
-        {
-            int to_x = std::stoi(move.at("to_x"));
-            int to_y = std::stoi(move.at("to_y"));
-            new_board[to_y][to_x] = new_board[from_y][from_x];
-            new_board[from_y][from_x] = Cell();
-        }
-        else if (action == "push")
-        {
-            int to_x = std::stoi(move.at("to_x"));
-            int to_y = std::stoi(move.at("to_y"));
-            int pushed_x = std::stoi(move.at("pushed_x"));
-            int pushed_y = std::stoi(move.at("pushed_y"));
-
-            new_board[pushed_y][pushed_x] = new_board[to_y][to_x];
-            new_board[to_y][to_x] = new_board[from_y][from_x];
-            new_board[from_y][from_x] = Cell();
-
-            if (new_board[to_y][to_x].side == "river")
-            {
-                new_board[to_y][to_x].side = "stone";
-                new_board[to_y][to_x].orientation = "";
-                GLOBAL_BFS_CACHE.clear();
-            }
-        }
-        else if (action == "flip")
-        {
-            if (new_board[from_y][from_x].side == "stone")
-            {
-                new_board[from_y][from_x].side = "river";
-                new_board[from_y][from_x].orientation = move.at("orientation");
-            }
-            else
-            {
-                new_board[from_y][from_x].side = "stone";
-                new_board[from_y][from_x].orientation = "";
-            }
-            GLOBAL_BFS_CACHE.clear();
-        }
-        else if (action == "rotate")
-        {
-            if (new_board[from_y][from_x].orientation == "horizontal")
-            {
-                new_board[from_y][from_x].orientation = "vertical";
-            }
-            else
-            {
-                new_board[from_y][from_x].orientation = "horizontal";
-            }
-            GLOBAL_BFS_CACHE.clear();
-        }
-
-        return new_board;
-    }
-
-    double minimax(
-        const std::vector<std::vector<Cell>> &board,
-        int depth,
-        double alpha,
-        double beta,
-        bool is_maximizing,
-        int rows, int cols,
-        const std::vector<int> &score_cols)
-    {
-        std::string winner = check_win(board, rows, cols, score_cols);
-        if (depth == 0 || !winner.empty())
-        {
-            return evaluate_board(board, rows, cols, score_cols);
-        }
-
-        std::string current_player = is_maximizing ? player : opponent;
-        auto moves = generate_all_valid_moves(board, current_player, rows, cols, score_cols);
-
-        if (moves.empty())
-        {
-            return evaluate_board(board, rows, cols, score_cols);
-        }
-
-        if (is_maximizing)
-        {
-            double max_eval = -std::numeric_limits<double>::infinity();
-            for (const auto &move : moves)
-            {
-                auto new_board = apply_move(board, move, current_player, rows, cols, score_cols);
-                double eval_score = minimax(new_board, depth - 1, alpha, beta, false, rows, cols, score_cols);
-                max_eval = std::max(max_eval, eval_score);
-                alpha = std::max(alpha, eval_score);
-                if (beta <= alpha)
-                    break;
-            }
-            return max_eval;
-        }
-        else
-        {
-            double min_eval = std::numeric_limits<double>::infinity();
-            for (const auto &move : moves)
-            {
-                auto new_board = apply_move(board, move, current_player, rows, cols, score_cols);
-                double eval_score = minimax(new_board, depth - 1, alpha, beta, true, rows, cols, score_cols);
-                min_eval = std::min(min_eval, eval_score);
-                beta = std::min(beta, eval_score);
-                if (beta <= alpha)
-                    break;
-            }
-            return min_eval;
-        }
-    }
-
-    Move choose(
-        const std::vector<std::vector<std::unordered_map<std::string, std::string>>> &py_board,
-        int rows, int cols,
-        const std::vector<int> &score_cols,
-        double current_player_time,
-        double opponent_time)
-    {
-        GLOBAL_BFS_CACHE.clear();
-        // Convert Python board to C++ board
-        std::vector<std::vector<Cell>> board(rows, std::vector<Cell>(cols));
-        for (int y = 0; y < rows; y++)
-        {
-            for (int x = 0; x < cols; x++)
-            {
-                const auto &cell_dict = py_board[y][x];
-                if (!cell_dict.empty())
-                {
-                    Cell cell;
-                    if (cell_dict.count("owner"))
-                        cell.owner = cell_dict.at("owner");
-                    if (cell_dict.count("side"))
-                        cell.side = cell_dict.at("side");
-                    if (cell_dict.count("orientation"))
-                        cell.orientation = cell_dict.at("orientation");
-                    board[y][x] = cell;
-                }
-            }
-        }
-
-        // Opening book
-        std::vector<std::unordered_map<std::string, std::string>> opening_book;
-        if (player == "square")
-        {
-            if (rows == 13)
-            {
-                opening_book = {
-                    {{"action", "push"}, {"from_x", "3"}, {"from_y", "4"}, {"to_x", "3"}, {"to_y", "3"}, {"pushed_x", "3"}, {"pushed_y", "2"}},
-                    {{"action", "flip"}, {"from_x", "4"}, {"from_y", "3"}, {"orientation", "horizontal"}},
-                    {{"action", "move"}, {"from_x", "3"}, {"from_y", "3"}, {"to_x", "0"}, {"to_y", "3"}},
-                    {{"action", "push"}, {"from_x", "8"}, {"from_y", "4"}, {"to_x", "8"}, {"to_y", "3"}, {"pushed_x", "8"}, {"pushed_y", "2"}},
-                    {{"action", "flip"}, {"from_x", "0"}, {"from_y", "3"}, {"orientation", "vertical"}},
-                };
-            }
-            else if (rows == 15)
-            {
-                opening_book = {
-                    {{"action", "push"}, {"from_x", "3"}, {"from_y", "4"}, {"to_x", "3"}, {"to_y", "3"}, {"pushed_x", "3"}, {"pushed_y", "2"}},
-                    {{"action", "flip"}, {"from_x", "4"}, {"from_y", "3"}, {"orientation", "horizontal"}},
-                    {{"action", "move"}, {"from_x", "3"}, {"from_y", "3"}, {"to_x", "0"}, {"to_y", "3"}},
-                    {{"action", "push"}, {"from_x", "9"}, {"from_y", "4"}, {"to_x", "9"}, {"to_y", "3"}, {"pushed_x", "9"}, {"pushed_y", "2"}},
-                    {{"action", "flip"}, {"from_x", "0"}, {"from_y", "3"}, {"orientation", "vertical"}},
-                };
-            }
-            else if (rows == 17)
-            {
-                opening_book = {
-                    {{"action", "push"}, {"from_x", "4"}, {"from_y", "4"}, {"to_x", "4"}, {"to_y", "3"}, {"pushed_x", "4"}, {"pushed_y", "2"}},
-                    {{"action", "flip"}, {"from_x", "5"}, {"from_y", "3"}, {"orientation", "horizontal"}},
-                    {{"action", "move"}, {"from_x", "4"}, {"from_y", "3"}, {"to_x", "0"}, {"to_y", "3"}},
-                    {{"action", "push"}, {"from_x", "11"}, {"from_y", "4"}, {"to_x", "11"}, {"to_y", "3"}, {"pushed_x", "11"}, {"pushed_y", "2"}},
-                    {{"action", "flip"}, {"from_x", "0"}, {"from_y", "3"}, {"orientation", "vertical"}},
-                };
-            }
-        }
-        else
-        {
-            if (rows == 13)
-            {
-                opening_book = {
-                    {{"action", "push"}, {"from_x", "3"}, {"from_y", "8"}, {"to_x", "3"}, {"to_y", "9"}, {"pushed_x", "3"}, {"pushed_y", "10"}},
-                    {{"action", "flip"}, {"from_x", "4"}, {"from_y", "9"}, {"orientation", "horizontal"}},
-                    {{"action", "move"}, {"from_x", "3"}, {"from_y", "9"}, {"to_x", "0"}, {"to_y", "9"}},
-                    {{"action", "push"}, {"from_x", "8"}, {"from_y", "8"}, {"to_x", "8"}, {"to_y", "9"}, {"pushed_x", "8"}, {"pushed_y", "10"}},
-                    {{"action", "flip"}, {"from_x", "0"}, {"from_y", "9"}, {"orientation", "vertical"}},
-                };
-            }
-            else if (rows == 15)
-            {
-                opening_book = {
-                    {{"action", "push"}, {"from_x", "3"}, {"from_y", "10"}, {"to_x", "3"}, {"to_y", "11"}, {"pushed_x", "3"}, {"pushed_y", "12"}},
-                    {{"action", "flip"}, {"from_x", "4"}, {"from_y", "11"}, {"orientation", "horizontal"}},
-                    {{"action", "move"}, {"from_x", "3"}, {"from_y", "11"}, {"to_x", "0"}, {"to_y", "11"}},
-                    {{"action", "push"}, {"from_x", "9"}, {"from_y", "10"}, {"to_x", "9"}, {"to_y", "11"}, {"pushed_x", "9"}, {"pushed_y", "12"}},
-                    {{"action", "flip"}, {"from_x", "0"}, {"from_y", "11"}, {"orientation", "vertical"}},
-                };
-            }
-            else if (rows == 17)
-            {
-                opening_book = {
-                    {{"action", "push"}, {"from_x", "4"}, {"from_y", "12"}, {"to_x", "4"}, {"to_y", "13"}, {"pushed_x", "4"}, {"pushed_y", "14"}},
-                    {{"action", "flip"}, {"from_x", "5"}, {"from_y", "13"}, {"orientation", "horizontal"}},
-                    {{"action", "move"}, {"from_x", "4"}, {"from_y", "13"}, {"to_x", "0"}, {"to_y", "13"}},
-                    {{"action", "push"}, {"from_x", "11"}, {"from_y", "12"}, {"to_x", "11"}, {"to_y", "13"}, {"pushed_x", "11"}, {"pushed_y", "14"}},
-                    {{"action", "flip"}, {"from_x", "0"}, {"from_y", "13"}, {"orientation", "vertical"}},
-                };
-            }
-        }
-        // Use opening book for first few moves
-        if (moves < static_cast<int>(opening_book.size()))
-        {
-            auto candidate = opening_book[moves];
-            auto test_board = apply_move(board, candidate, player, rows, cols, score_cols);
-
-            // Simple validation - if move changes board, it's valid
-            bool valid = false;
-            for (int y = 0; y < rows && !valid; y++)
-            {
-                for (int x = 0; x < cols && !valid; x++)
-                {
-                    if (!(board[y][x].owner == test_board[y][x].owner &&
-                          board[y][x].side == test_board[y][x].side &&
-                          board[y][x].orientation == test_board[y][x].orientation))
-                    {
-                        valid = true;
-                    }
-                }
-            }
-
-            if (valid)
-            {
-                moves++;
-
-                // Track in last_moves
-                last_moves.push_back(candidate);
-                if (last_moves.size() > 3)
-                {
-                    last_moves.erase(last_moves.begin());
-                }
-
-                Move result;
-                result.action = candidate.at("action");
-                result.from_pos = {std::stoi(candidate.at("from_x")), std::stoi(candidate.at("from_y"))};
-                if (candidate.count("to_x"))
-                {
-                    result.to_pos = {std::stoi(candidate.at("to_x")), std::stoi(candidate.at("to_y"))};
-                }
-                if (candidate.count("pushed_x"))
-                {
-                    result.pushed_to = {std::stoi(candidate.at("pushed_x")), std::stoi(candidate.at("pushed_y"))};
-                }
-                if (candidate.count("orientation"))
-                {
-                    result.orientation = candidate.at("orientation");
-                }
-                return result;
-            }
-        }
-
-        // Generate and evaluate moves
-        auto valid_moves = generate_all_valid_moves(board, player, rows, cols, score_cols);
-        if (valid_moves.empty())
-        {
-            return Move();
-        }
-
-        auto river_opportunities = find_river_creation_opportunities(board, rows, cols, score_cols);
-        auto defensive_rivers = find_defensive_river_placements(board, rows, cols, score_cols);
-
-        double best_score = -std::numeric_limits<double>::infinity();
-        std::vector<std::unordered_map<std::string, std::string>> best_moves;
-        double alpha = -std::numeric_limits<double>::infinity();
-        double beta = std::numeric_limits<double>::infinity();
-
-        auto my_goals = get_my_goal_cells(rows, cols, score_cols);
-
-        for (const auto &move : valid_moves)
-        {
-            auto new_board = apply_move(board, move, player, rows, cols, score_cols);
-            double score = minimax(new_board, MAX_DEPTH - 1, alpha, beta, false, rows, cols, score_cols);
-
-            // Count current scoring stones for urgency multiplier
-            int my_scoring_count = 0;
-            for (int x : score_cols)
-            {
-                int my_score_row = (player == "circle") ? top_score_row() : bottom_score_row(rows);
-                const Cell &cell = new_board[my_score_row][x];
-                if (!cell.isEmpty() && cell.owner == player && cell.side == "stone")
-                {
-                    my_scoring_count++;
-                }
-            }
-            // Urgency multiplier: 3 stones = push HARD for 4th!
-            double urgency = 2.0 + my_scoring_count;
-
-            std::string action = move.at("action");
-            int from_x = std::stoi(move.at("from_x"));
-            int from_y = std::stoi(move.at("from_y"));
-
-            // RIVER PUSH - very valuable for advancing multiple spaces
-            if (action == "push" && move.count("pushed_x"))
-            {
-                int to_x = std::stoi(move.at("to_x"));
-                int to_y = std::stoi(move.at("to_y"));
-                int pushed_x = std::stoi(move.at("pushed_x"));
-                int pushed_y = std::stoi(move.at("pushed_y"));
-
-                auto dist_before = bfs_distance_to_goals_cached(board, from_x, from_y, my_goals, player, rows, cols, score_cols);
-                auto dist_after = bfs_distance_to_goals_cached(new_board, to_x, to_y, my_goals, player, rows, cols, score_cols);
-                double improvement = dist_before.distance - dist_after.distance;
-
-                int push_dist = std::abs(to_x - pushed_x) + std::abs(to_y - pushed_y);
-                if (push_dist > 1)
-                { // River push
-                    score += push_dist * 1000.0;
-
-                    // Extra bonus if pushed piece gets close to goal
-                    if (is_my_score_cell(pushed_x, pushed_y, player, rows, cols, score_cols))
-                    {
-                        score += 1e14; // Pushed directly into goal!
-                    }
-                    else
-                    {
-                        const Cell &piece = board[from_y][from_x];
-                        if (!piece.isEmpty() && piece.side == "stone")
-                        {
-                            auto dist_after = bfs_distance_to_goals_cached(new_board, pushed_x, pushed_y, my_goals, player, rows, cols, score_cols);
-                            if (dist_after.distance < 3)
-                            {
-                                score += 80000000.0;
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    auto my_goals = get_my_goal_cells(rows, cols, score_cols);
-                    score += (dist_before.distance == 0 || (std::find(my_goals.begin(), my_goals.end(), Position(to_x, to_y)) != my_goals.end() && std::find(my_goals.begin(), my_goals.end(), Position(pushed_x, pushed_y)) == my_goals.end())) ? 1000 : std::pow(2, 35.0 - std::min(dist_after.distance, 35.0)) * 1000.0;
-                }
-            }
-            // RIVER MOVEMENT - bonus for using rivers to advance
-            else if (action == "move" && move.count("to_x"))
-            {
-                int to_x = std::stoi(move.at("to_x"));
-                int to_y = std::stoi(move.at("to_y"));
-                int move_dist = std::abs(from_x - to_x) + std::abs(from_y - to_y);
-
-                const Cell &piece = board[from_y][from_x];
-                if (!piece.isEmpty() && piece.side == "stone")
-                {
-                    // Calculate BFS distance improvement
-                    auto dist_before = bfs_distance_to_goals_cached(board, from_x, from_y, my_goals, player, rows, cols, score_cols);
-                    auto dist_after = bfs_distance_to_goals_cached(new_board, to_x, to_y, my_goals, player, rows, cols, score_cols);
-                    double improvement = dist_before.distance - dist_after.distance;
-
-                    if (move_dist > 1)
-                    { // Used river to move
-                        // score += move_dist * 200.0;  // Reward river usage
-                        // score += std::pow(improvement, 3) * 100000.0;  // Reward progress toward goal
-                        score += dist_before.distance == 0 ? 100 : std::pow(2, 35.0 - std::min(dist_after.distance, 35.0)) * 1000.0;
-                        if (dist_after.distance == 0 && dist_before.distance > 0)
-                    {
-                        score += 1e14;
-                    }
-                    else if (dist_after.distance == 1 && dist_before.distance > 1)
-                    {
-                        score += 1e12;
-                    }
-                    else if (dist_after.distance == 2 && dist_before.distance > 2)
-                    {
-                        score += 1e11;
-                    }
-                    else if (dist_after.distance == 3 && dist_before.distance > 3)
-                    {
-                        score += 1e10;
-                    }
-                    else if (dist_after.distance == 4 && dist_before.distance > 4)
-                    {
-                        score += 1e9;
-                    }
-                    else if (dist_after.distance == 5 && dist_before.distance > 5)
-                    {
-                        score += 1e8;
-                    }
-                    }
-                    else
-                    { // Regular 1-step move
-                        score += dist_before.distance == 0 ? 100 : std::pow(2, 35.0 - std::min(dist_after.distance, 35.0)) * 500.0;
-                        // if (dist_after.distance <= 2) {
-                        //     score += 50000.0;
-                        // }
-                        if (dist_after.distance == 0 && dist_before.distance > 0)
-                    {
-                        score += 1e14;
-                    }
-                    else if (dist_after.distance == 1 && dist_before.distance > 1)
-                    {
-                        score += 1e11;
-                    }
-                    else if (dist_after.distance == 2 && dist_before.distance > 2)
-                    {
-                        score += 1e10;
-                    }
-                    else if (dist_after.distance == 3 && dist_before.distance > 3)
-                    {
-                        score += 1e9;
-                    }
-                    else if (dist_after.distance == 4 && dist_before.distance > 4)
-                    {
-                        score += 1e7;
-                    }
-                    else if (dist_after.distance == 5 && dist_before.distance > 5)
-                    {
-                        score += 1e6;
-                    }
-                    }
-                    // Extra bonus if move gets us into scoring position
-                    // if (dist_after.distance == 0 && dist_before.distance > 0)
-                    // {
-                    //     score += 1e14;
-                    // }
-                    // else if (dist_after.distance == 1 && dist_before.distance > 1)
-                    // {
-                    //     score += 1e12;
-                    // }
-                    // else if (dist_after.distance == 2 && dist_before.distance > 2)
-                    // {
-                    //     score += 1e11;
-                    // }
-                    // else if (dist_after.distance == 3 && dist_before.distance > 3)
-                    // {
-                    //     score += 1e10;
-                    // }
-                    // else if (dist_after.distance == 4 && dist_before.distance > 4)
-                    // {
-                    //     score += 1e8;
-                    // }
-                    // else if (dist_after.distance == 5 && dist_before.distance > 5)
-                    // {
-                    //     score += 1e6;
-                    // }
-                    if (dist_after.distance == 6 && dist_before.distance > 6) {
-                        score += 1e3;
-                    }
-                    else if (dist_after.distance == 7 && dist_before.distance > 7) {
-                        score += 1e2;
-                    }
-                    else if (dist_after.distance == 8 && dist_before.distance > 8) {
-                        score += 1e1;
-                    }
-                }
-            }
-            // FLIP TO RIVER - strategic value
-            else if (action == "flip" && move.count("orientation"))
-            {
-                std::string orientation = move.at("orientation");
-
-                // Check if this flip is in our strategic opportunities
-                for (size_t i = 0; i < std::min(size_t(3), river_opportunities.size()); i++)
-                {
-                    const auto &opp = river_opportunities[i];
-                    if (opp.from_x == from_x && opp.from_y == from_y && opp.orientation == orientation)
-                    {
-                        score += opp.value;
-                        break;
-                    }
-                }
-
-                // Check if this flip is defensive
-                for (size_t i = 0; i < std::min(size_t(4), defensive_rivers.size()); i++)
-                {
-                    const auto &def = defensive_rivers[i];
-                    if (def.from_x == from_x && def.from_y == from_y && def.orientation == orientation)
-                    {
-                        score += def.value;
-                        break;
-                    }
-                }
-
-                // General bonus for creating rivers in forward positions
-                const Cell &piece = board[from_y][from_x];
-                if (!piece.isEmpty())
-                {
-                    int my_score_row = my_goals[0].y;
-                    if (std::abs(from_y - my_score_row) <= 4)
-                    { // Near goal area
-                        score += 3000.0;
-                    }
-                }
-            }
-            // ROTATE RIVER - adjust flow direction
-            else if (action == "rotate")
-            {
-                score += 1000.0;
-            }
-
-            // Track best moves
-            if (score > best_score)
-            {
-                best_score = score;
-                best_moves = {move};
-            }
-            else if (std::abs(score - best_score) < 100.0)
-            { // Similar scores
-                best_moves.push_back(move);
-            }
-
-            alpha = std::max(alpha, score);
-        }
-
-        // Choose from best moves
-        std::unordered_map<std::string, std::string> chosen_move;
-        if (!best_moves.empty())
-        {
-            // Prefer river-utilizing moves if scores are similar
-            std::vector<std::unordered_map<std::string, std::string>> river_moves;
-            for (const auto &m : best_moves)
-            {
-                if ((m.at("action") == "push" || m.at("action") == "move") &&
-                    m.count("to_x") && m.count("from_x"))
-                {
-                    int fx = std::stoi(m.at("from_x"));
-                    int fy = std::stoi(m.at("from_y"));
-                    int tx = std::stoi(m.at("to_x"));
-                    int ty = std::stoi(m.at("to_y"));
-                    if (std::abs(fx - tx) + std::abs(fy - ty) > 1)
-                    {
-                        river_moves.push_back(m);
-                    }
-                }
-            }
-
-            if (!river_moves.empty())
-            {
-                std::uniform_int_distribution<> dist(0, river_moves.size() - 1);
-                chosen_move = river_moves[dist(rng)];
-            }
-            else
-            {
-                std::uniform_int_distribution<> dist(0, best_moves.size() - 1);
-                chosen_move = best_moves[dist(rng)];
-            }
-        }
-        else
-        {
-            std::uniform_int_distribution<> dist(0, valid_moves.size() - 1);
-            chosen_move = valid_moves[dist(rng)];
-        }
-
-        // ========== REPETITION AVOIDANCE ==========
-        // Add chosen move to last_moves
-        last_moves.push_back(chosen_move);
-        if (last_moves.size() > 6)
-        {
-            last_moves.erase(last_moves.begin());
-        }
-
-        // Count how many times this move appears in last_moves
-        int move_count = 0;
-        for (const auto &past_move : last_moves)
-        {
-            // Compare moves (same action and positions)
-            bool same = (past_move.at("action") == chosen_move.at("action") &&
-                         past_move.at("from_x") == chosen_move.at("from_x") &&
-                         past_move.at("from_y") == chosen_move.at("from_y"));
-
-            if (same && chosen_move.count("to_x"))
-            {
-                same = same && (past_move.count("to_x") &&
-                                past_move.at("to_x") == chosen_move.at("to_x") &&
-                                past_move.at("to_y") == chosen_move.at("to_y"));
-            }
-
-            if (same && chosen_move.count("orientation"))
-            {
-                same = same && (past_move.count("orientation") &&
-                                past_move.at("orientation") == chosen_move.at("orientation"));
-            }
-
-            if (same)
-                move_count++;
-        }
-        
-        // auto my_goals = get_my_goal_cells(rows, cols, score_cols);
-        auto opp_goals = get_opponent_goal_cells(rows, cols, score_cols);
-        int my_score_row = my_goals[0].y;
-        int opp_score_row = opp_goals[0].y;
-
-        int my_scoring_stones = 0;
-        int opp_scoring_stones = 0;
-
-        for (int x : score_cols)
-        {
-            const Cell &cell_my = board[my_score_row][x];
-            if (!cell_my.isEmpty() && cell_my.owner == player && cell_my.side == "stone")
-            {
-                my_scoring_stones++;
-            }
-            const Cell &cell_opp = board[opp_score_row][x];
-            if (!cell_opp.isEmpty() && cell_opp.owner == opponent && cell_opp.side == "stone")
-            {
-                opp_scoring_stones++;
-            }
-        }
-
-        
-
-        // If move repeated too many times, choose different move
-        if (move_count > repetition_limit && !((my_scoring_stones == 0 && opp_scoring_stones >= 2) || (my_scoring_stones <=1 && opp_scoring_stones >= 3)))
-        {
-            // Find alternative moves that haven't been repeated
-            std::vector<std::unordered_map<std::string, std::string>> alt_moves;
-
-            for (const auto &m : valid_moves)
-            {
-                // Count repetitions for this move
-                int m_count = 0;
-                for (const auto &past_move : last_moves)
-                {
-                    bool same = (past_move.at("action") == m.at("action") &&
-                                 past_move.at("from_x") == m.at("from_x") &&
-                                 past_move.at("from_y") == m.at("from_y"));
-
-                    if (same && m.count("to_x"))
-                    {
-                        same = same && (past_move.count("to_x") &&
-                                        past_move.at("to_x") == m.at("to_x") &&
-                                        past_move.at("to_y") == m.at("to_y"));
-                    }
-
-                    if (same && m.count("orientation"))
-                    {
-                        same = same && (past_move.count("orientation") &&
-                                        past_move.at("orientation") == m.at("orientation"));
-                    }
-
-                    if (same)
-                        m_count++;
-                }
-
-                // Add to alternatives if not repeated too much
-                if (m_count <= repetition_limit)
-                {
-                    alt_moves.push_back(m);
-                }
-            }
-
-            // Choose from alternatives if available
-            if (!alt_moves.empty())
-            {
-                std::uniform_int_distribution<> dist(0, alt_moves.size() - 1);
-                chosen_move = alt_moves[dist(rng)];
-
-                // Update last_moves with new choice
-                last_moves.pop_back(); // Remove the repeated move
-                last_moves.push_back(chosen_move);
-            }
-            // If all moves are repeated, stick with chosen_move (can't avoid repetition)
-        }
-
-        // Convert to Move struct
-        Move result;
-        result.action = chosen_move.at("action");
-        result.from_pos = {std::stoi(chosen_move.at("from_x")), std::stoi(chosen_move.at("from_y"))};
-        if (chosen_move.count("to_x"))
-        {
-            result.to_pos = {std::stoi(chosen_move.at("to_x")), std::stoi(chosen_move.at("to_y"))};
-        }
-        if (chosen_move.count("pushed_x"))
-        {
-            result.pushed_to = {std::stoi(chosen_move.at("pushed_x")), std::stoi(chosen_move.at("pushed_y"))};
-        }
-        if (chosen_move.count("orientation"))
-        {
-            result.orientation = chosen_move.at("orientation");
-        }
+#include <memory>
+#include <stdexcept>
+#include <string>
 
-        return result;
-    }
-};
+#include "agent_pool.h"
+#include "baselines.h"
+#include "eval.h"
+#include "game_log_reader.h"
+#include "memory.h"
+#include "search.h"
+#include "tracking.h"
+#include "verify.h"
+#include "workload.h"
 
-// ==================== PYBIND11 BINDINGS ====================
+namespace py = pybind11;
 
 PYBIND11_MODULE(student_agent_module, m)
 {
@@ -2042,6 +32,51 @@ PYBIND11_MODULE(student_agent_module, m)
         .def_readwrite("pushed_to", &Move::pushed_to)
         .def_readwrite("orientation", &Move::orientation);
 
+    py::class_<MoveStats>(m, "MoveStats")
+        .def_readonly("move_number", &MoveStats::move_number)
+        .def_readonly("mode", &MoveStats::mode)
+        .def_readonly("clock", &MoveStats::clock)
+        .def_readonly("opponent_clock", &MoveStats::opponent_clock)
+        .def_readonly("expected_moves", &MoveStats::expected_moves)
+        .def_readonly("soft_budget", &MoveStats::soft_budget)
+        .def_readonly("hard_budget", &MoveStats::hard_budget)
+        .def_readonly("elapsed", &MoveStats::elapsed)
+        .def_readonly("depth", &MoveStats::depth)
+        .def_readonly("best_changes", &MoveStats::best_changes)
+        .def_readonly("extensions", &MoveStats::extensions)
+        .def_readonly("decision", &MoveStats::decision);
+
+    py::enum_<SearchMode>(m, "SearchMode")
+        .value("serial", SearchMode::Serial)
+        .value("ybwc", SearchMode::YoungBrothers);
+
+    py::enum_<RootDriver>(m, "RootDriver")
+        .value("alphabeta", RootDriver::AlphaBeta)
+        .value("mtdf", RootDriver::Mtdf);
+
+    py::class_<MemoryPolicy>(m, "MemoryPolicy")
+        .def(py::init<>())
+        .def_readwrite("transpositions", &MemoryPolicy::transpositions)
+        .def_readwrite("threats", &MemoryPolicy::threats);
+
+    py::class_<CacheStats>(m, "CacheStats")
+        .def_readonly("name", &CacheStats::name)
+        .def_readonly("bytes", &CacheStats::bytes)
+        .def_readonly("budget_bytes", &CacheStats::budget_bytes)
+        .def_readonly("entries", &CacheStats::entries)
+        .def_readonly("capacity", &CacheStats::capacity)
+        .def_readonly("probes", &CacheStats::probes)
+        .def_readonly("hits", &CacheStats::hits)
+        .def_property_readonly("occupancy", &CacheStats::occupancy)
+        .def_property_readonly("hit_rate", &CacheStats::hit_rate);
+
+    py::class_<MemoryReport>(m, "MemoryReport")
+        .def_readonly("budget", &MemoryReport::budget)
+        .def_readonly("tables", &MemoryReport::tables)
+        .def("total_bytes", &MemoryReport::total_bytes);
+
+    m.def("reset_threat_cache_counters", &reset_threat_cache_counters);
+
     py::class_<StudentAgent>(m, "StudentAgent")
         .def(py::init<const std::string &>())
         .def("choose", &StudentAgent::choose,
@@ -2050,5 +85,196 @@ PYBIND11_MODULE(student_agent_module, m)
              py::arg("cols"),
              py::arg("score_cols"),
              py::arg("current_player_time"),
-             py::arg("opponent_time"));
-}
\ No newline at end of file
+             py::arg("opponent_time"))
+        .def("eval_feature_stats", [](StudentAgent &)
+             { return eval_feature_stats(); })
+        .def("move_stats", &StudentAgent::move_stats)
+        .def("load_tablebases", &StudentAgent::load_tablebases, py::arg("dir"))
+        .def("set_move_time_cap", &StudentAgent::set_move_time_cap, py::arg("seconds"))
+        .def("ponder", &StudentAgent::ponder,
+             py::arg("board"),
+             py::arg("rows"),
+             py::arg("cols"),
+             py::arg("score_cols"),
+             py::arg("current_player_time"),
+             py::arg("opponent_time"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("stop_ponder", &StudentAgent::stop_ponder)
+        .def("set_seed", &StudentAgent::set_seed, py::arg("seed"))
+        .def("set_search_mode", &StudentAgent::set_search_mode, py::arg("mode"), py::arg("threads") = 0)
+        .def("set_root_driver", &StudentAgent::set_root_driver, py::arg("driver"))
+        .def("set_probcut", &StudentAgent::set_probcut, py::arg("enabled"), py::arg("threshold"))
+        .def("set_extensions", &StudentAgent::set_extensions, py::arg("enabled"))
+        .def("set_memory_budget", &StudentAgent::set_memory_budget, py::arg("bytes"),
+             py::arg("policy") = MemoryPolicy())
+        .def("memory_report", &StudentAgent::memory_report)
+        .def(
+            "choose_tracked",
+            [](StudentAgent &agent, const BoardTracker &tracker, double current_player_time, double opponent_time)
+            { return agent.choose_board(tracker.cells(), tracker.rows, tracker.cols, tracker.score_cols,
+                                        current_player_time, opponent_time); },
+            py::arg("tracker"),
+            py::arg("current_player_time"),
+            py::arg("opponent_time"))
+        .def(
+            "ponder_tracked",
+            [](StudentAgent &agent, const BoardTracker &tracker, double current_player_time, double opponent_time)
+            { return agent.ponder_board(tracker.cells(), tracker.rows, tracker.cols, tracker.score_cols,
+                                        current_player_time, opponent_time); },
+            py::arg("tracker"),
+            py::arg("current_player_time"),
+            py::arg("opponent_time"),
+            py::call_guard<py::gil_scoped_release>());
+
+    py::class_<WorkloadResult>(m, "WorkloadResult")
+        .def_readonly("games", &WorkloadResult::games)
+        .def_readonly("plies", &WorkloadResult::plies)
+        .def_readonly("seconds", &WorkloadResult::seconds);
+
+    m.def("run_training_workload", &run_training_workload,
+          py::arg("plies_per_game") = 24,
+          py::arg("seed") = 1,
+          py::call_guard<py::gil_scoped_release>());
+
+    py::enum_<BaselinePolicy>(m, "BaselinePolicy")
+        .value("random", BaselinePolicy::Random)
+        .value("greedy", BaselinePolicy::Greedy)
+        .value("one_ply", BaselinePolicy::OnePly)
+        .value("reference", BaselinePolicy::Reference);
+
+    py::class_<BaselineAgent>(m, "BaselineAgent")
+        .def(py::init<const std::string &, BaselinePolicy, uint32_t>(),
+             py::arg("player"),
+             py::arg("policy"),
+             py::arg("seed") = 1)
+        .def("choose", &BaselineAgent::choose,
+             py::arg("board"),
+             py::arg("rows"),
+             py::arg("cols"),
+             py::arg("score_cols"),
+             py::arg("current_player_time"),
+             py::arg("opponent_time"),
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("policy", &BaselineAgent::policy);
+
+    py::class_<MatchResult>(m, "MatchResult")
+        .def_readonly("games", &MatchResult::games)
+        .def_readonly("circle_wins", &MatchResult::circle_wins)
+        .def_readonly("square_wins", &MatchResult::square_wins)
+        .def_readonly("draws", &MatchResult::draws)
+        .def_readonly("plies", &MatchResult::plies)
+        .def_readonly("seconds", &MatchResult::seconds);
+
+    m.def("play_baseline_match", &play_baseline_match,
+          py::arg("circle"),
+          py::arg("square"),
+          py::arg("games"),
+          py::arg("rows") = 13,
+          py::arg("seed") = 1,
+          py::arg("threads") = 0,
+          py::call_guard<py::gil_scoped_release>());
+
+    // Checks only run inside searches in VERIFY_STATE builds
+    m.attr("VERIFY_STATE") = static_cast<bool>(VERIFY_STATE);
+    py::register_exception<VerifyError>(m, "VerifyError");
+    m.def("set_verify_interval", &set_verify_interval, py::arg("interval"));
+    m.def("verify_interval", &verify_interval);
+
+    py::class_<PositionTracker>(m, "PositionTracker")
+        .def(py::init<int, int, int, int>(),
+             py::arg("rows"),
+             py::arg("cols"),
+             py::arg("interval") = 4,
+             py::arg("repeats") = 3)
+        .def("set_cell", &PositionTracker::set_cell, py::arg("x"), py::arg("y"), py::arg("piece"))
+        .def("move_applied", &PositionTracker::move_applied)
+        .def("key", &PositionTracker::key)
+        .def("run_length", &PositionTracker::run_length)
+        .def("moves", &PositionTracker::moves);
+
+    py::class_<GameLogs::LoggedMove>(m, "LoggedMove")
+        .def_readonly("player", &GameLogs::LoggedMove::player)
+        .def_readonly("action", &GameLogs::LoggedMove::action)
+        .def_readonly("from_x", &GameLogs::LoggedMove::from_x)
+        .def_readonly("from_y", &GameLogs::LoggedMove::from_y)
+        .def_readonly("to_x", &GameLogs::LoggedMove::to_x)
+        .def_readonly("to_y", &GameLogs::LoggedMove::to_y)
+        .def_readonly("pushed_x", &GameLogs::LoggedMove::pushed_x)
+        .def_readonly("pushed_y", &GameLogs::LoggedMove::pushed_y)
+        .def_readonly("orientation", &GameLogs::LoggedMove::orientation)
+        .def_readonly("timestamp", &GameLogs::LoggedMove::timestamp)
+        .def_readonly("state", &GameLogs::LoggedMove::state)
+        .def_readonly("position", &GameLogs::LoggedMove::position);
+
+    py::class_<GameLogs::GameRecord>(m, "GameRecord")
+        .def_readonly("name", &GameLogs::GameRecord::name)
+        .def_readonly("error", &GameLogs::GameRecord::error)
+        .def_readonly("rows", &GameLogs::GameRecord::rows)
+        .def_readonly("cols", &GameLogs::GameRecord::cols)
+        .def_readonly("winner", &GameLogs::GameRecord::winner)
+        .def_readonly("circle_score", &GameLogs::GameRecord::circle_score)
+        .def_readonly("square_score", &GameLogs::GameRecord::square_score)
+        .def_readonly("duration", &GameLogs::GameRecord::duration)
+        .def_readonly("moves", &GameLogs::GameRecord::moves);
+
+    // for game in GameLogReader("game_logs.zip"): ... Games arrive in
+    // completion order; workers keep decoding while Python handles one.
+    py::class_<GameLogs::Reader>(m, "GameLogReader")
+        .def(py::init([](const std::string &path, int threads, size_t capacity)
+                      {
+                          auto reader = std::make_unique<GameLogs::Reader>(path, threads, capacity);
+                          if (!reader->error().empty())
+                              throw std::runtime_error(reader->error());
+                          return reader; }),
+             py::arg("path"),
+             py::arg("threads") = 0,
+             py::arg("capacity") = 0)
+        .def("__len__", &GameLogs::Reader::size)
+        .def("__iter__", [](GameLogs::Reader &reader) -> GameLogs::Reader &
+             { return reader; })
+        .def("__next__", [](GameLogs::Reader &reader)
+             {
+                 GameLogs::GameRecord record;
+                 bool more;
+                 {
+                     py::gil_scoped_release release;
+                     more = reader.next(record);
+                 }
+                 if (!more)
+                     throw py::stop_iteration();
+                 return record; });
+
+    py::class_<BoardTracker>(m, "BoardTracker")
+        .def(py::init<int, int>(), py::arg("rows"), py::arg("cols"))
+        .def("load", &BoardTracker::load, py::arg("code"))
+        .def("apply", &BoardTracker::apply, py::arg("move"), py::arg("player"), py::arg("checksum"))
+        .def("encode", &BoardTracker::encode)
+        .def("checksum", &BoardTracker::checksum)
+        .def("synced", &BoardTracker::synced)
+        .def("board", &BoardTracker::py_board)
+        .def_readonly("rows", &BoardTracker::rows)
+        .def_readonly("cols", &BoardTracker::cols);
+
+    py::class_<AgentPool>(m, "AgentPool")
+        .def(py::init<int, double>(), py::arg("threads") = 0, py::arg("time_slice") = 0.0)
+        .def("threads", &AgentPool::threads)
+        .def("set_time_slice", &AgentPool::set_time_slice, py::arg("seconds"))
+        .def("open_session", &AgentPool::open_session, py::arg("game_id"), py::arg("player"))
+        .def("close_session", &AgentPool::close_session, py::arg("game_id"), py::arg("player"))
+        .def("close_game", &AgentPool::close_game, py::arg("game_id"))
+        .def("session_count", &AgentPool::session_count)
+        .def("queued", &AgentPool::queued)
+        .def("submit", &AgentPool::submit,
+             py::arg("game_id"),
+             py::arg("player"),
+             py::arg("board"),
+             py::arg("rows"),
+             py::arg("cols"),
+             py::arg("score_cols"),
+             py::arg("current_player_time"),
+             py::arg("opponent_time"))
+        .def("ready", &AgentPool::ready, py::arg("ticket"))
+        .def("wait", &AgentPool::wait, py::arg("ticket"), py::call_guard<py::gil_scoped_release>())
+        .def("wait_any", &AgentPool::wait_any, py::arg("tickets"), py::arg("timeout"),
+             py::call_guard<py::gil_scoped_release>());
+}
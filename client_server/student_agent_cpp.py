@@ -38,6 +38,89 @@ def is_own_score_cell(x: int, y: int, player: str, rows: int, cols: int, score_c
     else:
         return (y == bottom_score_row(rows)) and (x in score_cols)
 
+def board_to_cpp(board: List[List[Any]]) -> List[List[Dict[str, str]]]:
+    """Convert an engine board of Piece objects to the format expected by C++."""
+    cpp_board = []
+    for row in board:
+        cpp_row = []
+        for cell in row:
+            if cell is None:
+                cpp_row.append({})  # Empty cell
+            else:
+                cell_dict = {
+                    "owner": cell.owner,
+                    "side": cell.side,
+                }
+                # Only add orientation if it exists and is not None
+                if hasattr(cell, "orientation") and cell.orientation is not None:
+                    cell_dict["orientation"] = cell.orientation
+                else:
+                    cell_dict["orientation"] = "horizontal"  # Default orientation
+                cpp_row.append(cell_dict)
+        cpp_board.append(cpp_row)
+    return cpp_board
+
+def move_from_cpp(cpp_move) -> Optional[Dict[str, Any]]:
+    """Translate a C++ Move to an engine-compatible dict."""
+    if cpp_move is None:
+        return None
+    move_dict = {
+        "action": cpp_move.action,
+        "from": cpp_move.from_pos,
+        "to": cpp_move.to_pos,
+    }
+    if cpp_move.action == "push":
+        move_dict["pushed_to"] = cpp_move.pushed_to
+    if cpp_move.action == "flip":
+        move_dict["orientation"] = cpp_move.orientation
+    return move_dict
+
+def move_to_cpp(move: Dict[str, Any]) -> Dict[str, str]:
+    """Translate an engine move dict to the C++ string map format."""
+    action = move["action"]
+    cpp_move = {
+        "action": action,
+        "from_x": str(move["from"][0]),
+        "from_y": str(move["from"][1]),
+    }
+    if action in ("move", "push"):
+        cpp_move["to_x"] = str(move["to"][0])
+        cpp_move["to_y"] = str(move["to"][1])
+    if action == "push":
+        cpp_move["pushed_x"] = str(move["pushed_to"][0])
+        cpp_move["pushed_y"] = str(move["pushed_to"][1])
+    if action == "flip" and move.get("orientation"):
+        cpp_move["orientation"] = move["orientation"]
+    return cpp_move
+
+class DeltaBoard:
+    """
+    Client copy of the server board, kept in sync from delta-format states
+    (see DELTA UPDATES in web_server.py). The native tracker checks every
+    move against the server's checksum.
+    """
+    def __init__(self, rows: int, cols: int):
+        self.tracker = student_agent.BoardTracker(rows, cols)
+        self.seq = None  # moves applied so far, None when out of sync
+
+    def update(self, state: Dict[str, Any]) -> bool:
+        """Bring the board up to `state`; False means a keyframe is needed."""
+        if "board_code" in state:
+            self.tracker.load(state["board_code"])
+        elif self.seq is not None and state["seq"] == self.seq + 1 and state.get("last_move"):
+            last = state["last_move"]
+            if not self.tracker.apply(move_to_cpp(last["move"]), last["player"], state["checksum"]):
+                self.seq = None
+                return False
+        elif state["seq"] != self.seq:
+            self.seq = None
+            return False
+        if self.tracker.checksum() != state["checksum"]:
+            self.seq = None
+            return False
+        self.seq = state["seq"]
+        return True
+
 class BaseAgent(ABC):
     """
     Abstract base class for all agents.
@@ -57,47 +140,43 @@ class StudentAgent(BaseAgent):
         self.agent = student_agent.StudentAgent(player)
 
     def choose(self, board: List[List[Any]], rows: int, cols: int, score_cols: List[int], current_player_time: float, opponent_time: float) -> Optional[Dict[str, Any]]:
-        # Convert board to the format expected by C++
-        cpp_board = []
-        for row in board:
-            cpp_row = []
-            for cell in row:
-                if cell is None:
-                    cpp_row.append({})  # Empty cell
-                else:
-                    cell_dict = {
-                        "owner": cell.owner,
-                        "side": cell.side,
-                    }
-                    # Only add orientation if it exists and is not None
-                    if hasattr(cell, "orientation") and cell.orientation is not None:
-                        cell_dict["orientation"] = cell.orientation
-                    else:
-                        cell_dict["orientation"] = "horizontal"  # Default orientation
-                    cpp_row.append(cell_dict)
-            cpp_board.append(cpp_row)
+        cpp_board = board_to_cpp(board)
         
         # Convert score_cols to list of ints (ensure it's the right type)
         cpp_score_cols = list(score_cols)
         
         cpp_move = self.agent.choose(cpp_board, int(rows), int(cols), cpp_score_cols, float(current_player_time), float(opponent_time))
-        if cpp_move is None:
-            return None
-
-        # Translate to engine-compatible dict
-        move_dict = {
-            "action": cpp_move.action,
-            "from": cpp_move.from_pos,
-            "to": cpp_move.to_pos,
-        }
-        if cpp_move.action == "push":
-            move_dict["pushed_to"] = cpp_move.pushed_to
-        if cpp_move.action == "flip":
-            move_dict["orientation"] = cpp_move.orientation
-
-        return move_dict
+        return move_from_cpp(cpp_move)
+
+    def ponder(self, board: List[List[Any]], rows: int, cols: int, score_cols: List[int], current_player_time: float, opponent_time: float) -> bool:
+        """Search ahead on the opponent's time; blocks until done or stop_ponder() is called."""
+        return self.agent.ponder(board_to_cpp(board), int(rows), int(cols), list(score_cols), float(current_player_time), float(opponent_time))
+
+    def stop_ponder(self):
+        self.agent.stop_ponder()
+
+    def choose_tracked(self, board: DeltaBoard, current_player_time: float, opponent_time: float) -> Optional[Dict[str, Any]]:
+        """choose() on a DeltaBoard, without converting the board."""
+        return move_from_cpp(self.agent.choose_tracked(board.tracker, float(current_player_time), float(opponent_time)))
+
+    def ponder_tracked(self, board: DeltaBoard, current_player_time: float, opponent_time: float) -> bool:
+        return self.agent.ponder_tracked(board.tracker, float(current_player_time), float(opponent_time))
     
 
+class BaselineAgent(BaseAgent):
+    """
+    A native baseline policy (baselines.h): "random", "greedy", "one_ply" or
+    "reference", for fast test games.
+    """
+    def __init__(self, player: str, policy: str, seed: int = 1):
+        super().__init__(player)
+        self.agent = student_agent.BaselineAgent(player, getattr(student_agent.BaselinePolicy, policy), seed)
+
+    def choose(self, board: List[List[Any]], rows: int, cols: int, score_cols: List[int], current_player_time: float, opponent_time: float) -> Optional[Dict[str, Any]]:
+        cpp_move = self.agent.choose(board_to_cpp(board), int(rows), int(cols), list(score_cols), float(current_player_time), float(opponent_time))
+        return move_from_cpp(cpp_move) if cpp_move.action else None
+
+
 def test_student_agent():
     """
     Basic test to verify the student agent can be created and make moves.
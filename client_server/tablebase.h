@@ -0,0 +1,700 @@
+// Goal-zone endgame tablebases
+//
+// A goal zone is the score row of one side (the attacker), the row on either
+// side of it, and the score columns plus one margin column left and right.
+// Attacker stones already on a score cell cannot be pushed out by the
+// defender (it may not enter those cells), so the tables treat them as
+// frozen and are keyed by which score cells are already filled. The
+// remaining attacker and defender pieces are placed freely on the other
+// cells. The attacker wins when every score cell holds one of its stones,
+// which is the real game's win condition.
+//
+// Pieces never leave the zone (its edge acts as a wall) and either side may
+// pass, standing for a move made elsewhere on the board. Values are stored
+// per side to move: 0 = no forced fill (draw), v >= 1 = the attacker fills
+// the row in v - 1 plies against any defence.
+//
+// Tables are produced offline by tablebase_gen and stored block-RLE
+// compressed with an offset index, so a probe decodes at most one block of
+// an mmap-ed file.
+
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Tablebase
+{
+    constexpr int ZONE_ROWS = 3; // outer row, score row, inner row
+    constexpr int SCORE_ROW = 1;
+    constexpr int MAX_CELLS = 32;
+
+    enum Piece : uint8_t
+    {
+        EMPTY = 0,
+        A_STONE,
+        A_RIVER_H,
+        A_RIVER_V,
+        D_STONE,
+        D_RIVER_H,
+        D_RIVER_V,
+        FROZEN // attacker stone already scoring
+    };
+
+    enum Side
+    {
+        ATTACKER = 0,
+        DEFENDER = 1
+    };
+
+    inline int owner_of(uint8_t p)
+    {
+        if (p == EMPTY)
+            return -1;
+        return (p <= A_RIVER_V || p == FROZEN) ? ATTACKER : DEFENDER;
+    }
+
+    inline bool is_river(uint8_t p)
+    {
+        return p == A_RIVER_H || p == A_RIVER_V || p == D_RIVER_H || p == D_RIVER_V;
+    }
+
+    inline bool is_horizontal(uint8_t p)
+    {
+        return p == A_RIVER_H || p == D_RIVER_H;
+    }
+
+    inline uint8_t stone_of(int side) { return side == ATTACKER ? A_STONE : D_STONE; }
+    inline uint8_t river_of(int side, bool horizontal)
+    {
+        if (side == ATTACKER)
+            return horizontal ? A_RIVER_H : A_RIVER_V;
+        return horizontal ? D_RIVER_H : D_RIVER_V;
+    }
+
+    inline uint64_t binomial(int n, int k)
+    {
+        static const auto table = []
+        {
+            std::array<std::array<uint64_t, MAX_CELLS + 1>, MAX_CELLS + 1> t{};
+            for (int i = 0; i <= MAX_CELLS; i++)
+            {
+                t[i][0] = 1;
+                for (int j = 1; j <= i; j++)
+                    t[i][j] = t[i - 1][j - 1] + (j <= i - 1 ? t[i - 1][j] : 0);
+            }
+            return t;
+        }();
+        if (k < 0 || n < 0 || k > n)
+            return 0;
+        return table[n][k];
+    }
+
+    inline uint64_t pow3(int n)
+    {
+        uint64_t r = 1;
+        while (n-- > 0)
+            r *= 3;
+        return r;
+    }
+
+    // One table: score width, filled score cells, mobile piece counts.
+    struct ZoneSpec
+    {
+        int width; // number of score columns
+        int mask;  // bit i set: score column i already holds a frozen stone
+        int na;    // mobile attacker pieces
+        int nd;    // defender pieces
+
+        int cols() const { return width + 2; }
+        int cells() const { return ZONE_ROWS * cols(); }
+        int score_cell(int i) const { return SCORE_ROW * cols() + 1 + i; }
+        bool is_score_cell(int c) const { return c / cols() == SCORE_ROW && c % cols() >= 1 && c % cols() <= width; }
+        int free_score_cells() const { return width - __builtin_popcount(mask); }
+
+        bool operator<(const ZoneSpec &o) const
+        {
+            return std::tie(width, mask, na, nd) < std::tie(o.width, o.mask, o.na, o.nd);
+        }
+    };
+
+    // Combinatorial ranking of a zone into [0, size()) for one side to move.
+    class ZoneIndexer
+    {
+    public:
+        explicit ZoneIndexer(const ZoneSpec &spec) : spec_(spec)
+        {
+            for (int c = 0; c < spec.cells(); c++)
+            {
+                bool frozen = false;
+                for (int i = 0; i < spec.width; i++)
+                    frozen |= (spec.mask >> i & 1) && c == spec.score_cell(i);
+                free_index_[c] = frozen ? -1 : static_cast<int>(free_cells_.size());
+                if (!frozen)
+                    free_cells_.push_back(c);
+            }
+            int f = static_cast<int>(free_cells_.size());
+            d_sets_ = binomial(f - spec.na, spec.nd);
+            size_ = binomial(f, spec.na) * pow3(spec.na) * d_sets_ * pow3(spec.nd);
+        }
+
+        uint64_t size() const { return size_; }
+        const ZoneSpec &spec() const { return spec_; }
+
+        void unrank(uint64_t index, uint8_t *grid) const
+        {
+            const int f = static_cast<int>(free_cells_.size());
+            std::fill(grid, grid + spec_.cells(), EMPTY);
+            for (int i = 0; i < spec_.width; i++)
+            {
+                if (spec_.mask >> i & 1)
+                    grid[spec_.score_cell(i)] = FROZEN;
+            }
+
+            uint64_t d_types = index % pow3(spec_.nd);
+            index /= pow3(spec_.nd);
+            uint64_t d_set = index % d_sets_;
+            index /= d_sets_;
+            uint64_t a_types = index % pow3(spec_.na);
+            uint64_t a_set = index / pow3(spec_.na);
+
+            int a_slots[MAX_CELLS];
+            unrank_set(a_set, spec_.na, a_slots);
+            bool used[MAX_CELLS] = {};
+            for (int i = 0; i < spec_.na; i++)
+            {
+                used[a_slots[i]] = true;
+                grid[free_cells_[a_slots[i]]] = static_cast<uint8_t>(A_STONE + a_types % 3);
+                a_types /= 3;
+            }
+
+            int remaining[MAX_CELLS];
+            int r = 0;
+            for (int i = 0; i < f; i++)
+            {
+                if (!used[i])
+                    remaining[r++] = free_cells_[i];
+            }
+            int d_slots[MAX_CELLS];
+            unrank_set(d_set, spec_.nd, d_slots);
+            for (int i = 0; i < spec_.nd; i++)
+            {
+                grid[remaining[d_slots[i]]] = static_cast<uint8_t>(D_STONE + d_types % 3);
+                d_types /= 3;
+            }
+        }
+
+        // Only valid for grids holding exactly na mobile attacker and nd
+        // defender pieces on this spec's free cells.
+        uint64_t rank(const uint8_t *grid) const
+        {
+            uint64_t a_set = 0, a_types = 0, d_set = 0, d_types = 0;
+            uint64_t a_mul = 1, d_mul = 1;
+            int a_seen = 0, d_seen = 0, remaining = 0;
+            for (int c : free_cells_)
+            {
+                uint8_t p = grid[c];
+                int slot = free_index_[c];
+                if (p != EMPTY && owner_of(p) == ATTACKER)
+                {
+                    a_set += binomial(slot, ++a_seen);
+                    a_types += (p - A_STONE) * a_mul;
+                    a_mul *= 3;
+                    continue;
+                }
+                if (p != EMPTY)
+                {
+                    d_set += binomial(remaining, ++d_seen);
+                    d_types += (p - D_STONE) * d_mul;
+                    d_mul *= 3;
+                }
+                remaining++;
+            }
+            return ((a_set * pow3(spec_.na) + a_types) * d_sets_ + d_set) * pow3(spec_.nd) + d_types;
+        }
+
+    private:
+        // Colex unranking of a k-subset of {0, 1, ...}.
+        static void unrank_set(uint64_t r, int k, int *out)
+        {
+            for (int i = k; i >= 1; i--)
+            {
+                int c = i - 1;
+                while (binomial(c + 1, i) <= r)
+                    c++;
+                out[i - 1] = c;
+                r -= binomial(c, i);
+            }
+        }
+
+        ZoneSpec spec_;
+        std::vector<int> free_cells_;
+        std::array<int, MAX_CELLS> free_index_{};
+        uint64_t d_sets_ = 0;
+        uint64_t size_ = 0;
+    };
+
+    // ---------------- Zone move generation ----------------
+
+    inline bool barred(const ZoneSpec &spec, int side, int c)
+    {
+        return side == DEFENDER && spec.is_score_cell(c);
+    }
+
+    // Bitmask of cells reached by flowing through the river at r, mirroring
+    // get_river_flow_destinations. s is the moving piece's cell; with
+    // river_push the river at s stands in for the piece on r.
+    inline uint32_t zone_flow(const ZoneSpec &spec, const uint8_t *g, int r, int s, int side, bool river_push)
+    {
+        const int cols = spec.cols();
+        uint32_t dests = 0, visited = 0;
+        int queue[MAX_CELLS];
+        int head = 0, tail = 0;
+        queue[tail++] = r;
+        while (head < tail)
+        {
+            int pos = queue[head++];
+            if (visited >> pos & 1)
+                continue;
+            visited |= 1u << pos;
+
+            uint8_t cell = (river_push && pos == r) ? g[s] : g[pos];
+            if (cell == EMPTY)
+            {
+                if (!barred(spec, side, pos))
+                    dests |= 1u << pos;
+                continue;
+            }
+            if (!is_river(cell))
+                continue;
+
+            int px = pos % cols, py = pos / cols;
+            for (int dir : {1, -1})
+            {
+                int dx = is_horizontal(cell) ? dir : 0;
+                int dy = is_horizontal(cell) ? 0 : dir;
+                for (int nx = px + dx, ny = py + dy; nx >= 0 && nx < cols && ny >= 0 && ny < ZONE_ROWS; nx += dx, ny += dy)
+                {
+                    int n = ny * cols + nx;
+                    if (barred(spec, side, n))
+                        break;
+                    if (g[n] == EMPTY)
+                    {
+                        dests |= 1u << n;
+                        continue;
+                    }
+                    if (n == s)
+                        continue;
+                    if (is_river(g[n]) && tail < MAX_CELLS)
+                        queue[tail++] = n;
+                    break;
+                }
+            }
+        }
+        return dests;
+    }
+
+    // Calls visit(child) for every successor of g with `side` to move,
+    // including the pass. The child buffer is reused between calls.
+    template <typename Visit>
+    void for_each_zone_move(const ZoneSpec &spec, const uint8_t *g, int side, Visit visit)
+    {
+        const int cols = spec.cols(), cells = spec.cells();
+        uint8_t child[MAX_CELLS];
+        auto reset = [&]
+        { std::copy(g, g + cells, child); };
+
+        reset();
+        visit(child);
+
+        static const int DX[4] = {1, -1, 0, 0};
+        static const int DY[4] = {0, 0, 1, -1};
+        for (int i = 0; i < cells; i++)
+        {
+            uint8_t p = g[i];
+            if (p == EMPTY || p == FROZEN || owner_of(p) != side)
+                continue;
+            int x = i % cols, y = i / cols;
+
+            for (int d = 0; d < 4; d++)
+            {
+                int tx = x + DX[d], ty = y + DY[d];
+                if (tx < 0 || tx >= cols || ty < 0 || ty >= ZONE_ROWS)
+                    continue;
+                int t = ty * cols + tx;
+                if (barred(spec, side, t))
+                    continue;
+
+                if (g[t] == EMPTY)
+                {
+                    reset();
+                    child[t] = p;
+                    child[i] = EMPTY;
+                    visit(child);
+                }
+                else if (is_river(g[t]))
+                {
+                    uint32_t dests = zone_flow(spec, g, t, i, side, false);
+                    for (int c = 0; dests; c++, dests >>= 1)
+                    {
+                        if (!(dests & 1))
+                            continue;
+                        reset();
+                        child[c] = p;
+                        child[i] = EMPTY;
+                        visit(child);
+                    }
+                }
+                else if (g[t] != FROZEN)
+                {
+                    int pushed_owner = owner_of(g[t]);
+                    if (!is_river(p))
+                    {
+                        int qx = tx + DX[d], qy = ty + DY[d];
+                        int q = qy * cols + qx;
+                        if (qx < 0 || qx >= cols || qy < 0 || qy >= ZONE_ROWS || g[q] != EMPTY ||
+                            barred(spec, side, q) || barred(spec, pushed_owner, q))
+                            continue;
+                        reset();
+                        child[q] = g[t];
+                        child[t] = p;
+                        child[i] = EMPTY;
+                        visit(child);
+                    }
+                    else
+                    {
+                        uint32_t dests = zone_flow(spec, g, t, i, pushed_owner, true);
+                        for (int c = 0; dests; c++, dests >>= 1)
+                        {
+                            if (!(dests & 1) || barred(spec, side, c))
+                                continue;
+                            reset();
+                            child[c] = g[t];
+                            child[t] = stone_of(side); // a pushing river lands as a stone
+                            child[i] = EMPTY;
+                            visit(child);
+                        }
+                    }
+                }
+            }
+
+            if (is_river(p))
+            {
+                reset();
+                child[i] = stone_of(side);
+                visit(child);
+                reset();
+                child[i] = river_of(side, !is_horizontal(p));
+                visit(child);
+            }
+            else
+            {
+                for (bool horizontal : {true, false})
+                {
+                    reset();
+                    child[i] = river_of(side, horizontal);
+                    visit(child);
+                }
+            }
+        }
+    }
+
+    inline bool row_filled(const ZoneSpec &spec, const uint8_t *g)
+    {
+        for (int i = 0; i < spec.width; i++)
+        {
+            uint8_t p = g[spec.score_cell(i)];
+            if (p != FROZEN && p != A_STONE)
+                return false;
+        }
+        return true;
+    }
+
+    // ---------------- Generation ----------------
+
+    // Values for both sides to move: [0, size) attacker to move, then
+    // [size, 2 * size) defender to move.
+    inline std::vector<uint8_t> generate(const ZoneSpec &spec, int threads)
+    {
+        ZoneIndexer indexer(spec);
+        const uint64_t n = indexer.size();
+        std::vector<uint8_t> value(2 * n, 0);
+        threads = std::max(1, threads);
+
+        auto parallel = [&](auto body)
+        {
+            std::vector<std::thread> pool;
+            for (int t = 0; t < threads; t++)
+            {
+                pool.emplace_back([&, t]
+                                  {
+                    uint8_t grid[MAX_CELLS];
+                    for (uint64_t i = n * t / threads; i < n * (t + 1) / threads; i++)
+                    {
+                        indexer.unrank(i, grid);
+                        body(i, grid);
+                    } });
+            }
+            for (auto &th : pool)
+                th.join();
+        };
+
+        parallel([&](uint64_t i, const uint8_t *grid)
+                 {
+            if (row_filled(spec, grid))
+                value[i] = value[n + i] = 1; });
+
+        // Iteration k settles the positions decided in exactly k plies.
+        // Reads only see values <= k, so the writes of value k + 1 made by
+        // other threads during the same sweep never affect a decision.
+        std::vector<std::atomic<uint8_t>> next(2 * n);
+        for (int k = 1; k < 255; k++)
+        {
+            for (uint64_t i = 0; i < 2 * n; i++)
+                next[i].store(value[i], std::memory_order_relaxed);
+            std::atomic<bool> changed{false};
+            auto settled = [&](uint64_t c)
+            {
+                uint8_t v = value[c];
+                return v >= 1 && v <= k;
+            };
+
+            parallel([&](uint64_t i, const uint8_t *grid)
+                     {
+                if (value[i] == 0)
+                {
+                    bool win = false;
+                    for_each_zone_move(spec, grid, ATTACKER, [&](const uint8_t *child)
+                                       { win = win || settled(n + indexer.rank(child)); });
+                    if (win)
+                    {
+                        next[i].store(static_cast<uint8_t>(k + 1), std::memory_order_relaxed);
+                        changed = true;
+                    }
+                }
+                if (value[n + i] == 0)
+                {
+                    bool lost = true;
+                    for_each_zone_move(spec, grid, DEFENDER, [&](const uint8_t *child)
+                                       { lost = lost && settled(indexer.rank(child)); });
+                    if (lost)
+                    {
+                        next[n + i].store(static_cast<uint8_t>(k + 1), std::memory_order_relaxed);
+                        changed = true;
+                    }
+                } });
+
+            for (uint64_t i = 0; i < 2 * n; i++)
+                value[i] = next[i].load(std::memory_order_relaxed);
+            if (!changed)
+                break;
+        }
+        return value;
+    }
+
+    // ---------------- File format ----------------
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t width, mask, na, nd;
+        uint64_t entries; // 2 * positions per side to move
+        uint32_t block_size;
+        uint32_t blocks;
+        // followed by uint64_t offsets[blocks + 1] into the data area, then
+        // (value, run - 1) byte pairs
+    };
+
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint32_t BLOCK_SIZE = 4096;
+
+    inline std::string file_name(const ZoneSpec &spec)
+    {
+        return "rstb_w" + std::to_string(spec.width) + "_m" + std::to_string(spec.mask) +
+               "_a" + std::to_string(spec.na) + "_d" + std::to_string(spec.nd) + ".bin";
+    }
+
+    inline bool write_table(const std::string &path, const ZoneSpec &spec, const std::vector<uint8_t> &value)
+    {
+        FileHeader h{};
+        std::memcpy(h.magic, "RSTB", 4);
+        h.version = FILE_VERSION;
+        h.width = spec.width;
+        h.mask = spec.mask;
+        h.na = spec.na;
+        h.nd = spec.nd;
+        h.entries = value.size();
+        h.block_size = BLOCK_SIZE;
+        h.blocks = static_cast<uint32_t>((value.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t> data;
+        for (uint64_t b = 0; b < h.blocks; b++)
+        {
+            offsets.push_back(data.size());
+            uint64_t end = std::min<uint64_t>(value.size(), (b + 1) * BLOCK_SIZE);
+            for (uint64_t i = b * BLOCK_SIZE; i < end;)
+            {
+                uint64_t run = 1;
+                while (i + run < end && run < 256 && value[i + run] == value[i])
+                    run++;
+                data.push_back(value[i]);
+                data.push_back(static_cast<uint8_t>(run - 1));
+                i += run;
+            }
+        }
+        offsets.push_back(data.size());
+
+        FILE *f = std::fopen(path.c_str(), "wb");
+        if (!f)
+            return false;
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+                  std::fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), f) == offsets.size() &&
+                  std::fwrite(data.data(), 1, data.size(), f) == data.size();
+        return std::fclose(f) == 0 && ok;
+    }
+
+    // ---------------- Probing ----------------
+
+    class MappedTable
+    {
+    public:
+        MappedTable() = default;
+        MappedTable(const MappedTable &) = delete;
+        MappedTable &operator=(const MappedTable &) = delete;
+        ~MappedTable()
+        {
+            if (base_)
+                munmap(base_, length_);
+        }
+
+        bool open(const std::string &path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader)))
+            {
+                ::close(fd);
+                return false;
+            }
+            void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED)
+                return false;
+            base_ = base;
+            length_ = st.st_size;
+
+            header_ = static_cast<const FileHeader *>(base_);
+            size_t index_bytes = sizeof(uint64_t) * (static_cast<size_t>(header_->blocks) + 1);
+            if (std::memcmp(header_->magic, "RSTB", 4) != 0 || header_->version != FILE_VERSION ||
+                sizeof(FileHeader) + index_bytes > length_)
+                return false;
+            offsets_ = reinterpret_cast<const uint64_t *>(header_ + 1);
+            data_ = reinterpret_cast<const uint8_t *>(offsets_) + index_bytes;
+            return data_ + offsets_[header_->blocks] <= static_cast<const uint8_t *>(base_) + length_;
+        }
+
+        size_t bytes() const { return length_; }
+
+        ZoneSpec spec() const
+        {
+            return {static_cast<int>(header_->width), static_cast<int>(header_->mask),
+                    static_cast<int>(header_->na), static_cast<int>(header_->nd)};
+        }
+
+        uint8_t at(uint64_t i) const
+        {
+            uint64_t block = i / header_->block_size;
+            uint64_t skip = i % header_->block_size;
+            const uint8_t *p = data_ + offsets_[block];
+            const uint8_t *end = data_ + offsets_[block + 1];
+            for (; p < end; p += 2)
+            {
+                uint64_t run = static_cast<uint64_t>(p[1]) + 1;
+                if (skip < run)
+                    return p[0];
+                skip -= run;
+            }
+            return 0;
+        }
+
+    private:
+        void *base_ = nullptr;
+        size_t length_ = 0;
+        const FileHeader *header_ = nullptr;
+        const uint64_t *offsets_ = nullptr;
+        const uint8_t *data_ = nullptr;
+    };
+
+    class Store
+    {
+    public:
+        // Maps every rstb_*.bin file in `dir`. Returns the number loaded.
+        int load_dir(const std::string &dir)
+        {
+            std::error_code ec;
+            int loaded = 0;
+            for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+            {
+                std::string name = entry.path().filename().string();
+                if (name.rfind("rstb_", 0) != 0)
+                    continue;
+                auto table = std::make_unique<MappedTable>();
+                if (!table->open(entry.path().string()))
+                    continue;
+                ZoneSpec spec = table->spec();
+                tables_[spec] = {std::move(table), std::make_unique<ZoneIndexer>(spec)};
+                loaded++;
+            }
+            return loaded;
+        }
+
+        bool empty() const { return tables_.empty(); }
+        size_t size() const { return tables_.size(); }
+
+        // Address space the mapped files take; pages are read in on demand.
+        size_t mapped_bytes() const
+        {
+            size_t bytes = 0;
+            for (const auto &[spec, table] : tables_)
+                bytes += table.first->bytes();
+            return bytes;
+        }
+
+        // -1 when no table covers the zone, else the stored value.
+        int probe(const ZoneSpec &spec, const uint8_t *grid, int side_to_move) const
+        {
+            auto it = tables_.find(spec);
+            if (it == tables_.end())
+                return -1;
+            const auto &[table, indexer] = it->second;
+            uint64_t i = indexer->rank(grid);
+            return table->at(side_to_move == ATTACKER ? i : indexer->size() + i);
+        }
+
+    private:
+        std::map<ZoneSpec, std::pair<std::unique_ptr<MappedTable>, std::unique_ptr<ZoneIndexer>>> tables_;
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+// Offline generator for the goal-zone endgame tables in tablebase.h.
+//
+//   tablebase_gen <out_dir> [--width W] [--attackers A] [--defenders D] [--threads T]
+//
+// Without --width all three board sizes (score widths 4, 5 and 6) are built.
+// For every set of already filled score cells it writes the tables with up
+// to A mobile attacker pieces (at least as many as there are empty score
+// cells) and up to D defender pieces.
+
+#include "tablebase.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <out_dir> [--width W] [--attackers A] [--defenders D] [--threads T]\n";
+        return 1;
+    }
+    std::string out_dir = argv[1];
+    std::vector<int> widths = {4, 5, 6};
+    int max_attackers = 2;
+    int max_defenders = 1;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        int value = std::atoi(argv[i + 1]);
+        if (flag == "--width")
+            widths = {value};
+        else if (flag == "--attackers")
+            max_attackers = value;
+        else if (flag == "--defenders")
+            max_defenders = value;
+        else if (flag == "--threads")
+            threads = value;
+        else
+        {
+            std::cerr << "unknown option " << flag << "\n";
+            return 1;
+        }
+    }
+    std::filesystem::create_directories(out_dir);
+
+    for (int width : widths)
+    {
+        for (int mask = 0; mask < (1 << width) - 1; mask++)
+        {
+            Tablebase::ZoneSpec spec{width, mask, 0, 0};
+            for (int na = std::max(1, spec.free_score_cells()); na <= max_attackers; na++)
+            {
+                for (int nd = 0; nd <= max_defenders; nd++)
+                {
+                    spec.na = na;
+                    spec.nd = nd;
+                    if (Tablebase::ZoneIndexer(spec).size() == 0)
+                        continue;
+
+                    auto t0 = std::chrono::steady_clock::now();
+                    auto value = Tablebase::generate(spec, threads);
+                    std::string path = out_dir + "/" + Tablebase::file_name(spec);
+                    if (!Tablebase::write_table(path, spec, value))
+                    {
+                        std::cerr << "failed to write " << path << "\n";
+                        return 1;
+                    }
+
+                    uint64_t wins = 0;
+                    for (uint8_t v : value)
+                        wins += v != 0;
+                    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                    std::cout << Tablebase::file_name(spec) << ": " << value.size() << " entries, "
+                              << wins << " decided, " << secs << "s\n";
+                }
+            }
+        }
+    }
+    return 0;
+}
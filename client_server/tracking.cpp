@@ -0,0 +1,109 @@
+#include "tracking.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+#include "movegen.h"
+
+BoardTracker::BoardTracker(int rows, int cols)
+    : rows(rows), cols(cols), score_cols(score_cols_for(cols)),
+      board_(rows, std::vector<Cell>(cols))
+{
+}
+
+void BoardTracker::load(const std::string &code)
+{
+    if (code.size() != static_cast<size_t>(rows * cols))
+        throw std::invalid_argument("board code has " + std::to_string(code.size()) +
+                                    " cells, expected " + std::to_string(rows * cols));
+    std::vector<std::vector<Cell>> board(rows, std::vector<Cell>(cols));
+    for (int i = 0; i < rows * cols; i++)
+    {
+        char c = code[i];
+        if (c == '.')
+            continue;
+        char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (upper != 'A' && upper != 'B' && upper != 'C')
+            throw std::invalid_argument(std::string("unknown board code character '") + c + "'");
+        Cell &cell = board[i / cols][i % cols];
+        cell.owner = (c == upper) ? "circle" : "square";
+        cell.side = upper == 'A' ? "stone" : "river";
+        if (upper != 'A')
+            cell.orientation = upper == 'C' ? "vertical" : "horizontal";
+    }
+    board_ = std::move(board);
+    synced_ = true;
+}
+
+bool BoardTracker::apply(const std::unordered_map<std::string, std::string> &move,
+                         const std::string &player, uint32_t checksum)
+{
+    if (!synced_)
+        return false;
+    auto legal = generate_all_valid_moves(board_, player, rows, cols, score_cols);
+    auto match = std::find_if(legal.begin(), legal.end(), [&](const auto &candidate)
+                              { return std::all_of(candidate.begin(), candidate.end(), [&](const auto &kv)
+                                                   {
+                                                       auto it = move.find(kv.first);
+                                                       return it != move.end() && it->second == kv.second; }); });
+    if (match == legal.end())
+    {
+        synced_ = false;
+        return false;
+    }
+    auto next = apply_move(board_, *match, player, rows, cols, score_cols);
+    if (crc32(encode_board(next)) != checksum)
+    {
+        synced_ = false;
+        return false;
+    }
+    board_ = std::move(next);
+    return true;
+}
+
+std::string BoardTracker::encode_board(const std::vector<std::vector<Cell>> &board)
+{
+    std::string code;
+    for (const auto &row : board)
+    {
+        for (const Cell &cell : row)
+            code += encode_cell(cell);
+    }
+    return code;
+}
+
+PositionTracker::PositionTracker(int rows, int cols, int interval, int repeats)
+    : rows(rows), cols(cols), interval(interval), repeats(repeats),
+      pieces_(static_cast<size_t>(rows) * cols, 0)
+{
+    if (rows <= 0 || cols <= 0 || interval <= 0 || repeats <= 0)
+        throw std::invalid_argument("PositionTracker needs positive dimensions, interval and repeats");
+    if (rows * cols > MAX_BOARD_CELLS)
+        throw std::invalid_argument("board has more than " + std::to_string(MAX_BOARD_CELLS) + " cells");
+}
+
+void PositionTracker::set_cell(int x, int y, int piece)
+{
+    if (x < 0 || x >= cols || y < 0 || y >= rows)
+        throw std::out_of_range("cell (" + std::to_string(x) + ", " + std::to_string(y) + ") is off the board");
+    if (piece < 0 || piece > 6)
+        throw std::invalid_argument("piece code must be in 0-6, got " + std::to_string(piece));
+    int cell = y * cols + x;
+    if (pieces_[cell])
+        key_ ^= zobrist_key(cell, pieces_[cell]);
+    if (piece)
+        key_ ^= zobrist_key(cell, piece);
+    pieces_[cell] = static_cast<uint8_t>(piece);
+}
+
+bool PositionTracker::move_applied()
+{
+    if (++moves_ % interval != 0)
+        return false;
+    run_ = (checks_ > 0 && key_ == checked_key_) ? run_ + 1 : 1;
+    checked_key_ = key_;
+    checks_++;
+    return run_ >= repeats;
+}
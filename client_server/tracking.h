@@ -0,0 +1,123 @@
+// Board and position tracking between server updates
+//
+// BoardTracker keeps a client-side copy of the board in step with the
+// server's delta updates; PositionTracker keeps the incremental position
+// hash behind the stalemate rule.
+
+#ifndef TRACKING_H
+#define TRACKING_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+
+// ==================== DELTA UPDATES ====================
+//
+// Instead of the whole board on every update, the server can send the move
+// just played and a CRC-32 of the resulting board, with the full board only
+// as a periodic keyframe in GameLogger encoding (one character per cell, row
+// by row). BoardTracker replays the moves on its own copy and checks each
+// one against the checksum; a mismatch means the client must ask for a
+// keyframe.
+
+inline uint32_t crc32(const std::string &data)
+{
+    static const std::array<uint32_t, 256> table = []
+    {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char ch : data)
+        crc = table[(crc ^ ch) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+inline char encode_cell(const Cell &cell)
+{
+    if (cell.isEmpty())
+        return '.';
+    char c = cell.side == "stone" ? 'A' : (cell.orientation == "horizontal" ? 'B' : 'C');
+    return cell.owner == "circle" ? c : static_cast<char>(c - 'A' + 'a');
+}
+
+class BoardTracker
+{
+public:
+    BoardTracker(int rows, int cols);
+
+    // Replace the board with a keyframe. Throws std::invalid_argument if the
+    // code has the wrong length or an unknown character.
+    void load(const std::string &code);
+
+    // Play `move` for `player` and check the result against the server's
+    // checksum. On an illegal move or a mismatch the board is left as it was
+    // and the tracker stays out of sync until the next load().
+    bool apply(const std::unordered_map<std::string, std::string> &move,
+               const std::string &player, uint32_t checksum);
+
+    std::string encode() const { return encode_board(board_); }
+    uint32_t checksum() const { return crc32(encode_board(board_)); }
+    bool synced() const { return synced_; }
+    const std::vector<std::vector<Cell>> &cells() const { return board_; }
+    PyBoard py_board() const { return to_py_board(board_); }
+
+    const int rows, cols;
+    const std::vector<int> score_cols;
+
+private:
+    static std::string encode_board(const std::vector<std::vector<Cell>> &board);
+
+    std::vector<std::vector<Cell>> board_;
+    bool synced_ = false;
+};
+
+// ==================== POSITION TRACKING ====================
+//
+// The Python engine's stalemate rule: every `interval` moves the position is
+// compared with the one at the previous check, and `repeats` equal checks in
+// a row end the game in a draw. The position is an incremental Zobrist hash
+// (the same keys as board_hash()) updated from the cells a move touched, and
+// only the last checked key and the run length are kept, so a check is O(1)
+// and memory stays flat however long the game runs.
+
+class PositionTracker
+{
+public:
+    PositionTracker(int rows, int cols, int interval = 4, int repeats = 3);
+
+    // `piece` is a piece_code(): 0 empty, 1-3 circle stone / horizontal /
+    // vertical river, 4-6 the same for square.
+    void set_cell(int x, int y, int piece);
+
+    // Count a move whose cells have been updated; true once the position has
+    // repeated at `repeats` consecutive checks.
+    bool move_applied();
+
+    uint64_t key() const { return key_; }
+    int run_length() const { return run_; }
+    int moves() const { return moves_; }
+
+    const int rows, cols, interval, repeats;
+
+private:
+    std::vector<uint8_t> pieces_;
+    uint64_t key_ = 0;
+    uint64_t checked_key_ = 0;
+    int moves_ = 0;
+    int checks_ = 0;
+    int run_ = 0;
+};
+
+#endif // TRACKING_H
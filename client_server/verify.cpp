@@ -0,0 +1,279 @@
+#include "verify.h"
+
+#include <atomic>
+#include <cmath>
+#include <sstream>
+
+#include "distance.h"
+#include "eval.h"
+#include "movegen.h"
+#include "tracking.h"
+
+// ==================== REPORTS ====================
+
+static std::string describe_move(const std::unordered_map<std::string, std::string> &move,
+                                 const std::string &player)
+{
+    std::ostringstream out;
+    out << player << " " << move.at("action") << " " << move.at("from_x") << "," << move.at("from_y");
+    if (move.count("to_x"))
+        out << " -> " << move.at("to_x") << "," << move.at("to_y");
+    if (move.count("pushed_x"))
+        out << " pushing to " << move.at("pushed_x") << "," << move.at("pushed_y");
+    if (move.count("orientation"))
+        out << " " << move.at("orientation");
+    return out.str();
+}
+
+static std::string describe_cell(const Cell &cell)
+{
+    std::string text(1, encode_cell(cell));
+    // Cells that encode alike can still differ in a field the encoding drops
+    if (cell.side == "stone" && !cell.orientation.empty())
+        text += "[" + cell.orientation + "]";
+    return text;
+}
+
+[[noreturn]] static void fail(const std::string &check, const std::string &context, const std::string &report)
+{
+    std::string message = check;
+    if (!context.empty())
+        message += " (" + context + ")";
+    throw VerifyError(message + "\n" + report);
+}
+
+std::string board_diff(const std::vector<std::vector<Cell>> &expected,
+                       const std::vector<std::vector<Cell>> &actual,
+                       int rows, int cols)
+{
+    std::ostringstream out;
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &e = expected[y][x], &a = actual[y][x];
+            if (e.owner != a.owner || e.side != a.side || e.orientation != a.orientation)
+                out << "  (" << x << "," << y << ") expected " << describe_cell(e) << " got " << describe_cell(a)
+                    << "\n";
+        }
+    }
+    return out.str();
+}
+
+// ==================== MOVES ====================
+
+void verify_move(const std::vector<std::vector<Cell>> &board,
+                 const std::unordered_map<std::string, std::string> &move,
+                 const std::string &player,
+                 int rows, int cols,
+                 const std::vector<int> &score_cols)
+{
+    auto child = board;
+    MoveUndo undo;
+    make_move(child, move, undo);
+
+    std::vector<uint8_t> saved(rows * cols, 0);
+    uint64_t key = board_hash(board, rows, cols);
+    for (const auto &[pos, before] : undo.cells)
+    {
+        int cell = pos.y * cols + pos.x;
+        // A cell saved twice keeps its first, pre-move contents
+        if (saved[cell])
+            continue;
+        saved[cell] = 1;
+        if (before.owner != board[pos.y][pos.x].owner || before.side != board[pos.y][pos.x].side ||
+            before.orientation != board[pos.y][pos.x].orientation)
+        {
+            fail("undo record", describe_move(move, player),
+                 "  (" + std::to_string(pos.x) + "," + std::to_string(pos.y) + ") saved as " +
+                     describe_cell(before) + ", was " + describe_cell(board[pos.y][pos.x]) + "\n");
+        }
+        int old_piece = piece_code(before), new_piece = piece_code(child[pos.y][pos.x]);
+        if (old_piece)
+            key ^= zobrist_key(cell, old_piece);
+        if (new_piece)
+            key ^= zobrist_key(cell, new_piece);
+    }
+
+    std::ostringstream unsaved;
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &b = board[y][x], &c = child[y][x];
+            bool changed = b.owner != c.owner || b.side != c.side || b.orientation != c.orientation;
+            if (changed && !saved[y * cols + x])
+                unsaved << "  (" << x << "," << y << ") " << describe_cell(b) << " -> " << describe_cell(c)
+                        << " not in the undo record\n";
+        }
+    }
+    if (!unsaved.str().empty())
+        fail("undo record", describe_move(move, player), unsaved.str());
+
+    // No piece a move lands may end on a cell its opponent scores on
+    std::ostringstream trespass;
+    for (const auto &[pos, before] : undo.cells)
+    {
+        const Cell &after = child[pos.y][pos.x];
+        bool arrived = !after.isEmpty() && (before.isEmpty() || before.owner != after.owner);
+        if (arrived && is_opponent_score_cell(pos.x, pos.y, after.owner, rows, cols, score_cols))
+            trespass << "  (" << pos.x << "," << pos.y << ") " << describe_cell(after)
+                     << " on its opponent's score cell\n";
+    }
+    if (!trespass.str().empty())
+        fail("score cells", describe_move(move, player), trespass.str());
+
+    uint64_t hash = board_hash(child, rows, cols);
+    if (key != hash)
+    {
+        std::ostringstream out;
+        out << "  incremental " << std::hex << key << ", board_hash " << hash << "\n";
+        fail("Zobrist key", describe_move(move, player), out.str());
+    }
+
+    unmake_move(child, undo);
+    std::string diff = board_diff(board, child, rows, cols);
+    if (!diff.empty())
+        fail("unmake_move", describe_move(move, player), diff);
+
+    // Push ordering and the greedy policy rely on this (see PUSH OUTCOMES)
+    if (move.at("action") == "push")
+    {
+        const Cell &pushed = board[std::stoi(move.at("to_y"))][std::stoi(move.at("to_x"))];
+        if (pushed.side == "stone" && pushed.owner != player)
+        {
+            PushOutcome outcome = evaluate_push(board, move, GoalFields(board, rows, cols, score_cols), rows,
+                                                cols, score_cols);
+            if (outcome.scores || outcome.ejects)
+                fail("push outcome", describe_move(move, player),
+                     std::string("  opponent stone ") + (outcome.scores ? "pushed onto" : "pushed off") +
+                         " its score cells\n");
+        }
+    }
+}
+
+// ==================== DERIVED STATE ====================
+
+static void verify_threats(const std::vector<std::vector<Cell>> &board, const std::string &attacker,
+                           int rows, int cols, const std::vector<int> &score_cols)
+{
+    auto cached = analyse_threats(board, attacker, rows, cols, score_cols);
+    auto fresh = compute_threat_map(board, attacker, rows, cols, score_cols);
+    std::ostringstream out;
+    if (cached->stones.size() != fresh->stones.size())
+        out << "  " << cached->stones.size() << " reachable stones, expected " << fresh->stones.size() << "\n";
+    for (size_t i = 0; i < std::min(cached->stones.size(), fresh->stones.size()); i++)
+    {
+        const StoneInfo &c = cached->stones[i], &f = fresh->stones[i];
+        if (c.x != f.x || c.y != f.y || c.dist != f.dist || c.path.size() != f.path.size())
+            out << "  stone " << i << ": (" << c.x << "," << c.y << ") at " << c.dist << " in "
+                << c.path.size() << " cells, expected (" << f.x << "," << f.y << ") at " << f.dist << " in "
+                << f.path.size() << "\n";
+    }
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            if (cached->paths_through(x, y) != fresh->paths_through(x, y) ||
+                cached->is_cut(x, y) != fresh->is_cut(x, y))
+                out << "  (" << x << "," << y << ") " << cached->paths_through(x, y) << " paths"
+                    << (cached->is_cut(x, y) ? ", cut" : "") << ", expected " << fresh->paths_through(x, y)
+                    << (fresh->is_cut(x, y) ? ", cut" : "") << "\n";
+        }
+    }
+    if (cached->blocked != fresh->blocked)
+        out << "  " << cached->blocked << " blocked stones, expected " << fresh->blocked << "\n";
+    if (!out.str().empty())
+        fail("threat cache", attacker + " attacking", out.str());
+}
+
+static void verify_distances(const std::vector<std::vector<Cell>> &board, const std::string &owner,
+                             int rows, int cols, const std::vector<int> &score_cols)
+{
+    int score_row = (owner == "circle") ? top_score_row() : bottom_score_row(rows);
+    std::vector<Position> goals;
+    for (int x : score_cols)
+        goals.push_back(Position(x, score_row));
+    auto field = compute_goal_distance_field(board, owner, rows, cols, score_cols);
+
+    std::ostringstream out;
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            const Cell &cell = board[y][x];
+            if (cell.side != "stone" || cell.owner != owner)
+                continue;
+            double reference = bfs_distance_to_goals(board, x, y, goals, owner, rows, cols, score_cols).distance;
+            double from_field = field[y * cols + x] == FIELD_UNREACHABLE ? INFINITY : field[y * cols + x];
+            double astar = astar_distance_to_goals(board, x, y, goals, owner, rows, cols, score_cols).distance;
+            double bidirectional =
+                bidirectional_distance_to_goals(board, x, y, goals, owner, rows, cols, score_cols).distance;
+            if (from_field != reference || astar != reference || bidirectional != reference)
+                out << "  (" << x << "," << y << ") bfs " << reference << ", field " << from_field << ", A* "
+                    << astar << ", bidirectional " << bidirectional << "\n";
+        }
+    }
+    if (!out.str().empty())
+        fail("goal distances", owner, out.str());
+}
+
+void verify_position(const std::vector<std::vector<Cell>> &board,
+                     int rows, int cols,
+                     const std::vector<int> &score_cols)
+{
+    for (const std::string side : {"circle", "square"})
+    {
+        verify_threats(board, side, rows, cols, score_cols);
+        verify_distances(board, side, rows, cols, score_cols);
+    }
+}
+
+void verify_child(const std::vector<std::vector<Cell>> &board,
+                  const std::unordered_map<std::string, std::string> &move,
+                  const std::string &player,
+                  const std::vector<std::vector<Cell>> &child,
+                  int rows, int cols,
+                  const std::vector<int> &score_cols)
+{
+    verify_move(board, move, player, rows, cols, score_cols);
+    std::string diff = board_diff(apply_move(board, move, player, rows, cols, score_cols), child, rows, cols);
+    if (!diff.empty())
+        fail("child board", describe_move(move, player), diff);
+    verify_position(child, rows, cols, score_cols);
+}
+
+long long verify_children(const std::vector<std::vector<Cell>> &board,
+                          const std::string &player,
+                          int rows, int cols,
+                          const std::vector<int> &score_cols)
+{
+    auto moves = generate_all_valid_moves(board, player, rows, cols, score_cols);
+    SiblingBoards siblings(board);
+    for (const auto &move : moves)
+        verify_child(board, move, player, siblings.child(move), rows, cols, score_cols);
+    return static_cast<long long>(moves.size());
+}
+
+// ==================== SCHEDULE ====================
+
+static std::atomic<int> VERIFY_INTERVAL{1};
+static thread_local int VERIFY_COUNTDOWN = 0;
+
+void set_verify_interval(int interval)
+{
+    VERIFY_INTERVAL = std::max(1, interval);
+}
+
+int verify_interval()
+{
+    return VERIFY_INTERVAL;
+}
+
+bool verify_due()
+{
+    if (--VERIFY_COUNTDOWN > 0)
+        return false;
+    VERIFY_COUNTDOWN = VERIFY_INTERVAL;
+    return true;
+}
@@ -0,0 +1,83 @@
+// Incremental state verification
+//
+// The search leans on state it updates rather than rebuilds: boards made and
+// unmade in place through MoveUndo, sibling boards that unmake the previous
+// child before making the next, Zobrist keys XOR-ed cell by cell, per-thread
+// threat and BFS caches keyed by those hashes, and the distance field and
+// scratch-array searches that stand in for the reference BFS. Each check
+// here rebuilds one of them from scratch and throws VerifyError with a
+// cell-by-cell report on the first difference.
+//
+// The verify_state tool runs the checks over perft trees and logged games.
+// Built with -DVERIFY_STATE=1 (cmake -DVERIFY_STATE=ON), minimax also runs
+// them on every child it searches, or every Nth per set_verify_interval().
+
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+
+#ifndef VERIFY_STATE
+#define VERIFY_STATE 0
+#endif
+
+class VerifyError : public std::logic_error
+{
+public:
+    using std::logic_error::logic_error;
+};
+
+// One line per differing cell, "(x,y) expected A got b" in GameLogger
+// characters; empty when the boards are equal.
+std::string board_diff(const std::vector<std::vector<Cell>> &expected,
+                       const std::vector<std::vector<Cell>> &actual,
+                       int rows, int cols);
+
+// make_move against the cells it reports and the board it started from:
+// the undo lists every changed cell, no piece lands on a cell its opponent
+// scores on, unmake_move restores the board, and the parent's Zobrist key
+// updated from the undo cells matches board_hash() of the child. A push
+// never moves an opponent stone onto or off its score cells, as
+// evaluate_push() assumes.
+void verify_move(const std::vector<std::vector<Cell>> &board,
+                 const std::unordered_map<std::string, std::string> &move,
+                 const std::string &player,
+                 int rows, int cols,
+                 const std::vector<int> &score_cols);
+
+// The derived state of one position: both sides' cached threat maps against
+// compute_threat_map(), and every stone's goal distance from the distance
+// field, A* and the bidirectional search against bfs_distance_to_goals().
+void verify_position(const std::vector<std::vector<Cell>> &board,
+                     int rows, int cols,
+                     const std::vector<int> &score_cols);
+
+// verify_move, then `child` (however the caller made it) against
+// apply_move, then verify_position on the child: the hook minimax runs.
+void verify_child(const std::vector<std::vector<Cell>> &board,
+                  const std::unordered_map<std::string, std::string> &move,
+                  const std::string &player,
+                  const std::vector<std::vector<Cell>> &child,
+                  int rows, int cols,
+                  const std::vector<int> &score_cols);
+
+// verify_child for every legal move of `player`, the children made one
+// after another on a single SiblingBoards. Returns the number of moves.
+long long verify_children(const std::vector<std::vector<Cell>> &board,
+                          const std::string &player,
+                          int rows, int cols,
+                          const std::vector<int> &score_cols);
+
+// Checks in VERIFY_STATE builds run on one searched child in `interval`
+// (1 = all, the default); the count is per thread.
+void set_verify_interval(int interval);
+int verify_interval();
+bool verify_due();
+
+#endif // VERIFY_H
@@ -0,0 +1,226 @@
+// Incremental state checks over perft trees and logged games.
+//
+//   verify_state [--rows R] [--depth D]
+//   verify_state --logs game_logs.zip [--every N] [--search D]
+//
+// The first form walks the move tree from the standard start D plies deep
+// (default 2) on the R-row board, or on all three sizes, and runs
+// verify_children() at every node. The second replays each game in the
+// archive: every Nth position (default 1) gets verify_children(), and every
+// logged move is replayed and compared with the board the log recorded after
+// it; a logged move these rules reject is counted and the replay carries on
+// from the logged board. With --search, each checked position is also searched to depth D, so a
+// VERIFY_STATE build checks the children minimax itself makes. The first
+// failure is reported with the position it came from, and the exit status
+// is 1.
+
+#include "board.h"
+#include "game_log_reader.h"
+#include "movegen.h"
+#include "search.h"
+#include "tracking.h"
+#include "verify.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+static long long verify_tree(const std::vector<std::vector<Cell>> &board, const std::string &player,
+                             int depth, int rows, int cols, const std::vector<int> &score_cols)
+{
+    long long checked = verify_children(board, player, rows, cols, score_cols);
+    if (depth == 1)
+        return checked;
+    for (const auto &move : generate_all_valid_moves(board, player, rows, cols, score_cols))
+    {
+        auto next = apply_move(board, move, player, rows, cols, score_cols);
+        if (check_win(next, rows, cols, score_cols).empty())
+            checked += verify_tree(next, get_opponent(player), depth - 1, rows, cols, score_cols);
+    }
+    return checked;
+}
+
+static std::unordered_map<std::string, std::string> logged_move(const GameLogs::LoggedMove &m)
+{
+    std::unordered_map<std::string, std::string> move = {
+        {"action", m.action}, {"from_x", std::to_string(m.from_x)}, {"from_y", std::to_string(m.from_y)}};
+    if (m.to_x >= 0)
+    {
+        move["to_x"] = std::to_string(m.to_x);
+        move["to_y"] = std::to_string(m.to_y);
+    }
+    if (m.pushed_x >= 0)
+    {
+        move["pushed_x"] = std::to_string(m.pushed_x);
+        move["pushed_y"] = std::to_string(m.pushed_y);
+    }
+    if (!m.orientation.empty())
+        move["orientation"] = m.orientation;
+    return move;
+}
+
+// The move of `legal` the log describes; the log may leave out fields the
+// move does not use.
+static const std::unordered_map<std::string, std::string> *find_logged(
+    const std::vector<std::unordered_map<std::string, std::string>> &legal,
+    const std::unordered_map<std::string, std::string> &move)
+{
+    for (const auto &candidate : legal)
+    {
+        bool same = true;
+        for (const auto &[key, value] : candidate)
+        {
+            auto it = move.find(key);
+            if (it == move.end() || it->second != value)
+            {
+                same = false;
+                break;
+            }
+        }
+        if (same)
+            return &candidate;
+    }
+    return nullptr;
+}
+
+static int verify_logs(const std::string &path, int every, int search_depth)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    long long games = 0, positions = 0, checked = 0, replayed = 0, illegal = 0;
+    std::string failure;
+    std::string error;
+    GameLogs::for_each_game(
+        path, [&](const GameLogs::GameRecord &game)
+        {
+            if (!failure.empty() || !game.error.empty())
+                return;
+            games++;
+            const size_t cells = static_cast<size_t>(game.rows * game.cols);
+            auto score_cols = score_cols_for(game.cols);
+            BoardTracker tracker(game.rows, game.cols);
+            auto board = standard_start_board(game.rows, game.cols);
+            StudentAgent circle("circle"), square("square");
+            for (size_t i = 0; i < game.moves.size(); i++)
+            {
+                const auto &logged = game.moves[i];
+                std::string where = game.name + " move " + std::to_string(i + 1) + " (" + logged.player + ")";
+                try
+                {
+                    if (i % every == 0)
+                    {
+                        positions++;
+                        checked += verify_children(board, logged.player, game.rows, game.cols, score_cols);
+                        if (search_depth > 0)
+                        {
+                            StudentAgent &agent = logged.player == "circle" ? circle : square;
+                            agent.minimax(board, search_depth, -INF, INF, true, game.rows, game.cols, score_cols);
+                        }
+                    }
+                    auto legal = generate_all_valid_moves(board, logged.player, game.rows, game.cols, score_cols);
+                    auto move = find_logged(legal, logged_move(logged));
+                    if (logged.state.size() != cells)
+                    {
+                        // Nothing to compare with or resynchronise from
+                        if (!move)
+                            return;
+                        board = apply_move(board, *move, logged.player, game.rows, game.cols, score_cols);
+                        continue;
+                    }
+                    tracker.load(logged.state);
+                    if (!move)
+                    {
+                        // Logs from older servers hold moves these rules reject;
+                        // carry on from the board the log recorded
+                        illegal++;
+                        board = tracker.cells();
+                        continue;
+                    }
+                    board = apply_move(board, *move, logged.player, game.rows, game.cols, score_cols);
+                    replayed++;
+                    std::string diff = board_diff(tracker.cells(), board, game.rows, game.cols);
+                    if (!diff.empty())
+                    {
+                        failure = where + ": replayed board differs from the log\n" + diff;
+                        return;
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    failure = where + ": " + e.what();
+                    return;
+                }
+            } },
+        0, &error);
+    if (!error.empty())
+    {
+        std::cerr << path << ": " << error << "\n";
+        return 1;
+    }
+    if (!failure.empty())
+    {
+        std::cerr << failure << "\n";
+        return 1;
+    }
+    std::cout << games << " games, " << replayed << " moves replayed (" << illegal
+              << " illegal under these rules, skipped), " << positions << " positions and " << checked
+              << " children checked\n";
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<int> sizes = {13, 15, 17};
+    std::string logs;
+    int depth = 2, every = 1, search_depth = 0;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        int number = std::atoi(value.c_str());
+        if (flag == "--rows" && supported_board(number, number - 1))
+            sizes = {number};
+        else if (flag == "--depth" && number >= 1)
+            depth = number;
+        else if (flag == "--logs")
+            logs = value;
+        else if (flag == "--every" && number >= 1)
+            every = number;
+        else if (flag == "--search" && number >= 1)
+            search_depth = number;
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--rows " << MIN_BOARD_ROWS << "-" << MAX_BOARD_SIDE << "] [--depth D]\n"
+                      << "       " << argv[0] << " --logs game_logs.zip [--every N] [--search D]\n";
+            return 1;
+        }
+    }
+    if (search_depth > 0 && !VERIFY_STATE)
+        std::cerr << "note: built without VERIFY_STATE, so --search only checks the positions it starts from\n";
+
+    if (!logs.empty())
+        return verify_logs(logs, every, search_depth);
+
+    for (int rows : sizes)
+    {
+        int cols = rows - 1;
+        auto score_cols = score_cols_for(cols);
+        auto board = standard_start_board(rows, cols);
+        auto t0 = std::chrono::steady_clock::now();
+        try
+        {
+            long long checked = verify_tree(board, "circle", depth, rows, cols, score_cols);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << rows << "x" << cols << " depth " << depth << ": " << checked << " moves checked in "
+                      << seconds << "s\n";
+        }
+        catch (const VerifyError &e)
+        {
+            std::cerr << rows << "x" << cols << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -22,12 +22,21 @@ To ensure fair and accurate time tracking, bots should:
 
 If "thinking_time" is provided, ONLY that amount will be deducted from your clock.
 If not provided, time since last move will be used (includes network latency - less accurate).
+
+DELTA UPDATES:
+==============
+GET /bot/game_state/<player>?delta=1 (or 'bot_subscribe' with "delta": true)
+returns the last move played and a CRC-32 "checksum" of the GameLogger-encoded
+board instead of the full board. The encoded board ("board_code") is included
+every KEYFRAME_INTERVAL moves, when the game is not active, or on request with
+&keyframe=1. "seq" counts the moves played so far.
 """
 
 import asyncio
 import json
 import logging
 import time
+import zlib
 from pathlib import Path
 from typing import Dict, Any, Optional, List
 import threading
@@ -35,7 +44,7 @@ from datetime import datetime
 
 try:
     from flask import Flask, render_template, request, jsonify
-    from flask_socketio import SocketIO, emit
+    from flask_socketio import SocketIO, emit, join_room
 except ImportError:
     print("Flask and Flask-SocketIO required. Install with: pip install flask flask-socketio")
     exit(1)
@@ -50,6 +59,9 @@ from gameEngine import (
 logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger(__name__)
 
+# Delta updates carry the full board every this many moves
+KEYFRAME_INTERVAL = 32
+
 # ============================================================================
 # GameLogger Class
 # ============================================================================
@@ -105,9 +117,11 @@ class GameLogger:
             'game_duration': None
         }
     
-    def log_move(self, move: Dict[str, Any], player: str, board: List[List[Optional[Piece]]]):
-        """Log a move and the resulting board state."""
-        board_state = self.encode_board(board)
+    def log_move(self, move: Dict[str, Any], player: str, board: List[List[Optional[Piece]]],
+                 board_state: Optional[str] = None):
+        """Log a move and the resulting board state (encoded here unless given)."""
+        if board_state is None:
+            board_state = self.encode_board(board)
         self.states.append(board_state)
         self.moves.append({
             'player': player,
@@ -122,7 +136,8 @@ class GameLogger:
         self.metadata['final_scores'] = final_scores
         self.metadata['game_duration'] = time.time() - self.metadata['timestamp']
     
-    def encode_board(self, board: List[List[Optional[Piece]]]) -> str:
+    @classmethod
+    def encode_board(cls, board: List[List[Optional[Piece]]]) -> str:
         """Encode entire board as a compact string."""
         encoded_chars = []
         for row in board:
@@ -133,16 +148,21 @@ class GameLogger:
                     key = (cell.owner, cell.side, cell.orientation)
                     
                     # Try direct lookup first
-                    if key in self.ENCODING:
-                        encoded_chars.append(self.ENCODING[key])
+                    if key in cls.ENCODING:
+                        encoded_chars.append(cls.ENCODING[key])
                     else:
                         # Fallback: log the unexpected key for debugging
                         print(f"Warning: Unexpected piece configuration: {key}, treating as stone")
                         # Treat as stone regardless of orientation
                         fallback_key = (cell.owner, 'stone', 'horizontal')
-                        encoded_chars.append(self.ENCODING.get(fallback_key, '.'))
+                        encoded_chars.append(cls.ENCODING.get(fallback_key, '.'))
         
         return ''.join(encoded_chars)
+
+    @staticmethod
+    def checksum(encoded: str) -> int:
+        """CRC-32 of an encoded board, as sent with delta updates."""
+        return zlib.crc32(encoded.encode('ascii'))
     
     def decode_board(self, encoded: str) -> List[List[Optional[Piece]]]:
         """Decode compact string back to board state."""
@@ -207,6 +227,10 @@ class GameLogger:
 # Game Coordinator with Logging
 # ============================================================================
 
+def bot_room(player: str, delta: bool) -> str:
+    """Socket.IO room for bots of `player` that want full or delta updates"""
+    return f"bot_{player}_delta" if delta else f"bot_{player}"
+
 class GameCoordinator:
     """Manages game state and coordinates between web GUI and bot players"""
     
@@ -217,10 +241,17 @@ class GameCoordinator:
         self.socketio = None
         self.log_directory = Path("game_logs")
         self.log_directory.mkdir(exist_ok=True)
+        self.native_results: List[Dict[str, Any]] = []  # finished AgentPool games
+        self.bot_subscribers: Dict[str, set] = {}  # bot_room() -> socket ids
         
-    def create_game(self, board_size: str = "small", enable_logging: bool = True) -> str:
+    def create_game(self, board_size: str = "small", enable_logging: bool = True,
+                    make_current: bool = True) -> str:
         """Create a new game with specified board size"""
         game_id = f"game_{int(time.time())}"
+        suffix = 1
+        while game_id in self.games:
+            game_id = f"game_{int(time.time())}_{suffix}"
+            suffix += 1
         
         # Determine board dimensions
         if board_size == "small":
@@ -259,14 +290,25 @@ class GameCoordinator:
             "last_move_time": time.time(),
             "game_log": [],
             "logger": game_logger,  # GameLogger instance
-            "logging_enabled": enable_logging
+            "logging_enabled": enable_logging,
+            "last_move": None  # {"player", "move"} for delta updates
         }
+        self._encode_board_state(game_state)
         
         self.games[game_id] = game_state
-        self.current_game_id = game_id
+        if make_current:
+            self.current_game_id = game_id
         logger.info(f"Created new game {game_id} with board size {board_size} (logging: {enable_logging})")
         return game_id
     
+    def _encode_board_state(self, game: Dict[str, Any]):
+        """Refresh the encoded board and its checksum after the board changes.
+
+        Done once per move so updates and polls never re-serialise the board.
+        """
+        game["board_code"] = GameLogger.encode_board(game["board"])
+        game["checksum"] = GameLogger.checksum(game["board_code"])
+
     def get_game(self, game_id: str = None) -> Optional[Dict[str, Any]]:
         """Get game state by ID"""
         if game_id is None:
@@ -317,7 +359,8 @@ class GameCoordinator:
         logger.info(f"Bot disconnected from port {port}")
         return True
     
-    def make_move(self, player: str, move: Dict[str, Any], thinking_time: float = None) -> Dict[str, Any]:
+    def make_move(self, player: str, move: Dict[str, Any], thinking_time: float = None,
+                  game_id: str = None) -> Dict[str, Any]:
         """Process a move from a bot player
         
         Args:
@@ -325,8 +368,9 @@ class GameCoordinator:
             move: The move dictionary
             thinking_time: Optional - actual time spent by bot thinking (in seconds)
                           If not provided, falls back to measuring time since last move
+            game_id: Optional - game to move in, defaults to the current game
         """
-        game = self.get_game()
+        game = self.get_game(game_id)
         if not game:
             return {"success": False, "error": "No active game"}
             
@@ -373,9 +417,12 @@ class GameCoordinator:
         )
         
         if success:
+            self._encode_board_state(game)
+            game["last_move"] = {"player": player, "move": move}
+
             # Log the move in GameLogger
             if game["logging_enabled"] and game["logger"]:
-                game["logger"].log_move(move, player, game["board"])
+                game["logger"].log_move(move, player, game["board"], game["board_code"])
             
             # Log the move in game history
             game["game_log"].append({
@@ -483,20 +530,12 @@ class GameCoordinator:
     
     def _broadcast_game_update(self, game: Dict[str, Any]):
         """Broadcast game state update to web clients"""
+        if game["id"] != self.current_game_id:
+            return  # background games (run_native_games) are not shown
         if self.socketio:
-            # Convert board to serializable format
-            serialized_board = []
-            for row in game["board"]:
-                serialized_row = []
-                for cell in row:
-                    if cell:
-                        serialized_row.append(cell.to_dict())
-                    else:
-                        serialized_row.append(None)
-                serialized_board.append(serialized_row)
-            
             update_data = {
-                "board": serialized_board,
+                "board_code": game["board_code"],
+                "last_move": game["last_move"],
                 "current_player": game["current_player"],
                 "game_status": game["game_status"],
                 "turn_count": game["turn_count"],
@@ -511,26 +550,36 @@ class GameCoordinator:
             }
             
             self.socketio.emit('game_update', update_data)
+            self._notify_bots()
+
+    def _notify_bots(self):
+        """Push the current state to bots subscribed with 'bot_subscribe'.
+
+        Each player has its own room, split by update format, so the state
+        carries the right your_turn/time_left view; bots react immediately
+        instead of polling. Rooms nobody is in are skipped.
+        """
+        for player in ("circle", "square"):
+            for delta in (False, True):
+                room = bot_room(player, delta)
+                if not self.bot_subscribers.get(room):
+                    continue
+                state = self.get_game_state_for_bot(player, delta=delta)
+                if state:
+                    self.socketio.emit('bot_state', state, to=room)
     
-    def get_game_state_for_bot(self, player: str) -> Optional[Dict[str, Any]]:
-        """Get game state formatted for bot consumption"""
+    def get_game_state_for_bot(self, player: str, delta: bool = False,
+                               keyframe: bool = False) -> Optional[Dict[str, Any]]:
+        """Get game state formatted for bot consumption
+
+        With delta set, the board is replaced by the last move and a checksum,
+        plus the encoded board on keyframes (see DELTA UPDATES above).
+        """
         game = self.get_game()
         if not game:
             return None
-            
-        # Convert board to bot format
-        bot_board = []
-        for row in game["board"]:
-            bot_row = []
-            for cell in row:
-                if cell:
-                    bot_row.append(cell.to_dict())
-                else:
-                    bot_row.append(None)
-            bot_board.append(bot_row)
-        
-        return {
-            "board": bot_board,
+
+        state = {
             "rows": game["rows"],
             "cols": game["cols"],
             "score_cols": game["score_cols"],
@@ -542,7 +591,89 @@ class GameCoordinator:
             "turn_count": game["turn_count"],
             "timestamp": time.time()
         }
-    
+
+        if not delta:
+            # Convert board to bot format
+            bot_board = []
+            for row in game["board"]:
+                bot_row = []
+                for cell in row:
+                    if cell:
+                        bot_row.append(cell.to_dict())
+                    else:
+                        bot_row.append(None)
+                bot_board.append(bot_row)
+            state["board"] = bot_board
+            return state
+
+        seq = len(game["game_log"])
+        state["seq"] = seq
+        state["last_move"] = game["last_move"]
+        state["checksum"] = game["checksum"]
+        if keyframe or seq % KEYFRAME_INTERVAL == 0 or game["game_status"] != "active":
+            state["board_code"] = game["board_code"]
+        return state
+    
+    def run_native_games(self, count: int, board_size: str = "small", threads: int = 0,
+                         time_slice: float = 0.0, enable_logging: bool = True) -> List[Dict[str, Any]]:
+        """Play `count` bot-vs-bot games at once inside this process.
+
+        Both sides of every game are StudentAgent sessions on one native
+        AgentPool, so all searches share a core-bounded thread pool
+        (`threads` = 0 uses every core). A positive `time_slice` caps each
+        search at a fair share of that many seconds while games are queued.
+        """
+        from student_agent_cpp import student_agent as native, board_to_cpp, move_from_cpp
+
+        pool = native.AgentPool(threads, time_slice)
+        pending: Dict[int, str] = {}  # ticket -> game_id
+
+        def submit(game_id: str):
+            game = self.games[game_id]
+            player = game["current_player"]
+            opponent = "square" if player == "circle" else "circle"
+            ticket = pool.submit(
+                game_id, player, board_to_cpp(game["board"]),
+                game["rows"], game["cols"], list(game["score_cols"]),
+                game["players"][player]["time_left"], game["players"][opponent]["time_left"])
+            pending[ticket] = game_id
+
+        game_ids = [self.create_game(board_size, enable_logging, make_current=False) for _ in range(count)]
+        for game_id in game_ids:
+            game = self.games[game_id]
+            for player in ("circle", "square"):
+                pool.open_session(game_id, player)
+                game["players"][player]["connected"] = True
+            game["game_status"] = "active"
+            game["last_move_time"] = time.time()
+            submit(game_id)
+
+        while pending:
+            ticket = pool.wait_any(list(pending), 1.0)
+            if ticket < 0:
+                continue
+            game_id = pending.pop(ticket)
+            game = self.games[game_id]
+            cpp_move, seconds = pool.wait(ticket)
+            self.make_move(game["current_player"], move_from_cpp(cpp_move), seconds, game_id=game_id)
+            if game["game_status"] == "active":
+                submit(game_id)
+            else:
+                pool.close_game(game_id)
+
+        results = []
+        for game_id in game_ids:
+            game = self.games[game_id]
+            results.append({
+                "game_id": game_id,
+                "winner": game["winner"],
+                "turns": game["turn_count"],
+                "final_scores": game.get("final_scores"),
+            })
+        self.native_results.extend(results)
+        logger.info(f"Native games finished: {results}")
+        return results
+
     def get_game_log_stats(self, game_id: str = None) -> Optional[Dict[str, Any]]:
         """Get statistics about the game log"""
         game = self.get_game(game_id)
@@ -599,6 +730,31 @@ def create_game():
         }
     })
 
+@app.route('/api/native_games', methods=['POST'])
+def start_native_games():
+    """Start bot-vs-bot games on the native agent pool in the background"""
+    data = request.get_json() or {}
+    count = int(data.get('count', 4))
+    board_size = data.get('board_size', 'small')
+    threads = int(data.get('threads', 0))
+    time_slice = float(data.get('time_slice', 0.0))
+    enable_logging = data.get('enable_logging', True)
+    
+    if board_size not in ['small', 'medium', 'large']:
+        return jsonify({"error": "Invalid board size"}), 400
+    
+    threading.Thread(
+        target=coordinator.run_native_games,
+        args=(count, board_size, threads, time_slice, enable_logging),
+        daemon=True
+    ).start()
+    return jsonify({"success": True, "count": count, "board_size": board_size})
+
+@app.route('/api/native_games')
+def get_native_games():
+    """Results of finished native agent pool games"""
+    return jsonify({"results": coordinator.native_results})
+
 @app.route('/api/game_state')
 def get_game_state():
     """Get current game state for web interface"""
@@ -685,8 +841,12 @@ def disconnect_bot(player):
 
 @app.route('/bot/game_state/<player>')
 def get_bot_game_state(player):
-    """Get game state for bot player"""
-    game_state = coordinator.get_game_state_for_bot(player)
+    """Get game state for bot player (?delta=1 for delta format, &keyframe=1 to force the board)"""
+    game_state = coordinator.get_game_state_for_bot(
+        player,
+        delta=request.args.get('delta') == '1',
+        keyframe=request.args.get('keyframe') == '1'
+    )
     if game_state:
         return jsonify(game_state)
     else:
@@ -720,8 +880,26 @@ def on_connect():
 @socketio.on('disconnect')
 def on_disconnect():
     """Handle web client disconnection"""
+    for sids in coordinator.bot_subscribers.values():
+        sids.discard(request.sid)
     logger.info("Web client disconnected")
 
+@socketio.on('bot_subscribe')
+def on_bot_subscribe(data):
+    """Register a bot connection for pushed 'bot_state' updates"""
+    player = data.get('player')
+    if player not in ("circle", "square"):
+        emit('error', {"error": "Invalid player"})
+        return
+    delta = bool(data.get('delta', False))
+    room = bot_room(player, delta)
+    join_room(room)
+    coordinator.bot_subscribers.setdefault(room, set()).add(request.sid)
+    logger.info(f"Bot {player} subscribed to {'delta' if delta else 'full'} state updates")
+    state = coordinator.get_game_state_for_bot(player, delta=delta, keyframe=True)
+    if state:
+        emit('bot_state', state)
+
 @socketio.on('create_game')
 def on_create_game(data):
     """Handle game creation from web client"""
@@ -757,7 +935,7 @@ Bot Connections:
 
 Bot API Endpoints:
   - Connect: POST /bot/connect/<player>
-  - Game State: GET /bot/game_state/<player>
+  - Game State: GET /bot/game_state/<player>  (?delta=1 for delta updates)
   - Make Move: POST /bot/move/<player>
   - Disconnect: POST /bot/disconnect/<player>
 
@@ -765,6 +943,7 @@ Web API Endpoints:
   - Create Game: POST /api/create_game
   - Game State: GET /api/game_state
   - Log Stats: GET /api/game_log_stats
+  - Native Games: POST /api/native_games, results: GET /api/native_games
     """)
     
     socketio.run(app, host='0.0.0.0', port=port, debug=True, allow_unsafe_werkzeug=True)
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "workload.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "movegen.h"
+#include "search.h"
+
+WorkloadResult run_training_workload(int plies_per_game, uint32_t seed)
+{
+    constexpr int LOW_CLOCK_PLIES = 4;
+    WorkloadResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (int rows : {13, 15, 17})
+    {
+        int cols = rows - 1;
+        auto score_cols = score_cols_for(cols);
+        StudentAgent circle("circle"), square("square");
+        circle.set_seed(seed);
+        square.set_seed(seed + 1);
+        circle.set_move_time_cap(FIRST_ITERATION_CAP);
+        square.set_move_time_cap(FIRST_ITERATION_CAP);
+
+        auto board = standard_start_board(rows, cols);
+        for (int ply = 0; ply < plies_per_game; ply++)
+        {
+            StudentAgent &agent = (ply % 2 == 0) ? circle : square;
+            const std::string side = (ply % 2 == 0) ? "circle" : "square";
+            double clock = ply >= plies_per_game - LOW_CLOCK_PLIES ? LOW_CLOCK_SECONDS / 2 : 600.0;
+            Move move = agent.choose_board(board, rows, cols, score_cols, clock, 600.0);
+            auto legal = generate_all_valid_moves(board, side, rows, cols, score_cols);
+            auto chosen = find_move(legal, move);
+            if (!chosen)
+                break;
+            board = apply_move(board, *chosen, side, rows, cols, score_cols);
+            result.plies++;
+            if (!check_win(board, rows, cols, score_cols).empty())
+                break;
+        }
+        result.games++;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,22 @@
+// Deterministic self-play for collecting PGO profiles (PGO=GENERATE in
+// CMakeLists.txt). Every board size is played from the standard start by
+// seeded agents whose searches stop after the first iteration, so a run is
+// repeatable while still spending its time in move generation, river flow,
+// BFS and evaluation in the proportions of a real game. The last plies of
+// each game run on a low clock to cover the greedy policy as well.
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstdint>
+
+struct WorkloadResult
+{
+    int games = 0;
+    int plies = 0;
+    double seconds = 0.0;
+};
+
+WorkloadResult run_training_workload(int plies_per_game = 24, uint32_t seed = 1);
+
+#endif // WORKLOAD_H